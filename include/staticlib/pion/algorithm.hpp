@@ -28,8 +28,10 @@
 
 #include <cctype>
 #include <cstdint>
+#include <cstring>
 #include <functional>
 #include <locale>
+#include <memory>
 #include <string>
 
 #include "staticlib/config.hpp"
@@ -96,6 +98,77 @@ namespace algorithm {
         seed ^= hasher(v) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
     }
 
+    /**
+     * Case insensitive comparison of 8 bytes packed into words, only ASCII
+     * letters are folded, all bytes are compared at once
+     * 
+     * @param a first word
+     * @param b second word
+     * @return true if words are equal ignoring case, false otherwise
+     */
+    inline bool iequals_word(uint64_t a, uint64_t b) {
+        const uint64_t ones = 0x0101010101010101ULL;
+        const uint64_t high = ones * 0x80;
+        uint64_t diff = a ^ b;
+        if (0 == diff) {
+            return true;
+        }
+        // high bit is set in the bytes of "a" that are ASCII letters,
+        // per-byte additions cannot overflow on 7-bit values
+        uint64_t lower = (a | (ones * 0x20)) & ~high;
+        uint64_t ge_a = lower + ones * (0x80 - 'a');
+        uint64_t le_z = ones * (0x80 + 'z') - lower;
+        uint64_t alpha = ge_a & le_z & ~a & high;
+        // letters may differ only in the case bit
+        return 0 == (diff & ~(alpha >> 2));
+    }
+
+    /**
+     * Case insensitive comparison of two characters spans, compares
+     * 8 bytes at a time, does not support Unicode
+     * 
+     * @param data1 first span data
+     * @param len1 first span length
+     * @param data2 second span data
+     * @param len2 second span length
+     * @return true if spans are equal ignoring case, false otherwise
+     */
+    inline bool iequals(const char* data1, std::size_t len1, const char* data2, std::size_t len2) {
+        if (len1 != len2) {
+            return false;
+        }
+        std::size_t i = 0;
+        for (; i + 8 <= len1; i += 8) {
+            uint64_t a, b;
+            std::memcpy(std::addressof(a), data1 + i, 8);
+            std::memcpy(std::addressof(b), data2 + i, 8);
+            if (!iequals_word(a, b)) {
+                return false;
+            }
+        }
+        if (i < len1) {
+            uint64_t a = 0;
+            uint64_t b = 0;
+            std::memcpy(std::addressof(a), data1 + i, len1 - i);
+            std::memcpy(std::addressof(b), data2 + i, len1 - i);
+            return iequals_word(a, b);
+        }
+        return true;
+    }
+
+    /**
+     * Case insensitive comparison of the characters span
+     * with the string, does not support Unicode
+     * 
+     * @param data first span data
+     * @param len first span length
+     * @param str second string
+     * @return true if span and string are equal ignoring case, false otherwise
+     */
+    inline bool iequals(const char* data, std::size_t len, const std::string& str) {
+        return iequals(data, len, str.data(), str.length());
+    }
+
     /**
      * Case insensitive string equality predicate
      */
@@ -109,7 +182,7 @@ namespace algorithm {
          * @return true if strings equal ignoring case, false otherwise
          */
         bool operator()(std::string const& x, std::string const& y) const {
-            return sl::utils::iequals(x, y);
+            return iequals(x.data(), x.length(), y.data(), y.length());
         }
     };
 
@@ -127,8 +200,9 @@ namespace algorithm {
         std::size_t operator()(std::string const& x) const {
             std::size_t seed = 0;
             for (std::string::const_iterator it = x.begin(); it != x.end(); ++it) {
-                // locale is expensive here
-                algorithm::hash_combine(seed, std::toupper(*it/*, locale*/));
+                // ASCII case folding, may also fold some non-letters,
+                // that only adds collisions for the equal_to to resolve
+                algorithm::hash_combine(seed, static_cast<unsigned char>(*it) | 0x20);
             }
             return seed;
         }
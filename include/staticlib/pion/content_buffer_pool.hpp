@@ -0,0 +1,314 @@
+/*
+ * Copyright 2026, alex at staticlibs.net
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   content_buffer_pool.hpp
+ * Author: alex
+ *
+ * Created on October 17, 2026, 9:05 PM
+ */
+
+#ifndef STATICLIB_PION_CONTENT_BUFFER_POOL_HPP
+#define STATICLIB_PION_CONTENT_BUFFER_POOL_HPP
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "staticlib/config.hpp"
+
+namespace staticlib {
+namespace pion {
+
+// forward declaration
+class content_buffer_pool;
+
+/**
+ * Owned block of memory holding the payload content, block is returned
+ * to the pool it was taken from on destruction; can be moved out
+ * of the message to take the ownership of the content without copying
+ */
+class content_block {
+    /**
+     * Block memory, null for an empty block
+     */
+    char* block_data;
+
+    /**
+     * Number of bytes of content stored in the block
+     */
+    std::size_t block_size;
+
+    /**
+     * Number of bytes that can be stored in the block, one more byte
+     * is allocated, so the content can always be null-terminated
+     */
+    std::size_t block_capacity;
+
+    /**
+     * Pool the block is returned to, if null the block is deleted
+     */
+    std::shared_ptr<content_buffer_pool> pool;
+
+public:
+    /**
+     * Constructor for an empty block
+     */
+    content_block() :
+    block_data(nullptr),
+    block_size(0),
+    block_capacity(0) { }
+
+    /**
+     * Constructor
+     *
+     * @param data memory allocated with `new char[]`, `capacity + 1` bytes
+     * @param capacity number of bytes that can be stored in the block
+     * @param pool pool the block is returned to, may be null
+     */
+    content_block(char* data, std::size_t capacity, std::shared_ptr<content_buffer_pool> pool) :
+    block_data(data),
+    block_size(0),
+    block_capacity(capacity),
+    pool(std::move(pool)) { }
+
+    /**
+     * Deleted copy constructor
+     */
+    content_block(const content_block&) = delete;
+
+    /**
+     * Deleted copy assignment operator
+     */
+    content_block& operator=(const content_block&) = delete;
+
+    /**
+     * Move constructor
+     *
+     * @param other other instance, left empty
+     */
+    content_block(content_block&& other) STATICLIB_NOEXCEPT :
+    block_data(other.block_data),
+    block_size(other.block_size),
+    block_capacity(other.block_capacity),
+    pool(std::move(other.pool)) {
+        other.block_data = nullptr;
+        other.block_size = 0;
+        other.block_capacity = 0;
+    }
+
+    /**
+     * Move assignment operator
+     *
+     * @param other other instance, left empty
+     * @return this instance
+     */
+    content_block& operator=(content_block&& other) STATICLIB_NOEXCEPT {
+        if (this != std::addressof(other)) {
+            reset();
+            block_data = other.block_data;
+            block_size = other.block_size;
+            block_capacity = other.block_capacity;
+            pool = std::move(other.pool);
+            other.block_data = nullptr;
+            other.block_size = 0;
+            other.block_capacity = 0;
+        }
+        return *this;
+    }
+
+    /**
+     * Destructor, returns the block to the pool
+     */
+    ~content_block() STATICLIB_NOEXCEPT {
+        reset();
+    }
+
+    /**
+     * Returns mutable pointer to data
+     *
+     * @return pointer to data, null for an empty block
+     */
+    char* data() {
+        return block_data;
+    }
+
+    /**
+     * Returns const pointer to data
+     *
+     * @return pointer to data, null for an empty block
+     */
+    const char* data() const {
+        return block_data;
+    }
+
+    /**
+     * Returns the number of bytes of content stored in the block
+     *
+     * @return content size
+     */
+    std::size_t size() const {
+        return block_size;
+    }
+
+    /**
+     * Sets the number of bytes of content stored in the block
+     *
+     * @param size content size, must not exceed the capacity
+     */
+    void set_size(std::size_t size) {
+        block_size = size;
+    }
+
+    /**
+     * Returns the number of bytes that can be stored in the block,
+     * the byte at this index is allocated too and can hold the terminator
+     *
+     * @return block capacity
+     */
+    std::size_t capacity() const {
+        return block_capacity;
+    }
+
+    /**
+     * Returns block content as a string, content is copied
+     *
+     * @return block content
+     */
+    std::string to_string() const {
+        return nullptr != block_data ? std::string(block_data, block_size) : std::string();
+    }
+
+    /**
+     * Releases the block memory to the pool, block becomes empty
+     */
+    void reset() STATICLIB_NOEXCEPT;
+};
+
+/**
+ * Pool of the memory blocks used for payload content of received messages,
+ * normally one pool is used per scheduler thread; blocks are grouped by
+ * size classes (powers of two from 4 KB to 1 MB), larger blocks are
+ * not pooled; one extra byte is allocated for each block, so content of the class size
+ * can be null-terminated; pooled memory is not zero-filled when the block is reused
+ */
+class content_buffer_pool {
+public:
+    /**
+     * Capacity of the smallest size class
+     */
+    static const std::size_t MIN_CLASS_CAPACITY = 4096;
+
+    /**
+     * Number of size classes
+     */
+    static const std::size_t CLASSES_COUNT = 9;
+
+private:
+    /**
+     * Mutex to make pool thread-safe
+     */
+    std::mutex mutex;
+
+    /**
+     * Free blocks of each size class
+     */
+    std::array<std::vector<std::unique_ptr<char[]>>, CLASSES_COUNT> spare;
+
+    /**
+     * Number of bytes in all free blocks
+     */
+    std::size_t spare_bytes;
+
+    /**
+     * Max number of bytes in free blocks kept in the pool
+     */
+    std::atomic<std::size_t> spare_limit;
+
+public:
+    /**
+     * Constructor
+     *
+     * @param limit max number of bytes in free blocks kept in the pool
+     */
+    explicit content_buffer_pool(std::size_t limit);
+
+    /**
+     * Deleted copy constructor
+     */
+    content_buffer_pool(const content_buffer_pool&) = delete;
+
+    /**
+     * Deleted copy assignment operator
+     */
+    content_buffer_pool& operator=(const content_buffer_pool&) = delete;
+
+    /**
+     * Takes a free block of the suitable size class from the pool or allocates
+     * a new one, block contents are not initialized
+     *
+     * @param pool pool to take the block from, if null the block is allocated
+     *        with the exact capacity and is deleted on destruction
+     * @param capacity min number of bytes in the block
+     * @return empty block
+     */
+    static content_block acquire(const std::shared_ptr<content_buffer_pool>& pool, std::size_t capacity);
+
+    /**
+     * Returns the block memory to the pool, memory is deleted if
+     * the capacity does not match a size class, or the pool
+     * already holds the max number of bytes in free blocks
+     *
+     * @param data block memory allocated with `new char[]`
+     * @param capacity block capacity, without the terminator byte
+     */
+    void release(char* data, std::size_t capacity) STATICLIB_NOEXCEPT;
+
+    /**
+     * Sets the max number of bytes in free blocks kept in the pool,
+     * extra free blocks are destroyed
+     *
+     * @param limit max number of bytes
+     */
+    void set_spare_limit(std::size_t limit);
+
+    /**
+     * Returns the number of free blocks in the pool
+     *
+     * @return number of free blocks
+     */
+    std::size_t spare_count();
+
+    /**
+     * Returns the capacity of the size class suitable for the
+     * specified number of bytes
+     *
+     * @param len number of bytes
+     * @return size class capacity, `len` if it exceeds the largest class
+     */
+    static std::size_t class_capacity(std::size_t len);
+
+};
+
+} // namespace
+}
+
+#endif /* STATICLIB_PION_CONTENT_BUFFER_POOL_HPP */
+
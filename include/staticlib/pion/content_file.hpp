@@ -0,0 +1,221 @@
+/*
+ * Copyright 2026, alex at staticlibs.net
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   content_file.hpp
+ * Author: alex
+ *
+ * Created on October 17, 2026, 9:50 PM
+ */
+
+#ifndef STATICLIB_PION_CONTENT_FILE_HPP
+#define STATICLIB_PION_CONTENT_FILE_HPP
+
+#include <cstdint>
+#include <ios>
+#include <memory>
+#include <string>
+
+#include "staticlib/config.hpp"
+#include "staticlib/io/span.hpp"
+
+namespace staticlib {
+namespace pion {
+
+/**
+ * Temporary file used to store large payload content outside of memory,
+ * file is removed from the file system right after it is created (on Windows
+ * it is deleted on close), so it does not outlive the process; content
+ * can be accessed through a memory mapping or read with offsets
+ */
+class content_file {
+#ifdef _WIN32
+    /**
+     * File handle
+     */
+    void* handle;
+
+    /**
+     * File mapping handle, null if content is not mapped
+     */
+    void* mapping_handle;
+#else // !_WIN32
+    /**
+     * File descriptor
+     */
+    int fd;
+#endif // _WIN32
+
+    /**
+     * Number of bytes of content written to the file
+     */
+    std::size_t content_size;
+
+    /**
+     * Mapped content, null if content is not mapped
+     */
+    char* mapped;
+
+    /**
+     * Length of the mapping
+     */
+    std::size_t mapped_size;
+
+public:
+    /**
+     * Constructor, creates an empty file
+     *
+     * @param directory directory to create file in, system temporary
+     *        directory is used if empty
+     * @throws pion_exception if file cannot be created
+     */
+    explicit content_file(const std::string& directory);
+
+    /**
+     * Deleted copy constructor
+     */
+    content_file(const content_file&) = delete;
+
+    /**
+     * Deleted copy assignment operator
+     */
+    content_file& operator=(const content_file&) = delete;
+
+    /**
+     * Destructor, unmaps and closes the file
+     */
+    ~content_file() STATICLIB_NOEXCEPT;
+
+    /**
+     * Appends data to the end of the file, existing mapping is released
+     *
+     * @param data pointer to data
+     * @param len number of bytes to append
+     * @throws pion_exception on write error
+     */
+    void append(const char* data, std::size_t len);
+
+    /**
+     * Returns the number of bytes of content written to the file
+     *
+     * @return content size
+     */
+    std::size_t size() const {
+        return content_size;
+    }
+
+    /**
+     * Maps the content to memory, mapping is private, so changes to the
+     * mapped memory are not written to the file; mapped content is
+     * null-terminated, same as the content stored in memory
+     *
+     * @return pointer to the mapped content
+     * @throws pion_exception on mapping error
+     */
+    char* map();
+
+    /**
+     * Reads the content starting from the specified offset
+     *
+     * @param offset offset in content
+     * @param buf destination buffer
+     * @param len max number of bytes to read
+     * @return number of bytes read, zero at the end of content
+     * @throws pion_exception on read error
+     */
+    std::size_t read_at(std::size_t offset, char* buf, std::size_t len) const;
+
+private:
+    /**
+     * Releases the content mapping if it exists
+     */
+    void unmap() STATICLIB_NOEXCEPT;
+};
+
+/**
+ * Source for reading payload content, reads either from memory or from
+ * the temporary file, can be used with `sl::io` functions; source must not
+ * outlive the message it is obtained from
+ */
+class content_source {
+    /**
+     * Content in memory, used if file is null
+     */
+    const char* data;
+
+    /**
+     * Content file
+     */
+    const content_file* file;
+
+    /**
+     * Content length
+     */
+    std::size_t length;
+
+    /**
+     * Number of bytes read
+     */
+    std::size_t offset;
+
+public:
+    /**
+     * Constructor for the content stored in memory
+     *
+     * @param data pointer to content
+     * @param length content length
+     */
+    content_source(const char* data, std::size_t length) :
+    data(data),
+    file(nullptr),
+    length(length),
+    offset(0) { }
+
+    /**
+     * Constructor for the content stored in the temporary file
+     *
+     * @param file content file
+     * @param length content length
+     */
+    content_source(const content_file& file, std::size_t length) :
+    data(nullptr),
+    file(std::addressof(file)),
+    length(length),
+    offset(0) { }
+
+    /**
+     * Reads content into the specified buffer
+     *
+     * @param span destination buffer
+     * @return number of bytes read, `std::char_traits<char>::eof()` at the end of content
+     */
+    std::streamsize read(sl::io::span<char> span);
+
+    /**
+     * Returns the total content length
+     *
+     * @return content length
+     */
+    std::size_t size() const {
+        return length;
+    }
+};
+
+} // namespace
+}
+
+#endif /* STATICLIB_PION_CONTENT_FILE_HPP */
+
@@ -0,0 +1,118 @@
+/*
+ * Copyright 2026, alex at staticlibs.net
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   disk_io_pool.hpp
+ * Author: alex
+ *
+ * Created on October 18, 2026, 3:20 AM
+ */
+
+#ifndef STATICLIB_PION_DISK_IO_POOL_HPP
+#define STATICLIB_PION_DISK_IO_POOL_HPP
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "staticlib/config.hpp"
+
+namespace staticlib {
+namespace pion {
+
+/**
+ * Small pool of threads that run blocking disk operations, so the scheduler
+ * threads never wait for the disk; tasks are run in the order they were posted
+ */
+class disk_io_pool {
+    /**
+     * Mutex to make pool thread-safe
+     */
+    std::mutex mutex;
+
+    /**
+     * Signalled when a task is posted or the pool is stopped
+     */
+    std::condition_variable cv;
+
+    /**
+     * Tasks waiting to be run
+     */
+    std::deque<std::function<void()>> tasks;
+
+    /**
+     * Set when the pool is stopped
+     */
+    bool stopping;
+
+    /**
+     * Pool threads
+     */
+    std::vector<std::thread> threads;
+
+public:
+    /**
+     * Constructor, starts the threads
+     *
+     * @param threads_count number of threads
+     */
+    explicit disk_io_pool(uint32_t threads_count);
+
+    /**
+     * Destructor, stops the threads, tasks not yet started are dropped
+     */
+    ~disk_io_pool() STATICLIB_NOEXCEPT;
+
+    /**
+     * Deleted copy constructor
+     */
+    disk_io_pool(const disk_io_pool&) = delete;
+
+    /**
+     * Deleted copy assignment operator
+     */
+    disk_io_pool& operator=(const disk_io_pool&) = delete;
+
+    /**
+     * Posts the task to be run on one of the pool threads, the task
+     * is dropped if the pool is stopped
+     *
+     * @param task task to run, must not throw
+     */
+    void post(std::function<void()> task);
+
+    /**
+     * Stops the threads, waits for the running tasks to complete,
+     * tasks not yet started are dropped
+     */
+    void stop();
+
+private:
+    /**
+     * Runs the tasks until the pool is stopped
+     */
+    void run();
+};
+
+} // namespace
+}
+
+#endif /* STATICLIB_PION_DISK_IO_POOL_HPP */
+
@@ -0,0 +1,146 @@
+/*
+ * Copyright 2026, alex at staticlibs.net
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   http_connection_cache.hpp
+ * Author: alex
+ *
+ * Created on October 17, 2026, 3:05 PM
+ */
+
+#ifndef STATICLIB_PION_HTTP_CONNECTION_CACHE_HPP
+#define STATICLIB_PION_HTTP_CONNECTION_CACHE_HPP
+
+#include <atomic>
+#include <memory>
+
+#include "staticlib/config.hpp"
+
+#include "staticlib/pion/http_request.hpp"
+#include "staticlib/pion/http_response_writer.hpp"
+#include "staticlib/pion/tcp_connection.hpp"
+
+namespace staticlib {
+namespace pion {
+
+// forward declaration
+class http_request_reader;
+
+/**
+ * Reader, request and writer objects kept by the connection between the
+ * requests, so keep-alive connections do not allocate them for every request;
+ * cache holds at most one object of each kind, objects are exchanged atomically,
+ * because requests and writers can be released from the handlers' threads
+ */
+class http_connection_cache : public tcp_connection_cache {
+    /**
+     * Spare reader
+     */
+    std::atomic<http_request_reader*> reader;
+
+    /**
+     * Spare request
+     */
+    std::atomic<http_request*> request;
+
+    /**
+     * Spare writer
+     */
+    std::atomic<http_response_writer*> writer;
+
+public:
+    /**
+     * Constructor
+     */
+    http_connection_cache();
+
+    /**
+     * Deleted copy constructor
+     */
+    http_connection_cache(const http_connection_cache&) = delete;
+
+    /**
+     * Deleted copy assignment operator
+     */
+    http_connection_cache& operator=(const http_connection_cache&) = delete;
+
+    /**
+     * Destructor, destroys spare objects
+     */
+    virtual ~http_connection_cache() STATICLIB_NOEXCEPT;
+
+    /**
+     * Returns the cache of the specified connection, cache is created
+     * if the connection does not have one yet; must not be called
+     * concurrently for the same connection
+     *
+     * @param conn connection
+     * @return cache of the connection
+     */
+    static std::shared_ptr<http_connection_cache> get(tcp_connection& conn);
+
+    /**
+     * Takes the spare reader from the cache
+     *
+     * @return spare reader, empty if the cache does not have one
+     */
+    std::unique_ptr<http_request_reader> take_reader();
+
+    /**
+     * Puts the reader into the cache, reader that was in the cache
+     * before is destroyed
+     *
+     * @param rd reader, that does not reference the connection
+     */
+    void put_reader(std::unique_ptr<http_request_reader> rd);
+
+    /**
+     * Takes the spare request from the cache
+     *
+     * @return spare cleared request, empty if the cache does not have one
+     */
+    http_request_ptr take_request();
+
+    /**
+     * Puts the cleared request into the cache, request that was
+     * in the cache before is destroyed
+     *
+     * @param req request allocated with `new`
+     */
+    void put_request(http_request* req);
+
+    /**
+     * Takes the spare writer from the cache
+     *
+     * @return spare cleared writer, empty if the cache does not have one
+     */
+    response_writer_ptr take_writer();
+
+    /**
+     * Puts the cleared writer into the cache, writer that was
+     * in the cache before is destroyed
+     *
+     * @param wr writer allocated with `new`, that does not reference the connection
+     */
+    void put_writer(http_response_writer* wr);
+
+};
+
+} // namespace
+}
+
+#endif /* STATICLIB_PION_HTTP_CONNECTION_CACHE_HPP */
+
@@ -26,6 +26,7 @@
 #ifndef STATICLIB_PION_HTTP_MESSAGE_HPP
 #define STATICLIB_PION_HTTP_MESSAGE_HPP
 
+#include <algorithm>
 #include <cstring>
 #include <cstdint>
 #include <iosfwd>
@@ -40,6 +41,9 @@
 #include "staticlib/utils.hpp"
 
 #include "staticlib/pion/algorithm.hpp"
+#include "staticlib/pion/content_buffer_pool.hpp"
+#include "staticlib/pion/content_file.hpp"
+#include "staticlib/pion/pion_exception.hpp"
 
 namespace staticlib {
 namespace pion {
@@ -55,11 +59,6 @@ class http_parser;
 class http_message  {
 public:
 
-    /**
-     * Used to cache chunked data
-     */
-//    using chunk_cache_type = std::vector<char>; 
-
     /**
      * Defines message data integrity status codes
      */
@@ -85,6 +84,47 @@ public:
         STATUS_OK
     };
 
+    /**
+     * Identifiers of the well-known headers, names of the received
+     * headers are resolved to these identifiers once during parsing
+     */
+    enum header_id {
+        HEADER_ID_UNKNOWN = 0,
+        HEADER_ID_HOST,
+        HEADER_ID_COOKIE,
+        HEADER_ID_SET_COOKIE,
+        HEADER_ID_CONNECTION,
+        HEADER_ID_CONTENT_TYPE,
+        HEADER_ID_CONTENT_LENGTH,
+        HEADER_ID_CONTENT_LOCATION,
+        HEADER_ID_CONTENT_ENCODING,
+        HEADER_ID_CONTENT_DISPOSITION,
+        HEADER_ID_LAST_MODIFIED,
+        HEADER_ID_IF_MODIFIED_SINCE,
+        HEADER_ID_TRANSFER_ENCODING,
+        HEADER_ID_LOCATION,
+        HEADER_ID_AUTHORIZATION,
+        HEADER_ID_REFERER,
+        HEADER_ID_USER_AGENT,
+        HEADER_ID_X_FORWARDED_FOR,
+        HEADER_ID_CLIENT_IP,
+        HEADER_ID_EXPECT,
+        HEADER_ID_UPGRADE,
+        HEADER_ID_ACCEPT,
+        HEADER_ID_ACCEPT_ENCODING,
+        HEADER_ID_IF_NONE_MATCH,
+        HEADER_ID_RANGE,
+        HEADER_ID_SEC_WEBSOCKET_KEY,
+        HEADER_ID_SEC_WEBSOCKET_VERSION,
+        HEADER_ID_DATE,
+        HEADER_ID_ETAG,
+        HEADER_ID_IF_RANGE,
+        HEADER_ID_CONTENT_RANGE,
+        HEADER_ID_ACCEPT_RANGES,
+        HEADER_ID_VARY,
+        HEADER_ID_COUNT
+    };
+
     /**
      * Data type for library errors returned during receive() operations
      */
@@ -149,6 +189,20 @@ public:
     static const std::string HEADER_USER_AGENT;
     static const std::string HEADER_X_FORWARDED_FOR;
     static const std::string HEADER_CLIENT_IP;
+    static const std::string HEADER_EXPECT;
+    static const std::string HEADER_UPGRADE;
+    static const std::string HEADER_ACCEPT;
+    static const std::string HEADER_ACCEPT_ENCODING;
+    static const std::string HEADER_IF_NONE_MATCH;
+    static const std::string HEADER_RANGE;
+    static const std::string HEADER_SEC_WEBSOCKET_KEY;
+    static const std::string HEADER_SEC_WEBSOCKET_VERSION;
+    static const std::string HEADER_DATE;
+    static const std::string HEADER_ETAG;
+    static const std::string HEADER_IF_RANGE;
+    static const std::string HEADER_CONTENT_RANGE;
+    static const std::string HEADER_ACCEPT_RANGES;
+    static const std::string HEADER_VARY;
 
     // common HTTP content types
     static const std::string CONTENT_TYPE_HTML;
@@ -170,6 +224,7 @@ public:
     static const std::string RESPONSE_MESSAGE_CREATED;
     static const std::string RESPONSE_MESSAGE_ACCEPTED;
     static const std::string RESPONSE_MESSAGE_NO_CONTENT;
+    static const std::string RESPONSE_MESSAGE_PARTIAL_CONTENT;
     static const std::string RESPONSE_MESSAGE_FOUND;
     static const std::string RESPONSE_MESSAGE_UNAUTHORIZED;
     static const std::string RESPONSE_MESSAGE_FORBIDDEN;
@@ -177,6 +232,8 @@ public:
     static const std::string RESPONSE_MESSAGE_METHOD_NOT_ALLOWED;
     static const std::string RESPONSE_MESSAGE_NOT_MODIFIED;
     static const std::string RESPONSE_MESSAGE_BAD_REQUEST;
+    static const std::string RESPONSE_MESSAGE_PAYLOAD_TOO_LARGE;
+    static const std::string RESPONSE_MESSAGE_RANGE_NOT_SATISFIABLE;
     static const std::string RESPONSE_MESSAGE_SERVER_ERROR;
     static const std::string RESPONSE_MESSAGE_NOT_IMPLEMENTED;
     static const std::string RESPONSE_MESSAGE_CONTINUE;
@@ -186,6 +243,7 @@ public:
     static const unsigned int RESPONSE_CODE_CREATED;
     static const unsigned int RESPONSE_CODE_ACCEPTED;
     static const unsigned int RESPONSE_CODE_NO_CONTENT;
+    static const unsigned int RESPONSE_CODE_PARTIAL_CONTENT;
     static const unsigned int RESPONSE_CODE_FOUND;
     static const unsigned int RESPONSE_CODE_UNAUTHORIZED;
     static const unsigned int RESPONSE_CODE_FORBIDDEN;
@@ -193,6 +251,8 @@ public:
     static const unsigned int RESPONSE_CODE_METHOD_NOT_ALLOWED;
     static const unsigned int RESPONSE_CODE_NOT_MODIFIED;
     static const unsigned int RESPONSE_CODE_BAD_REQUEST;
+    static const unsigned int RESPONSE_CODE_PAYLOAD_TOO_LARGE;
+    static const unsigned int RESPONSE_CODE_RANGE_NOT_SATISFIABLE;
     static const unsigned int RESPONSE_CODE_SERVER_ERROR;
     static const unsigned int RESPONSE_CODE_NOT_IMPLEMENTED;
     static const unsigned int RESPONSE_CODE_CONTINUE;
@@ -209,13 +269,16 @@ protected:
     mutable std::string m_first_line;
 
     /**
-     * A simple helper class used to manage a fixed-size payload content buffer
+     * A simple helper class used to manage a payload content buffer, buffer
+     * can be either allocated with a fixed size or grown with appends,
+     * memory is taken from the content buffer pool if one is set;
+     * large content can be spilled to a temporary file
      */
     class content_buffer_t {
-        std::unique_ptr<char[]> m_buf;
-        std::size_t m_len;
+        content_block m_block;
+        std::shared_ptr<content_buffer_pool> m_pool;
+        std::unique_ptr<content_file> m_file;
         char m_empty;
-        char *m_ptr;
     public:
         /**
          * Simple destructor
@@ -226,19 +289,19 @@ protected:
          * Default constructor
          */
         content_buffer_t() :
-        m_buf(), 
-        m_len(0),
-        m_empty(0),
-        m_ptr(&m_empty) { }
+        m_block(),
+        m_pool(),
+        m_file(),
+        m_empty(0) { }
 
         /**
          * Copy constructor
          */
         content_buffer_t(const content_buffer_t& buf) :
-        m_buf(), 
-        m_len(0),
-        m_empty(0),
-        m_ptr(&m_empty) {
+        m_block(),
+        m_pool(buf.m_pool),
+        m_file(),
+        m_empty(0) {
             if (buf.size()) {
                 resize(buf.size());
                 memcpy(get(), buf.get(), buf.size());
@@ -249,6 +312,9 @@ protected:
          * Assignment operator
          */
         content_buffer_t& operator=(const content_buffer_t& buf) {
+            if (this == std::addressof(buf)) {
+                return *this;
+            }
             if (buf.size()) {
                 resize(buf.size());
                 memcpy(get(), buf.get(), buf.size());
@@ -262,43 +328,155 @@ protected:
          * Returns true if buffer is empty
          */
         bool is_empty() const {
-            return m_len == 0;
+            return size() == 0;
         }
 
         /**
          * Returns size in bytes
          */
         std::size_t size() const {
-            return m_len;
+            return nullptr != m_file.get() ? m_file->size() : m_block.size();
         }
 
         /**
-         * Returns const pointer to data
+         * Returns const pointer to data, spilled content is mapped to memory
          */
         const char *get() const {
-            return m_ptr;
+            if (nullptr != m_file.get()) {
+                return m_file->map();
+            }
+            return nullptr != m_block.data() ? m_block.data() : &m_empty;
         }
 
         /**
-         * Returns mutable pointer to data
+         * Returns mutable pointer to data, spilled content is mapped to memory
          */
         char *get() {
-            return m_ptr;
+            if (nullptr != m_file.get()) {
+                return m_file->map();
+            }
+            return nullptr != m_block.data() ? m_block.data() : &m_empty;
+        }
+
+        /**
+         * Returns true if content is stored in a temporary file
+         */
+        bool is_spilled() const {
+            return nullptr != m_file.get();
+        }
+
+        /**
+         * Returns the temporary file the content is stored in
+         *
+         * @return content file, null if content is stored in memory
+         */
+        const content_file* get_file() const {
+            return m_file.get();
+        }
+
+        /**
+         * Moves the content to a temporary file, content appended
+         * after this call is written to the file
+         *
+         * @param directory directory to create file in, system
+         *        temporary directory is used if empty
+         */
+        void spill(const std::string& directory) {
+            if (nullptr != m_file.get()) {
+                return;
+            }
+            std::unique_ptr<content_file> file{new content_file(directory)};
+            if (m_block.size() > 0) {
+                file->append(m_block.data(), m_block.size());
+            }
+            m_block.reset();
+            m_file = std::move(file);
+        }
+
+        /**
+         * Sets the pool the memory is taken from, memory already
+         * allocated is returned to its own pool
+         *
+         * @param pool content buffer pool, if null memory is allocated directly
+         */
+        void set_pool(const std::shared_ptr<content_buffer_pool>& pool) {
+            if (pool != m_pool) {
+                m_pool = pool;
+            }
         }
 
         /**
-         * Changes the size of the content buffer
+         * Changes the size of the content buffer, contents
+         * are not initialized, buffer is null-terminated
          */
         void resize(std::size_t len) {
-            m_len = len;
+            m_file.reset();
             if (len == 0) {
-                m_buf.reset();
-                m_ptr = &m_empty;
-            } else {
-                m_buf.reset(new char[len + 1]); 
-                memset(m_buf.get(), '\0', len + 1);
-                m_ptr = m_buf.get();
+                m_block.reset();
+                return;
+            }
+            // terminator is stored in the extra byte past the block capacity
+            if (len > m_block.capacity()) {
+                m_block = content_buffer_pool::acquire(m_pool, len);
+            }
+            m_block.set_size(len);
+            m_block.data()[len] = '\0';
+        }
+
+        /**
+         * Makes sure that the specified number of bytes can be held
+         * without reallocation, capacity is grown at least twice
+         * to keep the repeated appends linear
+         *
+         * @param len number of bytes
+         */
+        void reserve(std::size_t len) {
+            if (nullptr != m_file.get() || len <= m_block.capacity()) {
+                return;
+            }
+            std::size_t cap = content_buffer_pool::class_capacity((std::max)(len, m_block.capacity() * 2));
+            auto block = content_buffer_pool::acquire(m_pool, cap);
+            std::size_t size = m_block.size();
+            if (size > 0) {
+                memcpy(block.data(), m_block.data(), size);
+            }
+            block.data()[size] = '\0';
+            block.set_size(size);
+            m_block = std::move(block);
+        }
+
+        /**
+         * Appends data to the end of the buffer
+         *
+         * @param data pointer to data
+         * @param len number of bytes to append
+         */
+        void append(const char* data, std::size_t len) {
+            if (0 == len) {
+                return;
+            }
+            if (nullptr != m_file.get()) {
+                m_file->append(data, len);
+                return;
             }
+            std::size_t size = m_block.size();
+            reserve(size + len);
+            memcpy(m_block.data() + size, data, len);
+            m_block.set_size(size + len);
+            m_block.data()[size + len] = '\0';
+        }
+
+        /**
+         * Moves the memory out of the buffer, buffer becomes empty
+         *
+         * @return memory block
+         * @throws pion_exception if content is stored in a temporary file
+         */
+        content_block release() {
+            if (nullptr != m_file.get()) {
+                throw pion_exception("Content stored in a temporary file cannot be moved out");
+            }
+            return std::move(m_block);
         }
 
         /**
@@ -315,6 +493,40 @@ private:
      * Type alias for headers map
      */
     using headers_type = std::unordered_multimap<std::string, std::string, algorithm::ihash, algorithm::iequal_to>;
+
+    /**
+     * Location of the received header inside the header block
+     */
+    struct header_view {
+        /**
+         * Offset of the header name in the header block
+         */
+        std::size_t name_offset;
+
+        /**
+         * Length of the header name
+         */
+        std::size_t name_length;
+
+        /**
+         * Identifier of the header name, unknown for not well-known names
+         */
+        header_id id;
+
+        /**
+         * Header value, copied from the header block when the header is parsed,
+         * so const accessors do not modify the message
+         */
+        std::string value;
+
+        /**
+         * Constructor
+         */
+        header_view() :
+        name_offset(0),
+        name_length(0),
+        id(HEADER_ID_UNKNOWN) { }
+    };
     
     /**
      * True if the HTTP message is valid
@@ -362,19 +574,42 @@ private:
     content_buffer_t m_content_buf;
 
     /**
-     * Buffers for holding chunked data
+     * HTTP message headers
      */
-    std::vector<char> m_chunk_cache;
+    headers_type m_headers;
 
     /**
-     * HTTP message headers
+     * Raw bytes of the received request line and headers
      */
-    headers_type m_headers;
+    std::string m_header_block;
+
+    /**
+     * Received headers, that are not yet moved to the headers multimap,
+     * only first "m_header_views_count" elements are used, the rest
+     * are kept to reuse their value strings
+     */
+    std::vector<header_view> m_header_views;
+
+    /**
+     * Number of used elements in "m_header_views"
+     */
+    std::size_t m_header_views_count;
+
+    /**
+     * Indices of the first views of the well-known headers
+     * in "m_header_views" incremented by one, zero if absent
+     */
+    std::size_t m_known_header_views[HEADER_ID_COUNT];
 
     /**
      * HTTP cookie parameters parsed from the headers
      */
-    headers_type m_cookie_params;
+    mutable headers_type m_cookie_params;
+
+    /**
+     * True if received "Cookie" headers are not yet decoded into cookie parameters
+     */
+    mutable bool m_cookie_params_pending;
 
     /**
      * Message data integrity status
@@ -405,9 +640,13 @@ public:
     m_version_minor(1),
     m_content_length(0),
     m_content_buf(),
+    m_header_views_count(0),
+    m_cookie_params_pending(false),
     m_status(STATUS_NONE),
     m_has_missing_packets(false),
-    m_has_data_after_missing(false) { }
+    m_has_data_after_missing(false) {
+        reset_known_header_views();
+    }
 
     /**
      * Copy constructor
@@ -423,11 +662,17 @@ public:
     m_version_minor(http_msg.m_version_minor),
     m_content_length(http_msg.m_content_length),
     m_content_buf(http_msg.m_content_buf),
-    m_chunk_cache(http_msg.m_chunk_cache),
     m_headers(http_msg.m_headers),
+    m_header_block(http_msg.m_header_block),
+    m_header_views(http_msg.m_header_views),
+    m_header_views_count(http_msg.m_header_views_count),
+    m_cookie_params(http_msg.m_cookie_params),
+    m_cookie_params_pending(http_msg.m_cookie_params_pending),
     m_status(http_msg.m_status),
     m_has_missing_packets(http_msg.m_has_missing_packets),
-    m_has_data_after_missing(http_msg.m_has_data_after_missing) { }
+    m_has_data_after_missing(http_msg.m_has_data_after_missing) {
+        std::memcpy(m_known_header_views, http_msg.m_known_header_views, sizeof(m_known_header_views));
+    }
 
     /**
      * Assignment operator
@@ -446,8 +691,13 @@ public:
         m_version_minor = http_msg.m_version_minor;
         m_content_length = http_msg.m_content_length;
         m_content_buf = http_msg.m_content_buf;
-        m_chunk_cache = http_msg.m_chunk_cache;
         m_headers = http_msg.m_headers;
+        m_header_block = http_msg.m_header_block;
+        m_header_views = http_msg.m_header_views;
+        m_header_views_count = http_msg.m_header_views_count;
+        std::memcpy(m_known_header_views, http_msg.m_known_header_views, sizeof(m_known_header_views));
+        m_cookie_params = http_msg.m_cookie_params;
+        m_cookie_params_pending = http_msg.m_cookie_params_pending;
         m_status = http_msg.m_status;
         m_has_missing_packets = http_msg.m_has_missing_packets;
         m_has_data_after_missing = http_msg.m_has_data_after_missing;
@@ -470,9 +720,12 @@ public:
         m_version_major = m_version_minor = 1;
         m_content_length = 0;
         m_content_buf.clear();
-        m_chunk_cache.clear();
         m_headers.clear();
+        m_header_block.clear();
+        m_header_views_count = 0;
+        reset_known_header_views();
         m_cookie_params.clear();
+        m_cookie_params_pending = false;
         m_status = STATUS_NONE;
         m_has_missing_packets = false;
         m_has_data_after_missing = false;
@@ -582,45 +835,164 @@ public:
     }
 
     /**
-     * Returns a reference to the chunk cache
+     * Moves the payload content out of the message without copying,
+     * message is left with empty content; memory is returned to the content
+     * buffer pool when the returned block is destroyed
+     *
+     * @return payload content
+     * @throws pion_exception if content is stored in a temporary file
+     */
+    content_block take_content() {
+        auto block = m_content_buf.release();
+        if (block.size() > m_content_length) {
+            block.set_size(m_content_length);
+            block.data()[m_content_length] = '\0';
+        }
+        m_content_length = 0;
+        return block;
+    }
+
+    /**
+     * Returns true if the payload content is stored in a temporary file
+     * instead of memory, such content is mapped to memory on the first
+     * call to `get_content()`
+     *
+     * @return true if content is stored in a temporary file
+     */
+    bool is_content_spilled() const {
+        return m_content_buf.is_spilled();
+    }
+
+    /**
+     * Returns the source for reading the payload content, content
+     * stored in a temporary file is read without mapping it to memory
+     *
+     * @return content source, must not outlive this message
+     */
+    content_source get_content_source() const {
+        if (m_content_buf.is_spilled()) {
+            return content_source(*m_content_buf.get_file(), m_content_length);
+        }
+        return content_source(m_content_buf.get(), m_content_length);
+    }
+
+    /**
+     * Sets the pool the memory for the payload content is taken from
+     *
+     * @param pool content buffer pool, if null memory is allocated directly
      */
-    std::vector<char>& get_chunk_cache() {
-        return m_chunk_cache;
+    void set_content_buffer_pool(const std::shared_ptr<content_buffer_pool>& pool) {
+        m_content_buf.set_pool(pool);
     }
 
     /**
-     * Returns a value for the header if any are defined; otherwise, an empty string
+     * Returns a value for the header if any are defined; otherwise, an empty string;
+     * received header is found among the headers parsed into the header block
      */
     const std::string& get_header(const std::string& key) const {
+        if (m_header_views_count > 0) {
+            auto hv = find_header_view(key);
+            return nullptr != hv ? get_header_view_value(*hv) : STRING_EMPTY;
+        }
         return get_value(m_headers, key);
     }
 
+    /**
+     * Returns a value for the well-known header if any are defined; otherwise,
+     * an empty string; received header is found by direct index
+     * 
+     * @param id header identifier
+     * @return header value
+     */
+    const std::string& get_header(header_id id) const {
+        if (m_header_views_count > 0) {
+            auto hv = find_header_view(id);
+            return nullptr != hv ? get_header_view_value(*hv) : STRING_EMPTY;
+        }
+        return get_value(m_headers, get_header_name(id));
+    }
+
     bool has_header_value(const std::string& key, const std::string& value) const {
-        auto range = m_headers.equal_range(key);
-        for (auto it = range.first; it != range.second; ++it) {
-            if (std::string::npos == it->second.find(',')) {
-                if (sl::utils::iequals(value, it->second)) {
-                    return true;
-                }
+        bool found = false;
+        visit_header_values(key, [&value, &found](const std::string& hval) {
+            if (found) {
+                return;
+            }
+            if (std::string::npos == hval.find(',')) {
+                found = sl::utils::iequals(value, hval);
             } else {
-                auto vec = sl::utils::split(it->second, ',');
+                auto vec = sl::utils::split(hval, ',');
                 for (auto& el : vec) {
                     auto trimmed = sl::utils::trim(el);
                     if (sl::utils::iequals(value, trimmed)) {
-                        return true;
+                        found = true;
+                        break;
                     }
                 }
             }
+        });
+        return found;
+    }
+
+    /**
+     * Calls the specified function for each value of the header
+     * 
+     * @param key header name
+     * @param fun function accepting header value as a `const std::string&`
+     */
+    template<typename Visitor>
+    void visit_header_values(const std::string& key, Visitor fun) const {
+        if (m_header_views_count > 0) {
+            header_id id = resolve_header_id(key.data(), key.length());
+            for (std::size_t i = 0; i < m_header_views_count; i++) {
+                auto& hv = m_header_views[i];
+                if (id == hv.id && (HEADER_ID_UNKNOWN != id ||
+                        algorithm::iequals(m_header_block.data() + hv.name_offset, hv.name_length, key))) {
+                    fun(get_header_view_value(hv));
+                }
+            }
+        } else {
+            auto range = m_headers.equal_range(key);
+            for (auto it = range.first; it != range.second; ++it) {
+                fun(it->second);
+            }
+        }
+    }
+
+    /**
+     * Calls the specified function for each value of the well-known header
+     * 
+     * @param id header identifier
+     * @param fun function accepting header value as a `const std::string&`
+     */
+    template<typename Visitor>
+    void visit_header_values(header_id id, Visitor fun) const {
+        if (m_header_views_count > 0) {
+            if (nullptr == find_header_view(id)) {
+                return;
+            }
+            for (std::size_t i = m_known_header_views[id] - 1; i < m_header_views_count; i++) {
+                auto& hv = m_header_views[i];
+                if (id == hv.id) {
+                    fun(get_header_view_value(hv));
+                }
+            }
+        } else {
+            auto range = m_headers.equal_range(get_header_name(id));
+            for (auto it = range.first; it != range.second; ++it) {
+                fun(it->second);
+            }
         }
-        return false;
     }
 
     /**
-     * Returns a reference to the HTTP headers multimap
+     * Returns a reference to the HTTP headers multimap, received
+     * headers are copied into the multimap on first access
      * 
      * @return reference to the HTTP headers multimap
      */
     headers_type& get_headers() {
+        materialize_headers();
         return m_headers;
     }
 
@@ -631,9 +1003,108 @@ public:
      * @return true if at least one value for the header is defined
      */
     bool has_header(const std::string& key) const {
+        if (m_header_views_count > 0) {
+            return nullptr != find_header_view(key);
+        }
         return (m_headers.find(key) != m_headers.end());
     }
 
+    /**
+     * Returns true if at least one value for the well-known header is defined
+     * 
+     * @param id header identifier
+     * @return true if at least one value for the header is defined
+     */
+    bool has_header(header_id id) const {
+        if (m_header_views_count > 0) {
+            return nullptr != find_header_view(id);
+        }
+        return (m_headers.find(get_header_name(id)) != m_headers.end());
+    }
+
+    /**
+     * Resolves header name into the well-known header identifier
+     * 
+     * @param name header name
+     * @param len header name length
+     * @return header identifier, unknown if name is not well-known
+     */
+    static header_id resolve_header_id(const char* name, std::size_t len);
+
+    /**
+     * Returns the name of the well-known header
+     * 
+     * @param id header identifier
+     * @return header name, empty string for unknown identifier
+     */
+    static const std::string& get_header_name(header_id id);
+
+    /**
+     * Returns raw bytes of the received request line and headers
+     * 
+     * @return header block
+     */
+    const std::string& get_header_block() const {
+        return m_header_block;
+    }
+
+    /**
+     * Internal method used by parser, appends received bytes to the header block
+     * 
+     * @param data received bytes
+     * @param len number of bytes
+     * @return offset of the appended bytes in the header block
+     */
+    std::size_t append_header_block(const char* data, std::size_t len) {
+        std::size_t offset = m_header_block.length();
+        m_header_block.append(data, len);
+        return offset;
+    }
+
+    /**
+     * Internal method used by parser, drops the bytes at the end
+     * of the header block, that were not consumed
+     * 
+     * @param len new length of the header block
+     */
+    void truncate_header_block(std::size_t len) {
+        if (len < m_header_block.length()) {
+            m_header_block.resize(len);
+        }
+    }
+
+    /**
+     * Internal method used by parser, adds a header, that is stored in the header block
+     * 
+     * @param name_offset offset of the header name in the header block
+     * @param name_length length of the header name
+     * @param value_offset offset of the header value in the header block
+     * @param value_length length of the header value
+     */
+    void add_header_view(std::size_t name_offset, std::size_t name_length,
+            std::size_t value_offset, std::size_t value_length) {
+        if (!m_headers.empty()) {
+            // headers were already moved to multimap
+            m_headers.insert(std::make_pair(
+                    std::string(m_header_block.data() + name_offset, name_length),
+                    std::string(m_header_block.data() + value_offset, value_length)));
+            return;
+        }
+        if (m_header_views_count == m_header_views.size()) {
+            m_header_views.emplace_back();
+        }
+        auto& hv = m_header_views[m_header_views_count];
+        hv.name_offset = name_offset;
+        hv.name_length = name_length;
+        hv.id = resolve_header_id(m_header_block.data() + name_offset, name_length);
+        // string capacity is kept when the message is reused
+        hv.value.assign(m_header_block.data() + value_offset, value_length);
+        m_header_views_count += 1;
+        if (HEADER_ID_UNKNOWN != hv.id && 0 == m_known_header_views[hv.id]) {
+            m_known_header_views[hv.id] = m_header_views_count;
+        }
+    }
+
     /**
      * Returns a value for the cookie if any are defined; otherwise, an empty string
      * since cookie names are insensitive, key should use lowercase alpha chars
@@ -642,6 +1113,7 @@ public:
      * @return value for the cookie if any are defined; otherwise, an empty string
      */
     const std::string& get_cookie(const std::string& key) const {
+        decode_pending_cookie_params();
         return get_value(m_cookie_params, key);
     }
     
@@ -651,6 +1123,7 @@ public:
      * @return cookie parameters multimap
      */
     headers_type& get_cookies() {
+        decode_pending_cookie_params();
         return m_cookie_params;
     }
 
@@ -662,6 +1135,7 @@ public:
      * @return true if at least one value for the cookie is defined
      */
     bool has_cookie(const std::string& key) const {
+        decode_pending_cookie_params();
         return (m_cookie_params.find(key) != m_cookie_params.end());
     }
 
@@ -673,6 +1147,7 @@ public:
      * @param value cookie value
      */
     void add_cookie(const std::string& key, const std::string& value) {
+        decode_pending_cookie_params();
         m_cookie_params.insert(std::make_pair(key, value));
     }
 
@@ -684,6 +1159,7 @@ public:
      * @param value cookie value
      */
     void change_cookie(const std::string& key, const std::string& value) {
+        decode_pending_cookie_params();
         change_value(m_cookie_params, key, value);
     }
 
@@ -694,8 +1170,17 @@ public:
      * @param key cookie name
      */
     void delete_cookie(const std::string& key) {
+        decode_pending_cookie_params();
         delete_value(m_cookie_params, key);
     }
+
+    /**
+     * Internal method used by parser, received "Cookie" headers
+     * are decoded into cookie parameters on first access
+     */
+    void set_cookie_params_pending() {
+        m_cookie_params_pending = true;
+    }
     
     /**
      * Returns a string containing the first line for the HTTP message
@@ -830,11 +1315,10 @@ public:
      * Sets the length of the payload content using the Content-Length header
      */
     void update_content_length_using_header() {
-        auto i = m_headers.find(HEADER_CONTENT_LENGTH);
-        if (i == m_headers.end()) {
+        if (!has_header(HEADER_ID_CONTENT_LENGTH)) {
             m_content_length = 0;
         } else {
-            std::string trimmed_length(i->second);
+            std::string trimmed_length(get_header(HEADER_ID_CONTENT_LENGTH));
             sl::utils::trim(trimmed_length);
             m_content_length = static_cast<size_t>(sl::utils::parse_uint64(trimmed_length));
         }
@@ -845,12 +1329,12 @@ public:
      */
     void update_transfer_encoding_using_header() {
         m_is_chunked = false;
-        auto i = m_headers.find(HEADER_TRANSFER_ENCODING);
-        if (i != m_headers.end()) {
+        if (has_header(HEADER_ID_TRANSFER_ENCODING)) {
+            auto& te = get_header(HEADER_ID_TRANSFER_ENCODING);
             // From RFC 2616, sec 3.6: All transfer-coding values are case-insensitive.
             // comparing only lower and camel variants for simplicity
-            if (std::string::npos != i->second.find("chunked") ||
-                    std::string::npos != i->second.find("Chunked")) {
+            if (std::string::npos != te.find("chunked") ||
+                    std::string::npos != te.find("Chunked")) {
                 m_is_chunked = true;
             } else {
                 m_is_chunked = false;
@@ -887,6 +1371,7 @@ public:
     void clear_content() {
         set_content_length(0);
         create_content_buffer();
+        materialize_headers();
         delete_value(m_headers, HEADER_CONTENT_TYPE);
     }
 
@@ -896,6 +1381,7 @@ public:
      * @param type content type
      */
     void set_content_type(const std::string& type) {
+        materialize_headers();
         change_value(m_headers, HEADER_CONTENT_TYPE, type);
     }
 
@@ -906,6 +1392,7 @@ public:
      * @param value header value
      */
     void add_header(const std::string& key, const std::string& value) {
+        materialize_headers();
         m_headers.insert(std::make_pair(key, value));
     }
 
@@ -916,6 +1403,7 @@ public:
      * @param value header value
      */
     void change_header(const std::string& key, const std::string& value) {
+        materialize_headers();
         change_value(m_headers, key, value);
     }
 
@@ -925,6 +1413,7 @@ public:
      * @param key header name
      */
     void delete_header(const std::string& key) {
+        materialize_headers();
         delete_value(m_headers, key);
     }
 
@@ -934,40 +1423,59 @@ public:
      * @return true if the HTTP connection may be kept alive
      */
     bool check_keep_alive() const {
-        return (get_header(HEADER_CONNECTION) != "close"
+        return (get_header(HEADER_ID_CONNECTION) != "close"
                 && (get_version_major() > 1
                 || (get_version_major() >= 1 && get_version_minor() >= 1)));
     }
 
     /**
-     * Initializes a vector of write buffers with the HTTP message information
+     * Appends received data to the payload content, content buffer
+     * is grown as needed, content length is updated by `concatenate_chunks()`
      *
-     * @param write_buffers vector of write buffers to initialize
-     * @param keep_alive true if the connection should be kept alive
-     * @param using_chunks true if the payload content will be sent in chunks
+     * @param data pointer to data
+     * @param len number of bytes to append
+     */
+    void append_content(const char* data, std::size_t len) {
+        m_content_buf.append(data, len);
+    }
+
+    /**
+     * Moves the payload content to a temporary file, content appended
+     * after this call is written to the file
+     *
+     * @param directory directory to create file in, system temporary
+     *        directory is used if empty
+     * @throws pion_exception if file cannot be created
+     */
+    void spill_content(const std::string& directory) {
+        m_content_buf.spill(directory);
+    }
+
+    /**
+     * Makes sure that the specified number of content bytes can be appended
+     * without reallocation
+     *
+     * @param len number of bytes
      */
-    void prepare_buffers_for_send(std::vector<asio::const_buffer>& write_buffers, const bool keep_alive,
-            const bool using_chunks) {
-        // update message headers
-        prepare_headers_for_send(keep_alive, using_chunks);
-        // add first message line
-        write_buffers.push_back(asio::buffer(get_first_line()));
-        write_buffers.push_back(asio::buffer(STRING_CRLF));
-        // append cookie headers (if any)
-        append_cookie_headers();
-        // append HTTP headers
-        append_headers(write_buffers);
+    void reserve_content(std::size_t len) {
+        m_content_buf.reserve(len);
+    }
+
+    /**
+     * Returns the number of bytes appended to the payload content
+     *
+     * @return number of bytes appended to the payload content
+     */
+    std::size_t get_appended_content_length() const {
+        return m_content_buf.size();
     }
 
     /**
-     * Pieces together all the received chunks
+     * Sets content length to the number of bytes in the content buffer,
+     * called after all received chunks were appended
      */
     void concatenate_chunks() {
-        set_content_length(m_chunk_cache.size());
-        char *post_buffer = create_content_buffer();
-        if (m_chunk_cache.size() > 0) {
-            std::memcpy(post_buffer, m_chunk_cache.data(), m_chunk_cache.size());
-        }
+        set_content_length(m_content_buf.size());
     }
 
 protected:
@@ -1023,43 +1531,103 @@ protected:
     }
 
     /**
-     * Prepares HTTP headers for a send operation
+     * Appends the message HTTP headers to the message head in wire format,
+     * "Connection", "Content-Length" and "Transfer-Encoding" headers are written
+     * with the values for this send operation instead of the values set
+     * on the message; final CRLF is not appended
      *
+     * @param head message head to append HTTP headers to
      * @param keep_alive true if the connection should be kept alive
      * @param using_chunks true if the payload content will be sent in chunks
      */
-    void prepare_headers_for_send(const bool keep_alive, const bool using_chunks) {
-        change_header(HEADER_CONNECTION, (keep_alive ? "Keep-Alive" : "close"));
-        if (using_chunks) {
-            if (get_chunks_supported()) {
-                change_header(HEADER_TRANSFER_ENCODING, "chunked");
+    void append_headers(std::string& head, const bool keep_alive, const bool using_chunks);
+
+    /**
+     * Appends HTTP headers for any cookies defined by the http::message
+     */
+    void append_cookie_headers() { }
+
+    /**
+     * Decodes received "Cookie" headers into cookie parameters,
+     * if this was not done yet
+     */
+    void decode_pending_cookie_params() const {
+        if (m_cookie_params_pending) {
+            decode_cookie_headers();
+        }
+    }
+
+    /**
+     * Decodes received "Cookie" headers into cookie parameters
+     */
+    void decode_cookie_headers() const;
+
+    /**
+     * Finds the first received header with the specified name
+     *
+     * @param key header name
+     * @return header view, null if not found
+     */
+    const header_view* find_header_view(const std::string& key) const {
+        header_id id = resolve_header_id(key.data(), key.length());
+        if (HEADER_ID_UNKNOWN != id) {
+            return find_header_view(id);
+        }
+        for (std::size_t i = 0; i < m_header_views_count; i++) {
+            auto& hv = m_header_views[i];
+            if (HEADER_ID_UNKNOWN == hv.id &&
+                    algorithm::iequals(m_header_block.data() + hv.name_offset, hv.name_length, key)) {
+                return std::addressof(hv);
             }
-        } else if (!m_do_not_send_content_length) {
-            change_header(HEADER_CONTENT_LENGTH, sl::support::to_string(get_content_length()));
         }
+        return nullptr;
     }
 
     /**
-     * Appends the message's HTTP headers to a vector of write buffers
+     * Finds the first received well-known header
      *
-     * @param write_buffers the buffers to append HTTP headers into
-     */
-    void append_headers(std::vector<asio::const_buffer>& write_buffers) {
-        // add HTTP headers
-        for (headers_type::const_iterator i = m_headers.begin(); i != m_headers.end(); ++i) {
-            write_buffers.push_back(asio::buffer(i->first));
-            write_buffers.push_back(asio::buffer(HEADER_NAME_VALUE_DELIMITER));
-            write_buffers.push_back(asio::buffer(i->second));
-            write_buffers.push_back(asio::buffer(STRING_CRLF));
+     * @param id header identifier
+     * @return header view, null if not found
+     */
+    const header_view* find_header_view(header_id id) const {
+        if (HEADER_ID_UNKNOWN == id || id >= HEADER_ID_COUNT) {
+            return nullptr;
         }
-        // add an extra CRLF to end HTTP headers
-        write_buffers.push_back(asio::buffer(STRING_CRLF));
+        std::size_t idx = m_known_header_views[id];
+        return 0 != idx ? std::addressof(m_header_views[idx - 1]) : nullptr;
     }
 
     /**
-     * Appends HTTP headers for any cookies defined by the http::message
+     * Marks all well-known headers as not received
      */
-    void append_cookie_headers() { }
+    void reset_known_header_views() {
+        std::memset(m_known_header_views, 0, sizeof(m_known_header_views));
+    }
+
+    /**
+     * Returns the value of the received header
+     *
+     * @param hv header view
+     * @return header value
+     */
+    const std::string& get_header_view_value(const header_view& hv) const {
+        return hv.value;
+    }
+
+    /**
+     * Moves received headers to the headers multimap, must be called
+     * before the multimap is accessed directly or modified
+     */
+    void materialize_headers() {
+        for (std::size_t i = 0; i < m_header_views_count; i++) {
+            auto& hv = m_header_views[i];
+            m_headers.insert(std::make_pair(
+                    std::string(m_header_block.data() + hv.name_offset, hv.name_length),
+                    get_header_view_value(hv)));
+        }
+        m_header_views_count = 0;
+        reset_known_header_views();
+    }
 
     /**
      * Returns the first value in a dictionary if key is found; or an empty
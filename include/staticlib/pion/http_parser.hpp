@@ -28,6 +28,7 @@
 
 #include <cstdint>
 #include <functional>
+#include <limits>
 #include <mutex>
 #include <string>
 
@@ -38,6 +39,13 @@
 #include "staticlib/pion/logger.hpp"
 #include "staticlib/pion/http_message.hpp"
 
+// SSE4.2 header scanning is compiled in on x86 unless disabled,
+// it is used only if supported by the CPU at runtime
+#if !defined(STATICLIB_PION_DISABLE_SIMD) && (defined(__x86_64__) || defined(__i386__) || \
+        defined(_M_X64) || defined(_M_IX86))
+#define STATICLIB_PION_SSE42_PARSER
+#endif
+
 namespace staticlib { 
 namespace pion {
 
@@ -83,6 +91,8 @@ public:
         ERROR_MISSING_CHUNK_DATA,
         ERROR_MISSING_HEADER_DATA,
         ERROR_MISSING_TOO_MUCH_CONTENT,
+        ERROR_CONTENT_FILE,
+        ERROR_CONTENT_TOO_LARGE,
     };
 
     /**
@@ -171,6 +181,30 @@ protected:
     const char * m_read_end_ptr;
 
 private:
+    /**
+     * Location of the token being parsed inside the header block of the message
+     */
+    struct token_view {
+        /**
+         * Offset of the first token byte in the header block
+         */
+        std::size_t offset;
+
+        /**
+         * Number of token bytes parsed
+         */
+        std::size_t length;
+
+        /**
+         * Constructor
+         *
+         * @param off offset of the first token byte in the header block
+         */
+        explicit token_view(std::size_t off = 0) :
+        offset(off),
+        length(0) { }
+    };
+
     /**
      * State used to keep track of where we are in parsing the HTTP message
      */
@@ -265,17 +299,17 @@ private:
     /**
      * Used for parsing the request method
      */
-    std::string m_method;
+    token_view m_method;
 
     /**
      * Used for parsing the name of resource requested
      */
-    std::string m_resource;
+    token_view m_resource;
 
     /**
      * Used for parsing the query string portion of a URI
      */
-    std::string m_query_string;
+    token_view m_query_string;
 
     /**
      * Used to store the raw contents of HTTP headers when m_save_raw_headers is true
@@ -285,17 +319,12 @@ private:
     /**
      * Used for parsing the name of HTTP headers
      */
-    std::string m_header_name;
+    token_view m_header_name;
 
     /**
      * Used for parsing the value of HTTP headers
      */
-    std::string m_header_value;
-
-    /**
-     * Used for parsing the chunk size
-     */
-    std::string m_chunk_size_str;
+    token_view m_header_value;
 
     /**
      * Number of bytes in the chunk currently being parsed
@@ -332,6 +361,29 @@ private:
      */
     size_t m_max_content_length;
 
+    /**
+     * Payload content longer than this is stored in a temporary file
+     * instead of memory, zero disables storing content in files
+     */
+    size_t m_content_spill_threshold;
+
+    /**
+     * Max length of the payload content of the current message, longer
+     * content (including the chunked one and the one passed to the payload
+     * handler) is rejected with ERROR_CONTENT_TOO_LARGE, zero means no limit
+     */
+    uint64_t m_content_limit;
+
+    /**
+     * Sum of the chunk sizes of the current chunked message
+     */
+    uint64_t m_bytes_chunks_declared;
+
+    /**
+     * Directory for temporary content files, system temporary directory is used if empty
+     */
+    std::string m_content_spill_directory;
+
     /**
      * If true, then only HTTP headers will be parsed (no content parsing)
      */
@@ -342,6 +394,11 @@ private:
      */
     bool m_save_raw_headers;
 
+    /**
+     * If true, plain bytes of URI and headers are skipped using SIMD instructions
+     */
+    bool m_use_simd;
+
     /**
      * Points to a single and unique instance of the parser error_category_t
      */
@@ -371,8 +428,12 @@ public:
     m_bytes_last_read(0),
     m_bytes_total_read(0),
     m_max_content_length(max_content_length),
+    m_content_spill_threshold(0),
+    m_content_limit(0),
+    m_bytes_chunks_declared(0),
     m_parse_headers_only(false),
-    m_save_raw_headers(false) { }
+    m_save_raw_headers(false),
+    m_use_simd(is_simd_supported()) { }
 
     /**
      * Deleted copy constructor
@@ -469,19 +530,27 @@ public:
     }
     
     /**
-     * Resets the parser to its initial state
+     * Resets the parser to its initial state, so it can be reused
+     * to parse the next message, allocated string buffers are kept
      */
     void reset() {
+        m_read_ptr = m_read_end_ptr = nullptr;
         m_message_parse_state = PARSE_START;
         m_headers_parse_state = PARSE_METHOD_START;
         m_chunked_content_parse_state = PARSE_CHUNK_SIZE_START;
+        m_payload_handler = nullptr;
         m_status_code = 0;
         m_status_message.erase();
-        m_method.erase();
-        m_resource.erase();
-        m_query_string.erase();
+        m_method = token_view();
+        m_resource = token_view();
+        m_query_string = token_view();
         m_raw_headers.erase();
+        m_header_name = token_view();
+        m_header_value = token_view();
+        m_size_of_current_chunk = m_bytes_read_in_current_chunk = 0;
+        m_bytes_content_remaining = 0;
         m_bytes_content_read = m_bytes_last_read = m_bytes_total_read = 0;
+        m_content_limit = m_bytes_chunks_declared = 0;
     }
 
     /**
@@ -529,6 +598,38 @@ public:
         return m_bytes_content_read;
     }
 
+    /**
+     * Returns true if no bytes of the message were parsed yet
+     * and there are no more bytes available in the read buffer
+     *
+     * @return true if the parsing of the message is not started
+     */
+    bool is_parsing_not_started() const {
+        return PARSE_START == m_message_parse_state && eof();
+    }
+
+    /**
+     * Returns true if the parser has finished parsing headers
+     * and is parsing the payload content
+     * 
+     * @return true if parsing the payload content
+     */
+    bool is_parsing_content() const {
+        return PARSE_CONTENT == m_message_parse_state ||
+                PARSE_CONTENT_NO_LENGTH == m_message_parse_state ||
+                PARSE_CHUNKS == m_message_parse_state;
+    }
+
+    /**
+     * Returns the number of payload content bytes that have not yet been read,
+     * only meaningful for the content with a known length
+     * 
+     * @return number of payload content bytes remaining
+     */
+    size_t get_content_bytes_remaining() const {
+        return PARSE_CONTENT == m_message_parse_state ? m_bytes_content_remaining : 0;
+    }
+
     /**
      * Returns the maximum length for HTTP payload content
      * 
@@ -602,6 +703,45 @@ public:
         m_max_content_length = DEFAULT_CONTENT_MAX;
     }
 
+    /**
+     * Sets the max length of the payload content of the current message,
+     * unlike the maximum length for HTTP payload content (that truncates
+     * the stored content) longer messages are rejected with ERROR_CONTENT_TOO_LARGE;
+     * applies to the content passed to the payload handler too, limit is cleared on reset
+     *
+     * @param limit max length of the payload content, zero means no limit
+     */
+    void set_content_limit(uint64_t limit) {
+        m_content_limit = limit;
+    }
+
+    /**
+     * Sets the length of payload content, above which content is stored
+     * in an unlinked temporary file instead of memory; such content
+     * is still limited with the maximum length for HTTP payload content
+     *
+     * @param threshold max length of content stored in memory,
+     *        zero disables storing content in files
+     * @param directory directory for temporary files, system
+     *        temporary directory is used if empty
+     */
+    void set_content_spill(size_t threshold, const std::string& directory) {
+        m_content_spill_threshold = threshold;
+        if (directory != m_content_spill_directory) {
+            m_content_spill_directory = directory;
+        }
+    }
+
+    /**
+     * Returns the length of payload content, above which content
+     * is stored in a temporary file
+     *
+     * @return max length of content stored in memory, zero if disabled
+     */
+    size_t get_content_spill_threshold() const {
+        return m_content_spill_threshold;
+    }
+
     /**
      * Sets parameter for saving raw HTTP header content
      * 
@@ -611,6 +751,32 @@ public:
         m_save_raw_headers = b;
     }
 
+    /**
+     * Enables or disables skipping of plain URI and header bytes using SIMD
+     * instructions, enabled by default if supported by the CPU
+     * 
+     * @param b true to use SIMD instructions, ignored if they are not supported
+     */
+    void set_use_simd(bool b) {
+        m_use_simd = b && is_simd_supported();
+    }
+
+    /**
+     * Returns true if plain URI and header bytes are skipped using SIMD instructions
+     * 
+     * @return true if SIMD instructions are used
+     */
+    bool get_use_simd() const {
+        return m_use_simd;
+    }
+
+    /**
+     * Returns true if SIMD header scanning is compiled in and is supported by the CPU
+     * 
+     * @return true if SIMD header scanning is supported
+     */
+    static bool is_simd_supported();
+
     /**
      * Parses a URI string
      *
@@ -732,12 +898,15 @@ public:
 protected:
 
     /**
-     * Called after we have finished parsing the HTTP message headers
+     * Called after we have finished parsing the HTTP message headers,
+     * before the content buffer is prepared, so the payload handler and
+     * the max content length set here are used for the content
      * 
-     * @param 
-     * @param 
+     * @param ec error code, may be set to reject the message
+     * @param rc result code, false: abort, true: ignore content,
+     *        indeterminate: continue
      */
-    virtual void finished_parsing_headers(const std::error_code& /* ec */, sl::support::tribool& /* rc */) {
+    virtual void finished_parsing_headers(std::error_code& /* ec */, sl::support::tribool& /* rc */) {
         // no-op
     }
     
@@ -755,6 +924,51 @@ protected:
      */
     sl::support::tribool parse_headers(http_message& http_msg, std::error_code& ec);
 
+    /**
+     * Updates the counters of bytes read and drops the unconsumed bytes
+     * from the header block after parsing the headers
+     *
+     * @param http_msg the HTTP message object being parsed
+     * @param read_start_ptr first byte parsed by the last operation
+     * @param block_offset offset of the first byte parsed in the header block
+     */
+    void finish_headers_read(http_message& http_msg, const char* read_start_ptr,
+            std::size_t block_offset);
+
+    /**
+     * Skips the bytes of the URI or header token being parsed, that do not need
+     * special handling; stops before the delimiter or an unusual byte,
+     * that is left to the state machine
+     */
+    void skip_plain_token_bytes();
+
+    /**
+     * Skips the bytes that belong to the allowed ranges and adds them to the token,
+     * token is not extended over its max length
+     *
+     * @param token token being parsed
+     * @param max_length max token length
+     * @param ranges pairs of inclusive bounds of allowed bytes, padded with zeros to 16 bytes
+     * @param ranges_length number of bytes used in ranges
+     */
+    void skip_allowed_bytes(token_view& token, std::size_t max_length,
+            const char* ranges, int ranges_length);
+
+    /**
+     * Counts the leading bytes, that belong to the allowed ranges,
+     * using SSE4.2 range comparisons on 16-byte blocks, trailing
+     * bytes that do not fill the whole block are not checked;
+     * must be called only if the CPU supports SSE4.2
+     *
+     * @param data bytes to check
+     * @param len number of bytes
+     * @param ranges pairs of inclusive bounds of allowed bytes, padded with zeros to 16 bytes
+     * @param ranges_length number of bytes used in ranges
+     * @return number of leading allowed bytes
+     */
+    static std::size_t count_allowed_sse42(const char* data, std::size_t len,
+            const char* ranges, int ranges_length);
+
     /**
      * Updates an http::message object with data obtained from parsing headers
      *
@@ -763,9 +977,10 @@ protected:
     void update_message_with_header_data(http_message& http_msg) const;
 
     /**
-     * Parses a chunked HTTP message-body using bytes available in the read buffer
+     * Parses a chunked HTTP message-body using bytes available in the read buffer,
+     * chunks data is appended to the message content buffer
      *
-     * @param chunk_buffers buffers to be populated from parsing chunked content
+     * @param http_msg the HTTP message object to append chunks data to
      * @param ec error_code contains additional information for parsing errors
      *
      * @return tribool result of parsing:
@@ -773,7 +988,7 @@ protected:
      *                        true = finished parsing message,
      *                        indeterminate = message is not yet finished
      */
-    sl::support::tribool parse_chunks(std::vector<char>& chunk_buffers, std::error_code& ec);
+    sl::support::tribool parse_chunks(http_message& http_msg, std::error_code& ec);
 
     /**
      * Consumes payload content in the parser's read buffer 
@@ -792,10 +1007,21 @@ protected:
      * Consume the bytes available in the read buffer, converting them into
      * the next chunk for the HTTP message
      *
-     * @param chunk_buffers buffers to be populated from parsing chunked content
+     * @param http_msg the HTTP message object to append content to
      * @return size_t number of content bytes consumed, if any
      */
-    size_t consume_content_as_next_chunk(std::vector<char>& chunk_buffers);
+    size_t consume_content_as_next_chunk(http_message& http_msg);
+
+    /**
+     * Appends received content to the message content buffer up to the maximum
+     * content length, content is moved to a temporary file when it grows
+     * over the spill threshold
+     *
+     * @param http_msg the HTTP message object to append content to
+     * @param data pointer to content
+     * @param len number of bytes received
+     */
+    void store_content(http_message& http_msg, const char* data, std::size_t len);
 
     /**
      * Compute and sets a HTTP Message data integrity status
@@ -831,6 +1057,24 @@ protected:
     static bool is_hex_digit(int c) {
         return ((c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F'));
     }
+
+    static std::size_t hex_digit_value(int c) {
+        return static_cast<std::size_t>(c <= '9' ? c - '0' : (c | 0x20) - 'a' + 10);
+    }
+
+    /**
+     * Appends hex digit to the size of the current chunk
+     *
+     * @param c hex digit
+     * @return false if chunk size overflows
+     */
+    bool append_chunk_size_digit(int c) {
+        if (m_size_of_current_chunk > ((std::numeric_limits<std::size_t>::max)() >> 4)) {
+            return false;
+        }
+        m_size_of_current_chunk = (m_size_of_current_chunk << 4) | hex_digit_value(c);
+        return true;
+    }
     
     static bool is_cookie_attribute(const std::string& name, bool set_cookie_header);
 
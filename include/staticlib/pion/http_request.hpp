@@ -27,20 +27,28 @@
 #define STATICLIB_PION_HTTP_REQUEST_HPP
 
 #include <functional>
+#include <memory>
 #include <string>
 
 #include "staticlib/config.hpp"
 
 #include "staticlib/pion/http_message.hpp"
 #include "staticlib/pion/http_parser.hpp"
+#include "staticlib/pion/radix_router.hpp"
 
 namespace staticlib { 
 namespace pion {
 
+// forward declaration
+class http_connection_cache;
+
 /**
- * Container for HTTP request information
+ * Container for HTTP request information; query, cookie and form parameters
+ * are decoded on first access, so the request must not be accessed
+ * concurrently from multiple threads, even through the const methods
  */
 class http_request : public http_message {
+    friend class http_request_deleter;
 
     /**
      * Request method (GET, POST, PUT, etc.)
@@ -65,7 +73,22 @@ class http_request : public http_message {
     /**
      * HTTP query parameters parsed from the request line and post content
      */
-    std::unordered_multimap<std::string, std::string, algorithm::ihash, algorithm::iequal_to> m_query_params;
+    mutable std::unordered_multimap<std::string, std::string, algorithm::ihash, algorithm::iequal_to> m_query_params;
+
+    /**
+     * True if received query string is not yet decoded into query parameters
+     */
+    mutable bool m_query_params_pending;
+
+    /**
+     * True if received form content is not yet decoded into query parameters
+     */
+    mutable bool m_form_params_pending;
+
+    /**
+     * Path parameters captured by the route that matched this request
+     */
+    path_params_type m_path_params;
 
     /**
      * Payload handler used with this request
@@ -77,13 +100,22 @@ class http_request : public http_message {
      */
     http_parser* m_request_reader;    
 
+    /**
+     * Cache of the connection this request was read from, cleared request
+     * is returned to this cache when it is no longer used
+     */
+    std::weak_ptr<http_connection_cache> m_connection_cache;
+
 public:
 
     /**
      * Constructs a new request object (default constructor)
      */
     http_request() :
-    m_method(REQUEST_METHOD_GET) { }
+    m_method(REQUEST_METHOD_GET),
+    m_query_params_pending(false),
+    m_form_params_pending(false),
+    m_request_reader(nullptr) { }
 
     /**
      * Deleted copy constructor
@@ -110,6 +142,11 @@ public:
         m_original_resource.erase();
         m_query_string.erase();
         m_query_params.clear();
+        m_query_params_pending = false;
+        m_form_params_pending = false;
+        m_path_params.clear();
+        m_payload_handler = nullptr;
+        m_request_reader = nullptr;
     }
 
     /**
@@ -164,6 +201,7 @@ public:
      * @return value for the query key if any are defined; otherwise, an empty string
      */
     const std::string& get_query(const std::string& key) const {
+        decode_pending_query_params();
         return get_value(m_query_params, key);
     }
 
@@ -173,6 +211,7 @@ public:
      * @return query parameters multimap
      */
     std::unordered_multimap<std::string, std::string, algorithm::ihash, algorithm::iequal_to>& get_queries() {
+        decode_pending_query_params();
         return m_query_params;
     }
 
@@ -183,9 +222,45 @@ public:
      * @return true if at least one value for the query key is defined
      */
     bool has_query(const std::string& key) const {
+        decode_pending_query_params();
         return (m_query_params.find(key) != m_query_params.end());
     }
 
+    /**
+     * Returns a value of the path parameter captured by the route
+     * that matched this request (i.e. `id` for `/users/{id}`)
+     * 
+     * @param name parameter name
+     * @return value as it appears in the path (not URL-decoded),
+     *         empty string if parameter is not defined
+     */
+    const std::string& get_path_param(const std::string& name) const {
+        for (auto& pa : m_path_params) {
+            if (pa.first == name) {
+                return pa.second;
+            }
+        }
+        return STRING_EMPTY;
+    }
+
+    /**
+     * Returns the path parameters captured by the route that matched this request
+     * 
+     * @return list of path parameters
+     */
+    const path_params_type& get_path_params() const {
+        return m_path_params;
+    }
+
+    /**
+     * Returns the path parameters captured by the route that matched this request
+     * 
+     * @return list of path parameters
+     */
+    path_params_type& get_path_params() {
+        return m_path_params;
+    }
+
     /**
      * Sets the HTTP request method (i.e. GET, POST, PUT)
      * 
@@ -196,6 +271,17 @@ public:
         clear_first_line();
     }
 
+    /**
+     * Sets the HTTP request method (i.e. GET, POST, PUT)
+     * 
+     * @param data request method data
+     * @param len request method length
+     */
+    void set_method(const char* data, std::size_t len) {
+        m_method.assign(data, len);
+        clear_first_line();
+    }
+
     /**
      * Sets the resource or uri-stem originally requested
      */
@@ -204,6 +290,18 @@ public:
         clear_first_line();
     }
 
+    /**
+     * Sets the resource or uri-stem originally requested
+     * 
+     * @param data resource data
+     * @param len resource length
+     */
+    void set_resource(const char* data, std::size_t len) {
+        m_resource.assign(data, len);
+        m_original_resource.assign(data, len);
+        clear_first_line();
+    }
+
     /**
      * Changes the resource or uri-stem to be delivered (called as the result of a redirect)
      * 
@@ -223,6 +321,17 @@ public:
         clear_first_line();
     }
 
+    /**
+     * Sets the uri-query or query string requested
+     * 
+     * @param data query string data
+     * @param len query string length
+     */
+    void set_query_string(const char* data, std::size_t len) {
+        m_query_string.assign(data, len);
+        clear_first_line();
+    }
+
     /**
      * Adds a value for the query key
      * 
@@ -230,6 +339,7 @@ public:
      * @param value additional value for this key
      */
     void add_query(const std::string& key, const std::string& value) {
+        decode_pending_query_params();
         m_query_params.insert(std::make_pair(key, value));
     }
 
@@ -240,6 +350,7 @@ public:
      * @param value value for this key
      */
     void change_query(const std::string& key, const std::string& value) {
+        decode_pending_query_params();
         change_value(m_query_params, key, value);
     }
 
@@ -249,6 +360,7 @@ public:
      * @param key query key
      */
     void delete_query(const std::string& key) {
+        decode_pending_query_params();
         delete_value(m_query_params, key);
     }
 
@@ -256,6 +368,7 @@ public:
      * Use the query parameters to build a query string for the request
      */
     void use_query_params_for_query_string() {
+        decode_pending_query_params();
         set_query_string(make_query_string(m_query_params));
     }
 
@@ -263,6 +376,7 @@ public:
      * Use the query parameters to build POST content for the request
      */
     void use_query_params_for_post_content() {
+        decode_pending_query_params();
         std::string post_content(make_query_string(m_query_params));
         set_content_length(post_content.size());
         char *ptr = create_content_buffer(); // null-terminates buffer
@@ -273,6 +387,18 @@ public:
         set_content_type(CONTENT_TYPE_URLENCODED);
     }
 
+    /**
+     * Moves the payload content out of the request without copying,
+     * received form content is decoded into query parameters before
+     * the content is moved
+     *
+     * @return payload content
+     */
+    content_block take_content() {
+        decode_pending_query_params();
+        return http_message::take_content();
+    }
+
     /**
      * Add content (for POST) from string
      * 
@@ -341,8 +467,48 @@ public:
         m_request_reader = rr;
     }
 
+    /**
+     * Internal method used to reuse request objects over keep-alive connections
+     * 
+     * @param cache cache of the connection this request is read from
+     */
+    void set_connection_cache(const std::shared_ptr<http_connection_cache>& cache) {
+        m_connection_cache = cache;
+    }
+
+    /**
+     * Internal method used by parser, received query string
+     * is decoded into query parameters on first access
+     */
+    void set_query_params_pending() {
+        m_query_params_pending = true;
+    }
+
+    /**
+     * Internal method used by parser, received url-encoded or multipart
+     * content is decoded into query parameters on first access
+     */
+    void set_form_params_pending() {
+        m_form_params_pending = true;
+    }
+
 protected:
 
+    /**
+     * Decodes received query string and form content into query parameters,
+     * if this was not done yet
+     */
+    void decode_pending_query_params() const {
+        if (m_query_params_pending || m_form_params_pending) {
+            decode_query_params();
+        }
+    }
+
+    /**
+     * Decodes received query string and form content into query parameters
+     */
+    void decode_query_params() const;
+
     /**
      * Updates the string containing the first line for the HTTP message
      */
@@ -378,9 +544,40 @@ protected:
 };
 
 /**
- * Data type for a HTTP request pointer
+ * Deleter for the request objects, returns the cleared request to the cache
+ * of its connection to be reused by the next request over the same connection,
+ * requests without the cache are destroyed
+ */
+class http_request_deleter {
+public:
+    /**
+     * Default constructor
+     */
+    http_request_deleter() { }
+
+    /**
+     * Conversion constructor, allows to take requests from `std::unique_ptr`
+     * with the default deleter
+     */
+    http_request_deleter(const std::default_delete<http_request>&) { }
+
+    /**
+     * Clears the request and returns it to the connection cache
+     * or destroys it
+     * 
+     * @param request request object
+     */
+    void operator()(http_request* request) const;
+};
+
+/**
+ * Data type for a HTTP request pointer, uses the custom deleter to reuse requests
+ * over the same connection; NOTE: it is no longer `std::unique_ptr<http_request>`,
+ * handlers that spell out that type must use `http_request_ptr` instead
+ * (`std::unique_ptr<http_request>` still can be moved into `http_request_ptr`,
+ * but not the other way around)
  */
-using http_request_ptr = std::unique_ptr<http_request>;
+using http_request_ptr = std::unique_ptr<http_request, http_request_deleter>;
 
 
 } // namespace
@@ -63,11 +63,42 @@ private:
      */
     uint32_t read_timeout_millis;
 
+    /**
+     * Whether the request must be received before the deadline
+     */
+    bool has_deadline;
+
+    /**
+     * Point in time before that the request must be received
+     */
+    std::chrono::steady_clock::time_point deadline;
+
+    /**
+     * Max number of bytes to read in a single operation while reading the body
+     */
+    std::size_t max_read_size;
+
+    /**
+     * Number of bytes to request in the next body read operation
+     */
+    std::size_t body_read_size;
+
+    /**
+     * Number of bytes requested in the last read operation
+     */
+    std::size_t last_read_size;
+
     /**
      * The new HTTP message container being created
      */
     http_request_ptr request;
 
+    /**
+     * Snapshot of the server routes, taken once when the request headers
+     * are parsed and used to dispatch the whole request
+     */
+    std::shared_ptr<const void> routes;
+
 public:
 
     /**
@@ -75,16 +106,21 @@ public:
      *
      * @param server reference to server
      * @param tcp_conn TCP connection containing a new message to parse
+     * @param read_timeout max number of milliseconds for read operations
+     * @param max_read max number of bytes to read in a single operation
+     *        while reading the body
      */
     http_request_reader(http_server& srv, tcp_connection_ptr& tcp_conn,
-            uint32_t read_timeout) :
+            uint32_t read_timeout, std::size_t max_read) :
     http_parser(true),
     server(srv),
     tcp_conn(tcp_conn),
     read_timeout_millis(read_timeout),
-    request(new http_request()) {
-        request->set_remote_ip(tcp_conn->get_remote_ip());
-        request->set_request_reader(this);
+    has_deadline(false),
+    max_read_size(max_read),
+    body_read_size(tcp_connection::READ_BUFFER_SIZE),
+    last_read_size(tcp_connection::READ_BUFFER_SIZE) {
+        prepare_request();
     }
 
     /**
@@ -102,6 +138,46 @@ public:
      */
     http_request_reader& operator=(const http_request_reader&) = delete;
 
+    /**
+     * Prepares the reader, that was used for a previous request,
+     * to read the next request
+     *
+     * @param tcp_conn TCP connection containing a new message to parse
+     * @param read_timeout max number of milliseconds for read operations
+     * @param max_read max number of bytes to read in a single operation
+     *        while reading the body
+     */
+    void reset(tcp_connection_ptr& tcp_conn, uint32_t read_timeout, std::size_t max_read);
+
+    /**
+     * Sets the timeout for the subsequent read operations of this request
+     *
+     * @param read_timeout max number of milliseconds for read operations
+     */
+    void set_read_timeout(uint32_t read_timeout) {
+        read_timeout_millis = read_timeout;
+    }
+
+    /**
+     * Sets the deadline for receiving the rest of this request, read operations
+     * do not wait past the deadline
+     *
+     * @param millis number of milliseconds from now
+     */
+    void set_request_deadline(uint32_t millis) {
+        has_deadline = true;
+        deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(millis);
+    }
+
+    /**
+     * Sets the snapshot of the server routes used for this request
+     *
+     * @param table route table snapshot
+     */
+    void set_routes(std::shared_ptr<const void> table) {
+        routes = std::move(table);
+    }
+
     /**
      * Incrementally reads & parses the HTTP message
      */
@@ -132,12 +208,28 @@ private:
      */
     static void read_bytes_with_timeout(std::unique_ptr<http_request_reader> self);
 
+    /**
+     * Returns the number of bytes to request in the next read operation,
+     * body reads grow after the reads that filled the whole buffer,
+     * but are not larger than the remaining content
+     * 
+     * @return number of bytes to read
+     */
+    std::size_t next_read_size();
+
+    /**
+     * Takes the request object from the connection cache or creates a new one
+     */
+    void prepare_request();
+
     /**
      * Handles errors that occur during read operations
      *
+     * @param self-owning instance
      * @param read_error error status from the last read operation
      */
-    void handle_read_error(const std::error_code& read_error);
+    static void handle_read_error(std::unique_ptr<http_request_reader> self,
+            const std::error_code& read_error);
 
     /**
      * Called after we have finished parsing the HTTP message headers
@@ -145,14 +237,17 @@ private:
      * @param ec error code reference
      * @param rc result code reference
      */
-    void finished_parsing_headers(const std::error_code& ec, sl::support::tribool& rc);
+    void finished_parsing_headers(std::error_code& ec, sl::support::tribool& rc);
 
     /**
-     * Called after we have finished reading/parsing the HTTP message
+     * Called after we have finished reading/parsing the HTTP message,
+     * reader is returned to the connection cache before the request is handled
      * 
+     * @param self-owning instance
      * @param ec error code reference
      */
-    void finished_reading(const std::error_code& ec);
+    static void finished_reading(std::unique_ptr<http_request_reader> self,
+            const std::error_code& ec);
 
 };
 
@@ -26,13 +26,16 @@
 #ifndef STATICLIB_PION_HTTP_RESPONSE_HPP
 #define STATICLIB_PION_HTTP_RESPONSE_HPP
 
+#include <ctime>
 #include <memory>
+#include <string>
 
 #include "staticlib/config.hpp"
 
 #include "staticlib/pion/algorithm.hpp"
 #include "staticlib/pion/http_message.hpp"
 #include "staticlib/pion/http_request.hpp"
+#include "staticlib/pion/shared_buffer.hpp"
 
 namespace staticlib { 
 namespace pion {
@@ -57,6 +60,11 @@ class http_response : public http_message {
      */
     std::string request_method;
 
+    /**
+     * Header lines serialized in advance, sent after the other headers
+     */
+    shared_buffer raw_headers;
+
 public:
 
     /**
@@ -79,7 +87,8 @@ public:
     http_message(http_response),
     status_code(http_response.status_code),
     status_message(http_response.status_message),
-    request_method(http_response.request_method) { }
+    request_method(http_response.request_method),
+    raw_headers(http_response.raw_headers) { }
 
     /**
      * Virtual destructor
@@ -94,6 +103,7 @@ public:
         status_code = RESPONSE_CODE_OK;
         status_message = RESPONSE_MESSAGE_OK;
         request_method.clear();
+        raw_headers = shared_buffer();
     }
 
     /**
@@ -254,6 +264,38 @@ public:
      */
     void set_last_modified(const unsigned long t);
 
+    /**
+     * Sets the header lines serialized in advance, they are sent as is
+     * after the other headers; allows to send the same set of headers
+     * with many responses without adding them one by one
+     *
+     * @param headers header lines, each line must end with CRLF
+     */
+    void set_raw_headers(shared_buffer headers) {
+        raw_headers = std::move(headers);
+    }
+
+    /**
+     * Formats the specified time as an HTTP date (IMF-fixdate from RFC 7231),
+     * i.e. "Sun, 06 Nov 1994 08:49:37 GMT"
+     *
+     * @param t time to format
+     * @return formatted date
+     */
+    static std::string make_http_date(std::time_t t);
+
+    /**
+     * Writes the response status line and HTTP headers into the specified
+     * buffer, ready to be sent; status lines of the common responses are
+     * precomputed and "Date" header (unless set on the response) is taken
+     * from the value cached for the current second
+     *
+     * @param head buffer to append the response head to
+     * @param keep_alive true if the connection should be kept alive
+     * @param using_chunks true if the payload content will be sent in chunks
+     */
+    void serialize_head(std::string& head, const bool keep_alive, const bool using_chunks);
+
 protected:
 
     /**
@@ -26,6 +26,7 @@
 #ifndef STATICLIB_PION_HTTP_RESPONSE_WRITER_HPP
 #define STATICLIB_PION_HTTP_RESPONSE_WRITER_HPP
 
+#include <cstdint>
 #include <functional>
 #include <list>
 #include <memory>
@@ -38,17 +39,64 @@
 #include "staticlib/io/span.hpp"
 
 #include "staticlib/pion/logger.hpp"
+#include "staticlib/pion/pion_exception.hpp"
 #include "staticlib/pion/http_message.hpp"
 #include "staticlib/pion/http_response.hpp"
+#include "staticlib/pion/shared_buffer.hpp"
 #include "staticlib/pion/tcp_connection.hpp"
+#include "staticlib/pion/write_arena.hpp"
 
 namespace staticlib { 
 namespace pion {
 
+// forward declaration
+class http_response_writer;
+// forward declaration of the file sending state
+class file_transfer;
+
+/**
+ * Deleter for the writer objects, returns the cleared writer to the cache
+ * of its connection to be reused by the next response over the same connection,
+ * writers without the cache are destroyed
+ */
+class http_response_writer_deleter {
+public:
+    /**
+     * Default constructor
+     */
+    http_response_writer_deleter() { }
+
+    /**
+     * Conversion constructor, allows to take writers from `std::unique_ptr`
+     * with the default deleter
+     */
+    http_response_writer_deleter(const std::default_delete<http_response_writer>&) { }
+
+    /**
+     * Clears the writer and returns it to the connection cache
+     * or destroys it
+     * 
+     * @param writer writer object
+     */
+    void operator()(http_response_writer* writer) const;
+};
+
+/**
+ * Data type for a response_writer pointer, uses the custom deleter to reuse writers
+ * over the same connection; NOTE: it is no longer `std::unique_ptr<http_response_writer>`,
+ * handlers that spell out that type must use `response_writer_ptr` instead
+ * (`std::unique_ptr<http_response_writer>` still can be moved into `response_writer_ptr`,
+ * but not the other way around)
+ */
+using response_writer_ptr = std::unique_ptr<http_response_writer, http_response_writer_deleter>;
+
 /**
  * Sends HTTP data asynchronously
  */
 class http_response_writer {
+    friend class http_response_writer_deleter;
+    friend class file_transfer;
+
     /**
      * The HTTP connection that we are writing the message to
      */
@@ -60,9 +108,21 @@ class http_response_writer {
     std::vector<asio::const_buffer> content_buffers;
 
     /**
-     * Caches binary data included within the payload content
+     * Holds copies of the data written, slabs are taken
+     * from the content buffer pool of the connection
      */
-    std::vector<std::unique_ptr<char[]>> payload_cache;
+    write_arena arena;
+
+    /**
+     * Keeps the shared data written alive until the response is sent
+     */
+    std::vector<shared_buffer> shared_buffers;
+
+    /**
+     * End of the data copied into the arena, if the last content buffer
+     * ends with this data, null otherwise
+     */
+    const char* copied_end;
 
     /**
      * The length (in bytes) of the response content to be sent (Content-Length)
@@ -90,11 +150,30 @@ class http_response_writer {
     std::unique_ptr<http_response> response;
 
     /**
-     * The initial HTTP response header line
+     * Serialized response status line and headers, memory is reused
+     * by the following responses over the same connection
      */
-    std::string response_line;
+    std::string head;
 
 public:
+    /**
+     * Data passed to `write_nocopy()` that is smaller than this is copied
+     */
+    static const std::size_t NOCOPY_MIN_SIZE = 256;
+
+    /**
+     * Max number of content buffers, after which the data passed to `write_nocopy()`
+     * and `write_shared()` that is not larger than `MAX_COALESCED_SIZE` is copied;
+     * asio passes at most 64 buffers to a single "writev" call (well below IOV_MAX),
+     * the rest is left for the head and chunk framing
+     */
+    static const std::size_t MAX_CONTENT_BUFFERS = 60;
+
+    /**
+     * Data larger than this is never copied, content buffers above
+     * `MAX_CONTENT_BUFFERS` are split by asio between several "writev" calls
+     */
+    static const std::size_t MAX_COALESCED_SIZE = 64 * 1024;
 
     /**
      * Constructor to be used with `std::make_unique`
@@ -104,11 +183,13 @@ public:
      */
     http_response_writer(tcp_connection_ptr& tcp_conn, const http_request& http_request) :
     tcp_conn(tcp_conn),
+    copied_end(nullptr),
     content_length(0),
     client_supports_chunks(true),
     sending_chunks(false),
     sent_headers(false),
     response(new http_response(http_request)) {
+        arena.set_pool(tcp_conn->get_content_buffer_pool());
         // set whether or not the client supports chunks
         supports_chunked_messages(response->get_chunks_supported());
     }
@@ -123,6 +204,24 @@ public:
      */
     http_response_writer& operator=(const http_response_writer&) = delete;
 
+    /**
+     * Prepares the writer, that was used for a previous response,
+     * to send the response to the next request
+     * 
+     * @param conn TCP connection used to send the response
+     * @param request the request we are responding to
+     */
+    void reset(tcp_connection_ptr& conn, const http_request& request) {
+        tcp_conn = conn;
+        clear();
+        arena.set_pool(conn->get_content_buffer_pool());
+        sending_chunks = false;
+        sent_headers = false;
+        response->clear();
+        response->update_request_info(request);
+        supports_chunked_messages(response->get_chunks_supported());
+    }
+
     /**
      * Returns a non-const reference to the response that will be sent
      * 
@@ -137,18 +236,21 @@ public:
      */
     void clear() {
         content_buffers.clear();
-        payload_cache.clear();
+        arena.clear();
+        shared_buffers.clear();
+        copied_end = nullptr;
         content_length = 0;
     }
 
     /**
-     * Write payload content
+     * Write payload content, data is copied and adjacent
+     * copied writes are sent as a single buffer
      *
      * @param data to append to the payload content
      */
     void write(sl::io::span<const char> data) {
         if (response->is_body_allowed() && data.size() > 0) {
-            content_buffers.push_back(add_to_cache(data));
+            add_copy(data);
             content_length += data.size();
         }
     }
@@ -156,17 +258,45 @@ public:
     /**
      * Write payload content; the data written is not
      * copied, and therefore must persist until the message has finished
-     * sending
+     * sending; data smaller than `NOCOPY_MIN_SIZE` (or not larger than
+     * `MAX_COALESCED_SIZE` after `MAX_CONTENT_BUFFERS` buffers) is copied
+     * to be sent together with the adjacent writes
      *
      * @param data the data to append to the payload content
      */
     void write_nocopy(sl::io::span<const char> data) {
         if (response->is_body_allowed() && data.size() > 0) {
-            content_buffers.push_back(asio::buffer(data.data(), data.size()));
+            if (is_copy_preferred(data.size())) {
+                add_copy(data);
+            } else {
+                content_buffers.push_back(asio::buffer(data.data(), data.size()));
+                copied_end = nullptr;
+            }
             content_length += data.size();
         }
     }
 
+    /**
+     * Write payload content; the data written is not copied,
+     * the writer keeps a reference to it until the data is sent;
+     * data not larger than `MAX_COALESCED_SIZE` is copied after
+     * `MAX_CONTENT_BUFFERS` buffers
+     *
+     * @param data the data to append to the payload content
+     */
+    void write_shared(shared_buffer data) {
+        if (response->is_body_allowed() && data.size() > 0) {
+            content_length += data.size();
+            if (content_buffers.size() >= MAX_CONTENT_BUFFERS && data.size() <= MAX_COALESCED_SIZE) {
+                add_copy({data.data(), data.size()});
+            } else {
+                content_buffers.push_back(asio::buffer(data.data(), data.size()));
+                copied_end = nullptr;
+                shared_buffers.emplace_back(std::move(data));
+            }
+        }
+    }
+
     /**
      * Sends all data buffered as a single HTTP message (without chunking).
      * Following a call to this function, it is not thread safe to use your
@@ -174,12 +304,12 @@ public:
      * 
      * @param self-owning instance
      */
-    static void send(std::unique_ptr<http_response_writer> self) {
+    static void send(response_writer_ptr self) {
         auto self_ptr = self.get();
         auto self_shared = sl::support::make_shared_with_release_deleter(self.release());
         self_ptr->send_more_data(false,
             [self_shared](const std::error_code& ec, std::size_t bt) { 
-                auto self = sl::support::make_unique_from_shared_with_release_deleter(self_shared);
+                response_writer_ptr self = sl::support::make_unique_from_shared_with_release_deleter(self_shared);
                 if (nullptr != self.get()) {
                     handle_write(std::move(self), ec, bt); 
                 } else {
@@ -189,6 +319,25 @@ public:
             });
     }
 
+    /**
+     * Sends all data buffered followed by the part of the file as a single
+     * HTTP message (without chunking). On plain connections file data is sent
+     * with "sendfile(2)" (on Linux), otherwise it is read by the disk IO threads
+     * into two buffers, so the next block is read while the previous one
+     * is being sent. The writer takes the ownership of the file descriptor
+     * and closes it after the response is sent. If the file turns out to be
+     * shorter than specified, the connection is closed.
+     * Following a call to this function, it is not thread safe to use your
+     * reference to the writer object.
+     * 
+     * @param self self-owning instance
+     * @param fd file descriptor opened for reading
+     * @param offset offset of the first byte to send
+     * @param length number of bytes to send
+     * @throws pion_exception if the chunked response was already started
+     */
+    static void send_file(response_writer_ptr self, int fd, uint64_t offset, uint64_t length);
+
     /**
      * Sends all data buffered as a single HTTP chunk.  Following a call to this
      * function, it is not thread safe to use your reference to the writer
@@ -224,13 +373,13 @@ public:
      * 
      * @param self-owning instance
      */ 
-    static void send_final_chunk(std::unique_ptr<http_response_writer> self) {
+    static void send_final_chunk(response_writer_ptr self) {
         self->sending_chunks = true;
         auto self_ptr = self.get();
         auto self_shared = sl::support::make_shared_with_release_deleter(self.release());
         self_ptr->send_more_data(true,
             [self_shared](const std::error_code& ec, std::size_t bt) { 
-                auto self = sl::support::make_unique_from_shared_with_release_deleter(self_shared);
+                response_writer_ptr self = sl::support::make_unique_from_shared_with_release_deleter(self_shared);
                 if (nullptr != self.get()) {
                     handle_write(std::move(self), ec, bt); 
                 } else {
@@ -288,7 +437,7 @@ public:
 private:
 
     /**
-     * Initializes a vector of write buffers with the HTTP message information
+     * Serializes the response head and adds it to the write buffers
      *
      * @param write_buffers vector of write buffers to initialize
      */
@@ -296,8 +445,9 @@ private:
         if (get_content_length() > 0) {
             response->set_content_length(get_content_length());
         }
-        response->prepare_buffers_for_send(write_buffers, get_connection()->get_keep_alive(),
-                sending_chunked_message());
+        head.clear();
+        response->serialize_head(head, get_connection()->get_keep_alive(), sending_chunked_message());
+        write_buffers.push_back(asio::buffer(head));
     }
 
     /**
@@ -307,7 +457,7 @@ private:
      * @param write_error error status from the last write operation
      * @param bytes_written number of bytes sent by the last write operation
      */
-    static void handle_write(std::unique_ptr<http_response_writer> self,
+    static void handle_write(response_writer_ptr self,
             const std::error_code& ec, std::size_t bytes_written) {
         (void) bytes_written;
         if (!ec) {
@@ -321,7 +471,11 @@ private:
                         << (self->get_connection()->get_keep_alive() ? "keeping alive)" : "closing)"));
             }
         }
-        self->tcp_conn->finish();
+        // writer is returned to the cache before finishing, so it can be
+        // reused by the next request over this connection
+        auto conn = self->tcp_conn;
+        self.reset();
+        conn->finish();
     }
 
     /**
@@ -368,65 +522,82 @@ private:
         // and content separately, which would not be as efficient
 
         // don't send anything if there is no data in content buffers
+        bool chunked = supports_chunked_messages() && sending_chunked_message();
         if (content_length > 0) {
-            if (supports_chunked_messages() && sending_chunked_message()) {
-                // prepare the next chunk of data to send
-                // write chunk length in hex
-                auto cast_buf = std::array<char, 35>();
-                #ifdef _WIN32
-                auto written = sprintf_s(cast_buf.data(), cast_buf.size(), "%lx", static_cast<long>(content_length));
-                #else // !WIN32
-                auto written = sprintf(cast_buf.data(), "%lx", static_cast<long>(content_length));
-                #endif // WIN32
-
-                // add chunk length as a string at the back of the text cache
-                // append length of chunk to write_buffers
-                write_buffers.push_back(add_to_cache({cast_buf.data(), written}));
-                // append an extra CRLF for chunk formatting
-                write_buffers.push_back(asio::buffer(http_message::STRING_CRLF));
-
+            if (chunked) {
+                // chunk length in hex followed by CRLF
+                write_buffers.push_back(make_chunk_size_line(content_length));
                 // append response content buffers
                 write_buffers.insert(write_buffers.end(), content_buffers.begin(),
                                      content_buffers.end());
-                // append an extra CRLF for chunk formatting
-                write_buffers.push_back(asio::buffer(http_message::STRING_CRLF));
+                if (send_final_chunk) {
+                    // CRLF to end this chunk and the zero-byte (final) chunk
+                    write_buffers.push_back(asio::buffer("\r\n0\r\n\r\n", 7));
+                } else {
+                    // append an extra CRLF for chunk formatting
+                    write_buffers.push_back(asio::buffer(http_message::STRING_CRLF));
+                }
             } else {
                 // append response content buffers
                 write_buffers.insert(write_buffers.end(), content_buffers.begin(),
                                      content_buffers.end());
             }
+        } else if (send_final_chunk && chunked) {
+            // prepare a zero-byte (final) chunk
+            write_buffers.push_back(asio::buffer("0\r\n\r\n", 5));
         }
+    }
 
-        // prepare a zero-byte (final) chunk
-        if (send_final_chunk && supports_chunked_messages() && sending_chunked_message()) {
-            // add chunk length as a string at the back of the text cache
-            char zero = '0';
-            // append length of chunk to write_buffers
-            write_buffers.push_back(add_to_cache({std::addressof(zero), 1}));
-            // append an extra CRLF for chunk formatting
-            write_buffers.push_back(asio::buffer(http_message::STRING_CRLF));
-            write_buffers.push_back(asio::buffer(http_message::STRING_CRLF));
-        }
+    /**
+     * Checks whether the data passed to `write_nocopy()` should be copied
+     *
+     * @param size data size
+     * @return true if data should be copied into the arena
+     */
+    bool is_copy_preferred(std::size_t size) const {
+        return size < NOCOPY_MIN_SIZE ||
+                (content_buffers.size() >= MAX_CONTENT_BUFFERS && size <= MAX_COALESCED_SIZE);
     }
 
     /**
-     * Add data to cache
+     * Copies data into the arena and adds it to the content buffers,
+     * data that directly follows the previously copied data extends
+     * the last content buffer
      * 
      * @param data data span
-     * @return asio buffer pointing to copy of passed data
      */
-    asio::const_buffer add_to_cache(sl::io::span<const char> data) {
-        payload_cache.emplace_back(new char[data.size()]);
-        char* dest = payload_cache.back().get();
-        std::memcpy(dest, data.data(), data.size());
-        return asio::buffer(dest, data.size());
+    void add_copy(sl::io::span<const char> data) {
+        char* dest = arena.copy(data.data(), data.size());
+        if (dest == copied_end) {
+            auto& last = content_buffers.back();
+            last = asio::buffer(asio::buffer_cast<const char*>(last), asio::buffer_size(last) + data.size());
+        } else {
+            content_buffers.push_back(asio::buffer(dest, data.size()));
+        }
+        copied_end = dest + data.size();
     }
-};
 
-/**
- * Data type for a response_writer pointer
- */
-using response_writer_ptr = std::unique_ptr<http_response_writer>;
+    /**
+     * Formats the chunk length line in the arena
+     * 
+     * @param len chunk length
+     * @return buffer with the chunk length in hex followed by CRLF
+     */
+    asio::const_buffer make_chunk_size_line(std::size_t len) {
+        static const char digits[] = "0123456789abcdef";
+        char buf[sizeof(std::size_t) * 2 + 2];
+        std::size_t pos = sizeof(buf) - 2;
+        do {
+            buf[--pos] = digits[len & 0xf];
+            len >>= 4;
+        } while (len > 0);
+        buf[sizeof(buf) - 2] = '\r';
+        buf[sizeof(buf) - 1] = '\n';
+        // not merged with the content, so copied_end is not updated
+        char* dest = arena.copy(buf + pos, sizeof(buf) - pos);
+        return asio::buffer(dest, sizeof(buf) - pos);
+    }
+};
 
 } // namespace
 }
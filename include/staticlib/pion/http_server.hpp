@@ -27,6 +27,8 @@
 #include <cstdint>
 #include <vector>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <set>
 #include <unordered_map>
 #include <utility>
@@ -39,6 +41,8 @@
 #include "staticlib/pion/http_parser.hpp"
 #include "staticlib/pion/http_request.hpp"
 #include "staticlib/pion/http_response_writer.hpp"
+#include "staticlib/pion/radix_router.hpp"
+#include "staticlib/pion/route_policy.hpp"
 #include "staticlib/pion/tcp_connection.hpp"
 #include "staticlib/pion/tcp_server.hpp"
 #include "staticlib/pion/websocket.hpp"
@@ -66,14 +70,29 @@ public:
     using payload_handler_creator_type = std::function<http_parser::payload_handler_type(http_request_ptr&)>;
 
     /**
-     * Data type for a map of resources to request handlers
+     * Request handler together with the policy applied to the requests it handles
      */
-    using handlers_map_type = std::unordered_map<std::string, request_handler_type>;
+    struct handler_route {
+        /**
+         * Function used to handle requests
+         */
+        request_handler_type handler;
+
+        /**
+         * Policy applied to the requests
+         */
+        route_policy policy;
+    };
 
     /**
-     * Data type for a map of resources to request handlers
+     * Data type for a router of resources to request handlers
      */
-    using payloads_map_type = std::unordered_map<std::string, payload_handler_creator_type>; 
+    using handlers_router_type = radix_router<handler_route>;
+
+    /**
+     * Data type for a router of resources to payload handlers creators
+     */
+    using payloads_router_type = radix_router<payload_handler_creator_type>;
 
     /**
      * Data type for a map of resources to WebSocket handlers
@@ -89,31 +108,6 @@ private:
      */
     uint32_t read_timeout;
     
-    /**
-     * Collection of GET handlers that are recognized by this HTTP server
-     */
-    handlers_map_type get_handlers;
-
-    /**
-     * Collection of POST handlers that are recognized by this HTTP server
-     */
-    handlers_map_type post_handlers;
-
-    /**
-     * Collection of PUT handlers that are recognized by this HTTP server
-     */
-    handlers_map_type put_handlers;
-
-    /**
-     * Collection of DELETE handlers that are recognized by this HTTP server
-     */    
-    handlers_map_type delete_handlers;
-
-    /**
-     * Collection of OPTIONS handlers that are recognized by this HTTP server
-     */
-    handlers_map_type options_handlers;
-
     /**
      * Points to a function that handles bad HTTP requests
      */
@@ -125,47 +119,112 @@ private:
     request_handler_type not_found_handler;
 
     /**
-     * Collection of payload handlers GET resources that are recognized by this HTTP server
+     * Immutable set of routes used to dispatch requests, new table is created
+     * and published on every routes change
      */
-    // GET payload won't happen, but lets be consistent here
-    // to simplify clients implementation and to make sure that
-    // pion's form-data parsing won't be triggered
-    payloads_map_type get_payloads;
+    struct route_table {
+        /**
+         * Collection of GET handlers that are recognized by this HTTP server
+         */
+        handlers_router_type get_handlers;
+
+        /**
+         * Collection of POST handlers that are recognized by this HTTP server
+         */
+        handlers_router_type post_handlers;
+
+        /**
+         * Collection of PUT handlers that are recognized by this HTTP server
+         */
+        handlers_router_type put_handlers;
+
+        /**
+         * Collection of DELETE handlers that are recognized by this HTTP server
+         */    
+        handlers_router_type delete_handlers;
+
+        /**
+         * Collection of OPTIONS handlers that are recognized by this HTTP server
+         */
+        handlers_router_type options_handlers;
+
+        /**
+         * Collection of payload handlers GET resources that are recognized by this HTTP server
+         */
+        // GET payload won't happen, but lets be consistent here
+        // to simplify clients implementation and to make sure that
+        // pion's form-data parsing won't be triggered
+        payloads_router_type get_payloads;
+
+        /**
+         * Collection of payload handlers POST resources that are recognized by this HTTP server
+         */
+        payloads_router_type post_payloads;
+
+        /**
+         * Collection of payload handlers PUT resources that are recognized by this HTTP server
+         */
+        payloads_router_type put_payloads;
+
+        /**
+         * Collection of payload handlers DELETE resources that are recognized by this HTTP server
+         */
+        payloads_router_type delete_payloads;
+
+        /**
+         * Collection of payload handlers OPTIONS resources that are recognized by this HTTP server
+         */
+        payloads_router_type options_payloads;
+
+        /**
+         * Collection of WebSocket WSOPEN resources that are recognized by this HTTP server
+         */
+        websocket_map_type wsopen_handlers;
+
+        /**
+         * Collection of WebSocket WSMESSAGE resources that are recognized by this HTTP server
+         */
+        websocket_map_type wsmessage_handlers;
+
+        /**
+         * Collection of WebSocket WSCLOSE resources that are recognized by this HTTP server
+         */
+        websocket_map_type wsclose_handlers;
+    };
 
     /**
-     * Collection of payload handlers POST resources that are recognized by this HTTP server
+     * Data type for a map of routes definitions, keyed by method (or WebSocket event) and resource
      */
-    payloads_map_type post_payloads;
+    template<typename T>
+    using route_definitions_type = std::map<std::pair<std::string, std::string>, T>;
 
     /**
-     * Collection of payload handlers PUT resources that are recognized by this HTTP server
+     * Current routes, accessed only with atomic operations; atomic shared_ptr
+     * functions are not lock-free in C++11 standard libraries (libstdc++ guards
+     * them with a pool of mutexes held only while the pointer is copied),
+     * so the snapshot is taken once per request
      */
-    payloads_map_type put_payloads;
+    std::shared_ptr<const route_table> routes;
 
     /**
-     * Collection of payload handlers DELETE resources that are recognized by this HTTP server
+     * Definitions of request handlers, used to build the route table
      */
-    payloads_map_type delete_payloads;
+    route_definitions_type<handler_route> handler_definitions;
 
     /**
-     * Collection of payload handlers OPTIONS resources that are recognized by this HTTP server
+     * Definitions of payload handlers, used to build the route table
      */
-    payloads_map_type options_payloads;
+    route_definitions_type<payload_handler_creator_type> payload_definitions;
 
     /**
-     * Collection of WebSocket WSOPEN resources that are recognized by this HTTP server
+     * Definitions of WebSocket handlers, used to build the route table
      */
-    websocket_map_type wsopen_handlers;
+    route_definitions_type<websocket_handler_type> websocket_definitions;
 
     /**
-     * Collection of WebSocket WSMESSAGE resources that are recognized by this HTTP server
+     * Serializes routes changes
      */
-    websocket_map_type wsmessage_handlers;
-
-    /**
-     * Collection of WebSocket WSCLOSE resources that are recognized by this HTTP server
-     */
-    websocket_map_type wsclose_handlers;
+    std::mutex routes_mtx;
 
     websocket_conn_registry_type websocket_conn_registry;
 
@@ -174,6 +233,7 @@ private:
 public:
     ~http_server() STATICLIB_NOEXCEPT { }
 
+#ifndef STATICLIB_PION_DISABLE_SSL
     /**
      * Creates a new server object
      * 
@@ -198,16 +258,35 @@ public:
             const std::string& ssl_verify_file = std::string(),
             std::function<bool(bool, asio::ssl::verify_context&)> ssl_verify_callback = 
                     [](bool, asio::ssl::verify_context&) { return true; });
+#else // STATICLIB_PION_DISABLE_SSL
+    /**
+     * Creates a new server object, library is built without SSL support
+     * 
+     * @param number_of_threads number of threads to use for requests processing
+     * @param port TCP port
+     * @param read_timeout_millis timeout for read operations
+     * @param ip_address (optional) IPv4-address to use, ANY address by default
+     */
+    http_server(uint32_t number_of_threads, uint16_t port,
+            asio::ip::address_v4 ip_address = asio::ip::address_v4::any(),
+            uint32_t read_timeout_millis = 10000);
+#endif // STATICLIB_PION_DISABLE_SSL
 
     /**
-     * Adds a new web service to the HTTP server
+     * Adds a new web service to the HTTP server, routes can be changed
+     * while the server is running, requests that are already dispatched
+     * are not affected
      *
      * @param method HTTP method name
-     * @param resource the resource name or uri-stem to bind to the handler
+     * @param resource the resource name or uri-stem to bind to the handler, may contain
+     *        `{name}` segments and a trailing `*name` segment, captured values are
+     *        available with `http_request::get_path_param()`
      * @param request_handler function used to handle requests to the resource
+     * @param policy (optional) timeouts, body limit and executor used for the requests
+     *        to the resource, payload handlers of the resource are subject to this policy too
      */
     void add_handler(const std::string& method, const std::string& resource,
-            request_handler_type request_handler);
+            request_handler_type request_handler, route_policy policy = route_policy());
 
     /**
      * Sets the function that handles bad HTTP requests
@@ -231,7 +310,8 @@ public:
      * Adds a new payload_handler to the HTTP server
      *
      * @param method HTTP method name
-     * @param resource the resource name or uri-stem to bind to the handler
+     * @param resource the resource name or uri-stem to bind to the handler, may contain
+     *        `{name}` segments and a trailing `*name` segment
      * @param payload_handler function used to handle payload for the request
      */
     void add_payload_handler(const std::string& method, const std::string& resource, 
@@ -247,6 +327,33 @@ public:
     void add_websocket_handler(const std::string& event, const std::string& resource, 
             websocket_handler_type handler);
 
+    /**
+     * Removes the web service from the HTTP server
+     *
+     * @param method HTTP method name
+     * @param resource the resource name or uri-stem the handler is bound to
+     * @return true if handler was removed, false if it was not found
+     */
+    bool remove_handler(const std::string& method, const std::string& resource);
+
+    /**
+     * Removes the payload_handler from the HTTP server
+     *
+     * @param method HTTP method name
+     * @param resource the resource name or uri-stem the handler is bound to
+     * @return true if handler was removed, false if it was not found
+     */
+    bool remove_payload_handler(const std::string& method, const std::string& resource);
+
+    /**
+     * Removes the handler for WebSocket events
+     *
+     * @param event WebSocket event name
+     * @param resource the resource name or uri-stem the handler is bound to
+     * @return true if handler was removed, false if it was not found
+     */
+    bool remove_websocket_handler(const std::string& event, const std::string& resource);
+
     /**
      * Broadcasts specified message to the WebSocket clients currently
      * connected on the specified path
@@ -261,6 +368,23 @@ public:
             sl::websocket::frame_type frame_type = sl::websocket::frame_type::text,
             const std::set<std::string>& dest_ids = std::set<std::string>());
 private:
+    /**
+     * Builds a new route table from the current definitions and publishes it,
+     * must be called with routes mutex held
+     *
+     * @throws pion_exception if definitions contain an invalid route
+     */
+    void publish_routes();
+
+    /**
+     * Returns the current route table
+     *
+     * @return route table snapshot
+     */
+    std::shared_ptr<const route_table> get_routes() const {
+        return std::atomic_load(std::addressof(routes));
+    }
+
     /**
      * Handles a new TCP connection
      * 
@@ -269,15 +393,17 @@ private:
     virtual void handle_connection(tcp_connection_ptr& conn) override;
     
     /**
-     * Handles a new HTTP request
+     * Handles a new HTTP request after its headers are parsed, applies the
+     * policy of the matching route and creates the payload handler
      *
+     * @param reader reader of the request
      * @param request the HTTP request to handle
      * @param conn TCP connection containing a new request
      * @param ec error_code contains additional information for parsing errors
      * @param rc parsing result code, false: abort, true: ignore_body, indeterminate: continue
      */
-    void handle_request_after_headers_parsed(http_request_ptr& request,
-            tcp_connection_ptr& conn, const std::error_code& ec, sl::support::tribool& rc);
+    void handle_request_after_headers_parsed(http_request_reader& reader, http_request_ptr& request,
+            tcp_connection_ptr& conn, std::error_code& ec, sl::support::tribool& rc);
 
     /**
      * Handles a new HTTP request
@@ -285,9 +411,11 @@ private:
      * @param request the HTTP request to handle
      * @param conn TCP connection containing a new request
      * @param ec error_code contains additional information for parsing errors
+     * @param routes route table snapshot taken when the headers were parsed,
+     *        may be empty if the headers were not parsed
      */
-    void handle_request(http_request_ptr request,
-            tcp_connection_ptr& conn, const std::error_code& ec);
+    void handle_request(http_request_ptr request, tcp_connection_ptr& conn,
+            const std::error_code& ec, std::shared_ptr<const void> routes);
 
 
 };
@@ -0,0 +1,232 @@
+/*
+ * Copyright 2026, alex at staticlibs.net
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   multipart_parser.hpp
+ * Author: alex
+ *
+ * Created on October 17, 2026, 8:15 PM
+ */
+
+#ifndef STATICLIB_PION_MULTIPART_PARSER_HPP
+#define STATICLIB_PION_MULTIPART_PARSER_HPP
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+
+#include "staticlib/config.hpp"
+#include "staticlib/io.hpp"
+
+#include "staticlib/pion/algorithm.hpp"
+
+namespace staticlib {
+namespace pion {
+
+/**
+ * Incremental parser for "multipart/form-data" payload content, can be used
+ * as a payload handler; content is accepted in arbitrary pieces, headers of each
+ * part are passed to the part handler, data of each part is streamed to the sink
+ * returned by the part handler, sink is destroyed when the part is finished
+ */
+class multipart_parser {
+public:
+    /**
+     * Type alias for part headers map
+     */
+    using headers_type = std::unordered_multimap<std::string, std::string, algorithm::ihash, algorithm::iequal_to>;
+
+    /**
+     * Callback type used to consume part data
+     */
+    using part_sink_type = std::function<void(const char*, std::size_t)>;
+
+    /**
+     * Callback type called with the headers of each part, returns the sink
+     * for the part data, empty sink can be returned to skip the part data
+     */
+    using part_handler_type = std::function<part_sink_type(const headers_type&)>;
+
+    /**
+     * Maximum length of all headers of a single part
+     */
+    static const std::size_t HEADERS_MAX;
+
+private:
+    /**
+     * Parsing states
+     */
+    enum class parse_state {
+        preamble, boundary_tail, boundary_close, boundary_lf, headers, data, epilogue
+    };
+
+    /**
+     * Parsing state
+     */
+    parse_state state;
+
+    /**
+     * Delimiter preceding each part: CRLF, two dashes and boundary
+     */
+    std::string delimiter;
+
+    /**
+     * Boyer-Moore-Horspool shift table for the delimiter
+     */
+    std::array<uint8_t, 256> shifts;
+
+    /**
+     * Tail bytes of the previous piece, that may be the start of the delimiter
+     */
+    std::string carry;
+
+    /**
+     * Headers line being parsed
+     */
+    std::string header_line;
+
+    /**
+     * Length of headers of the current part parsed so far
+     */
+    std::size_t headers_length;
+
+    /**
+     * Headers of the current part
+     */
+    headers_type part_headers;
+
+    /**
+     * Handler called for each part
+     */
+    part_handler_type part_handler;
+
+    /**
+     * Sink of the current part
+     */
+    part_sink_type part_sink;
+
+public:
+    /**
+     * Constructor
+     *
+     * @param content_type value of the "Content-Type" header with the "boundary" parameter
+     * @param handler handler called with the headers of each part
+     * @throws pion_exception if boundary is missing or invalid
+     */
+    multipart_parser(const std::string& content_type, part_handler_type handler);
+
+    /**
+     * Parses the next piece of the payload content, can be used as a payload handler
+     *
+     * @param data piece data
+     * @param len piece length
+     * @throws pion_exception on malformed content
+     */
+    void operator()(const char* data, std::size_t len);
+
+    /**
+     * Returns true if the closing delimiter was received
+     *
+     * @return true if all parts were parsed
+     */
+    bool is_finished() const;
+
+    /**
+     * Extracts the "boundary" parameter from the "Content-Type" header value
+     *
+     * @param content_type header value
+     * @return boundary, empty string if not found
+     */
+    static std::string extract_boundary(const std::string& content_type);
+
+    /**
+     * Returns the parameter of the "Content-Disposition" part header,
+     * for example "name" or "filename"
+     *
+     * @param headers part headers
+     * @param param parameter name
+     * @return parameter value, empty string if not found
+     */
+    static std::string get_disposition_param(const headers_type& headers, const std::string& param);
+
+private:
+    /**
+     * Consumes preamble or part data up to the next delimiter,
+     * delimiter is consumed too
+     *
+     * @param data piece data, advanced past the consumed bytes
+     * @param len piece length, decreased by the number of consumed bytes
+     */
+    void parse_data(const char*& data, std::size_t& len);
+
+    /**
+     * Consumes part headers up to the end of the current header line
+     *
+     * @param data piece data, advanced past the consumed bytes
+     * @param len piece length, decreased by the number of consumed bytes
+     * @throws pion_exception on malformed or too long headers
+     */
+    void parse_headers(const char*& data, std::size_t& len);
+
+    /**
+     * Calls the part handler with the parsed headers and switches to the part data
+     */
+    void finish_headers();
+
+    /**
+     * Passes the data to the current part sink, data in preamble is discarded
+     *
+     * @param data part data
+     * @param len data length
+     */
+    void emit_data(const char* data, std::size_t len);
+
+    /**
+     * Searches the delimiter in the specified data
+     *
+     * @param data data to search in
+     * @param len data length
+     * @return offset of the delimiter, len if not found
+     */
+    std::size_t find_delimiter(const char* data, std::size_t len) const;
+
+};
+
+/**
+ * Wraps the `sl::io` sink into the part sink callback, sink is destroyed
+ * with the callback when the part is finished
+ *
+ * @param sink `sl::io` sink
+ * @return part sink callback
+ */
+template<typename Sink>
+multipart_parser::part_sink_type make_part_sink(Sink&& sink) {
+    using sink_type = typename std::decay<Sink>::type;
+    auto sink_ptr = std::make_shared<sink_type>(std::forward<Sink>(sink));
+    return [sink_ptr](const char* data, std::size_t len) {
+        sl::io::write_all(*sink_ptr, {data, len});
+    };
+}
+
+} // namespace
+}
+
+#endif /* STATICLIB_PION_MULTIPART_PARSER_HPP */
+
@@ -0,0 +1,428 @@
+/*
+ * Copyright 2026, alex at staticlibs.net
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   radix_router.hpp
+ * Author: alex
+ *
+ * Created on October 17, 2026, 10:40 PM
+ */
+
+#ifndef STATICLIB_PION_RADIX_ROUTER_HPP
+#define STATICLIB_PION_RADIX_ROUTER_HPP
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "staticlib/config.hpp"
+
+#include "staticlib/pion/pion_exception.hpp"
+
+namespace staticlib {
+namespace pion {
+
+/**
+ * Data type for a list of path parameters captured by the router, names
+ * are listed in the order they appear in the route
+ */
+using path_params_type = std::vector<std::pair<std::string, std::string>>;
+
+/**
+ * Compressed radix tree that maps URL paths to values.
+ *
+ * Route is a path that may contain parameter segments in the form `{name}`,
+ * that match a single non-empty path segment, and a wildcard segment
+ * in the form `*` or `*name` as the last segment, that matches the rest
+ * of the path. Static segments are preferred over parameters and parameters
+ * are preferred over wildcards.
+ *
+ * When no route matches the whole path, the longest route that matches
+ * the path up to one of its slashes is used, so the route `/foo` handles
+ * the path `/foo/bar` unless `/foo/bar` (or `/foo/{name}`) is registered.
+ *
+ * Lookup does not allocate memory (except for the captured parameter values
+ * that do not fit into the strings of the passed parameters list), router
+ * must not be modified while lookups are in progress.
+ */
+template<typename T>
+class radix_router {
+    /**
+     * Tree node, node matches its label (or a path segment for parameters,
+     * or the rest of the path for wildcards) and then continues with children
+     */
+    struct node {
+        /**
+         * Static text matched by this node, empty for parameter and wildcard nodes
+         */
+        std::string label;
+
+        /**
+         * Parameter name for parameter and wildcard nodes
+         */
+        std::string param_name;
+
+        /**
+         * First bytes of the labels of static children, in the same order as children
+         */
+        std::string indices;
+
+        /**
+         * Static children, labels of children start with different bytes
+         */
+        std::vector<std::unique_ptr<node>> children;
+
+        /**
+         * Parameter child, may be null
+         */
+        std::unique_ptr<node> param_child;
+
+        /**
+         * Wildcard child, may be null
+         */
+        std::unique_ptr<node> wildcard_child;
+
+        /**
+         * Whether the route ends at this node
+         */
+        bool has_value;
+
+        /**
+         * Value of the route that ends at this node
+         */
+        T value;
+
+        /**
+         * Constructor
+         *
+         * @param label static text matched by this node
+         */
+        explicit node(std::string label) :
+        label(std::move(label)),
+        has_value(false) { }
+    };
+
+    /**
+     * Root node, matches an empty path
+     */
+    std::unique_ptr<node> root;
+
+    /**
+     * Number of routes added
+     */
+    std::size_t routes_count;
+
+public:
+    /**
+     * Constructor, creates an empty router
+     */
+    radix_router() :
+    root(new node(std::string())),
+    routes_count(0) { }
+
+    /**
+     * Deleted copy constructor
+     */
+    radix_router(const radix_router&) = delete;
+
+    /**
+     * Deleted copy assignment operator
+     */
+    radix_router& operator=(const radix_router&) = delete;
+
+    /**
+     * Move constructor
+     *
+     * @param other other instance
+     */
+    radix_router(radix_router&& other) :
+    root(std::move(other.root)),
+    routes_count(other.routes_count) {
+        other.root.reset(new node(std::string()));
+        other.routes_count = 0;
+    }
+
+    /**
+     * Move assignment operator
+     *
+     * @param other other instance
+     * @return this instance
+     */
+    radix_router& operator=(radix_router&& other) {
+        root = std::move(other.root);
+        routes_count = other.routes_count;
+        other.root.reset(new node(std::string()));
+        other.routes_count = 0;
+        return *this;
+    }
+
+    /**
+     * Adds a route
+     *
+     * @param route route path, may contain `{name}` and `*name` segments
+     * @param value value to return for the paths matched by this route
+     * @throws pion_exception if route is invalid, if it is already added,
+     *         or if it uses a different name for a parameter, that is already
+     *         defined at the same position by other route
+     */
+    void add(const std::string& route, T value) {
+        node* nd = root.get();
+        std::size_t pos = 0;
+        while (pos < route.length()) {
+            bool at_segment_start = (0 == pos) || ('/' == route[pos - 1]);
+            char ch = route[pos];
+            if ('{' == ch || '*' == ch) {
+                if (!at_segment_start) {
+                    throw pion_exception("Invalid route: [" + route + "]," +
+                            " parameter must occupy the whole segment");
+                }
+                std::size_t seg_end = route.find('/', pos);
+                if (std::string::npos == seg_end) {
+                    seg_end = route.length();
+                }
+                if ('*' == ch) {
+                    if (seg_end != route.length()) {
+                        throw pion_exception("Invalid route: [" + route + "]," +
+                                " wildcard must be the last segment");
+                    }
+                    nd = add_special(nd->wildcard_child, route.substr(pos + 1, seg_end - pos - 1), route);
+                } else {
+                    if ('}' != route[seg_end - 1] || seg_end - pos < 3) {
+                        throw pion_exception("Invalid route: [" + route + "]," +
+                                " parameter must have a form '{name}'");
+                    }
+                    nd = add_special(nd->param_child, route.substr(pos + 1, seg_end - pos - 2), route);
+                }
+                pos = seg_end;
+            } else {
+                std::size_t end = route.find_first_of("{*", pos);
+                if (std::string::npos == end) {
+                    end = route.length();
+                }
+                nd = add_static(nd, route.data() + pos, end - pos);
+                pos = end;
+            }
+        }
+        if (nd->has_value) {
+            throw pion_exception("Invalid duplicate route: [" + route + "]");
+        }
+        nd->has_value = true;
+        nd->value = std::move(value);
+        routes_count += 1;
+    }
+
+    /**
+     * Finds the value of the route matching the specified path
+     *
+     * @param path path data, trailing slash (if any) should be stripped
+     * @param len path length
+     * @param params list to store the captured parameters values into, parameter
+     *        values are stored as they appear in the path (without URL decoding);
+     *        existing elements are overwritten and the list is resized to the
+     *        number of captured parameters
+     * @return pointer to value, null if no route matches the path
+     */
+    const T* find(const char* path, std::size_t len, path_params_type& params) const {
+        if (0 == routes_count) {
+            params.clear();
+            return nullptr;
+        }
+        std::size_t end = len;
+        for (;;) {
+            std::size_t count = 0;
+            const node* nd = match(*root, path, end, 0, params, count);
+            if (nullptr != nd) {
+                params.resize(count);
+                return std::addressof(nd->value);
+            }
+            // fall back to the shorter prefix, that ends before the last slash
+            if (0 == end) {
+                break;
+            }
+            const char* slash = find_last_slash(path, end);
+            if (nullptr == slash) {
+                break;
+            }
+            end = static_cast<std::size_t>(slash - path);
+        }
+        params.clear();
+        return nullptr;
+    }
+
+    /**
+     * Returns the number of routes added
+     *
+     * @return number of routes
+     */
+    std::size_t size() const {
+        return routes_count;
+    }
+
+private:
+    /**
+     * Adds static text to the tree, splitting the existing nodes as needed
+     *
+     * @param nd node to start from
+     * @param text static text
+     * @param len text length
+     * @return node that matches the end of the text
+     */
+    static node* add_static(node* nd, const char* text, std::size_t len) {
+        while (len > 0) {
+            std::size_t idx = nd->indices.find(text[0]);
+            if (std::string::npos == idx) {
+                nd->indices.push_back(text[0]);
+                nd->children.emplace_back(new node(std::string(text, len)));
+                return nd->children.back().get();
+            }
+            node* child = nd->children[idx].get();
+            std::size_t common = 0;
+            std::size_t max = (std::min)(len, child->label.length());
+            while (common < max && text[common] == child->label[common]) {
+                common += 1;
+            }
+            if (common < child->label.length()) {
+                // split the child, its label prefix is moved to the new intermediate node
+                std::unique_ptr<node> mid{new node(child->label.substr(0, common))};
+                child->label.erase(0, common);
+                mid->indices.push_back(child->label[0]);
+                mid->children.emplace_back(std::move(nd->children[idx]));
+                nd->children[idx] = std::move(mid);
+                child = nd->children[idx].get();
+            }
+            nd = child;
+            text += common;
+            len -= common;
+        }
+        return nd;
+    }
+
+    /**
+     * Adds parameter or wildcard node to the tree
+     *
+     * @param slot parameter or wildcard child of the parent node
+     * @param name parameter name
+     * @param route route path used for error reporting
+     * @return parameter or wildcard node
+     */
+    static node* add_special(std::unique_ptr<node>& slot, std::string name, const std::string& route) {
+        if (nullptr == slot.get()) {
+            slot.reset(new node(std::string()));
+            slot->param_name = std::move(name);
+        } else if (slot->param_name != name) {
+            throw pion_exception("Invalid route: [" + route + "], parameter name: [" + name + "]" +
+                    " conflicts with the name: [" + slot->param_name + "] used by other route");
+        }
+        return slot.get();
+    }
+
+    /**
+     * Matches the rest of the path against the children of the specified node
+     *
+     * @param nd node, its own label is already matched
+     * @param path path data
+     * @param len path length
+     * @param pos position of the rest of the path
+     * @param params list of parameters values
+     * @param count number of captured parameters
+     * @return node that matches the whole path, null if not found
+     */
+    static const node* match(const node& nd, const char* path, std::size_t len, std::size_t pos,
+            path_params_type& params, std::size_t& count) {
+        if (pos == len && nd.has_value) {
+            return std::addressof(nd);
+        }
+        if (pos < len) {
+            const char* found = static_cast<const char*>(
+                    std::memchr(nd.indices.data(), path[pos], nd.indices.length()));
+            if (nullptr != found) {
+                const node& child = *nd.children[static_cast<std::size_t>(found - nd.indices.data())];
+                const std::string& label = child.label;
+                if (len - pos >= label.length() &&
+                        0 == std::memcmp(path + pos, label.data(), label.length())) {
+                    const node* res = match(child, path, len, pos + label.length(), params, count);
+                    if (nullptr != res) {
+                        return res;
+                    }
+                }
+            }
+            if (nullptr != nd.param_child.get()) {
+                const char* slash = static_cast<const char*>(std::memchr(path + pos, '/', len - pos));
+                std::size_t end = nullptr != slash ? static_cast<std::size_t>(slash - path) : len;
+                if (end > pos) {
+                    std::size_t saved = count;
+                    capture(params, count, nd.param_child->param_name, path + pos, end - pos);
+                    const node* res = match(*nd.param_child, path, len, end, params, count);
+                    if (nullptr != res) {
+                        return res;
+                    }
+                    count = saved;
+                }
+            }
+        }
+        if (nullptr != nd.wildcard_child.get() && nd.wildcard_child->has_value) {
+            capture(params, count, nd.wildcard_child->param_name, path + pos, len - pos);
+            return nd.wildcard_child.get();
+        }
+        return nullptr;
+    }
+
+    /**
+     * Stores the captured parameter value, reusing existing list elements
+     *
+     * @param params list of parameters values
+     * @param count number of captured parameters, incremented
+     * @param name parameter name
+     * @param value parameter value
+     * @param len value length
+     */
+    static void capture(path_params_type& params, std::size_t& count, const std::string& name,
+            const char* value, std::size_t len) {
+        if (count < params.size()) {
+            auto& pa = params[count];
+            pa.first.assign(name);
+            pa.second.assign(value, len);
+        } else {
+            params.emplace_back(name, std::string(value, len));
+        }
+        count += 1;
+    }
+
+    /**
+     * Finds the last slash in the specified path
+     *
+     * @param path path data
+     * @param len path length
+     * @return pointer to the last slash, null if not found
+     */
+    static const char* find_last_slash(const char* path, std::size_t len) {
+        for (std::size_t i = len; i > 0; i--) {
+            if ('/' == path[i - 1]) {
+                return path + i - 1;
+            }
+        }
+        return nullptr;
+    }
+};
+
+} // namespace
+}
+
+#endif /* STATICLIB_PION_RADIX_ROUTER_HPP */
+
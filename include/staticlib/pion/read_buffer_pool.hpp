@@ -0,0 +1,123 @@
+/*
+ * Copyright 2026, alex at staticlibs.net
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   read_buffer_pool.hpp
+ * Author: alex
+ *
+ * Created on October 17, 2026, 10:05 AM
+ */
+
+#ifndef STATICLIB_PION_READ_BUFFER_POOL_HPP
+#define STATICLIB_PION_READ_BUFFER_POOL_HPP
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "staticlib/config.hpp"
+
+namespace staticlib {
+namespace pion {
+
+/**
+ * Pool of the buffers used for reading data from TCP connections, normally
+ * one pool is used per scheduler thread; connections borrow a buffer only
+ * while the data read from the socket is being consumed and return it
+ * before waiting for more data, so idle connections do not hold read buffers
+ */
+class read_buffer_pool {
+public:
+    /**
+     * Data type for an I/O read buffer
+     */
+    using buffer_type = std::array<char, 8192>;
+
+private:
+    /**
+     * Mutex to make pool thread-safe
+     */
+    std::mutex mutex;
+
+    /**
+     * Free buffers
+     */
+    std::vector<std::unique_ptr<buffer_type>> spare;
+
+    /**
+     * Max number of free buffers kept in the pool
+     */
+    std::atomic<uint32_t> spare_limit;
+
+public:
+    /**
+     * Constructor
+     *
+     * @param limit max number of free buffers kept in the pool
+     */
+    explicit read_buffer_pool(uint32_t limit);
+
+    /**
+     * Deleted copy constructor
+     */
+    read_buffer_pool(const read_buffer_pool&) = delete;
+
+    /**
+     * Deleted copy assignment operator
+     */
+    read_buffer_pool& operator=(const read_buffer_pool&) = delete;
+
+    /**
+     * Takes a free buffer from the pool or allocates a new one,
+     * buffer contents are not initialized
+     *
+     * @return buffer
+     */
+    std::unique_ptr<buffer_type> acquire();
+
+    /**
+     * Returns the buffer to the pool, buffer is destroyed
+     * if the pool already holds the max number of free buffers
+     *
+     * @param buf buffer
+     */
+    void release(std::unique_ptr<buffer_type> buf);
+
+    /**
+     * Sets the max number of free buffers kept in the pool,
+     * extra free buffers are destroyed
+     *
+     * @param limit max number of free buffers
+     */
+    void set_spare_limit(uint32_t limit);
+
+    /**
+     * Returns the number of free buffers in the pool
+     *
+     * @return number of free buffers
+     */
+    std::size_t spare_count();
+
+};
+
+} // namespace
+}
+
+#endif /* STATICLIB_PION_READ_BUFFER_POOL_HPP */
+
@@ -0,0 +1,91 @@
+/*
+ * Copyright 2026, alex at staticlibs.net
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   route_policy.hpp
+ * Author: alex
+ *
+ * Created on October 18, 2026, 12:10 AM
+ */
+
+#ifndef STATICLIB_PION_ROUTE_POLICY_HPP
+#define STATICLIB_PION_ROUTE_POLICY_HPP
+
+#include <cstdint>
+#include <functional>
+
+namespace staticlib {
+namespace pion {
+
+/**
+ * Settings applied to the requests matched by a route, settings are applied
+ * as soon as the request headers are parsed; zero values mean that
+ * the server-wide settings are used
+ */
+struct route_policy {
+    /**
+     * Type of function that runs the request handler, it is called on the IO thread
+     * and may run the passed task on some other thread
+     */
+    using executor_type = std::function<void(std::function<void()>)>;
+
+    /**
+     * Timeout for each read operation while receiving the request body
+     */
+    uint32_t read_timeout_millis;
+
+    /**
+     * Max time for receiving the whole request body, counted from the moment
+     * the request headers are parsed, zero means no deadline
+     */
+    uint32_t request_deadline_millis;
+
+    /**
+     * Max length of the request body, requests with longer "Content-Length"
+     * are rejected with "413 Payload Too Large" before the body is read
+     * (and without sending "100 Continue"), chunked bodies (including the ones
+     * passed to payload handlers) are rejected as soon as the declared chunk
+     * sizes exceed this length
+     */
+    uint64_t max_content_length;
+
+    /**
+     * Send "100 Continue" to the clients that expect it
+     */
+    bool send_continue;
+
+    /**
+     * Function that runs the request handler, the handler is run
+     * on the IO thread if empty
+     */
+    executor_type executor;
+
+    /**
+     * Constructor, sets default values
+     */
+    route_policy() :
+    read_timeout_millis(0),
+    request_deadline_millis(0),
+    max_content_length(0),
+    send_continue(true),
+    executor() { }
+};
+
+} // namespace
+}
+
+#endif /* STATICLIB_PION_ROUTE_POLICY_HPP */
+
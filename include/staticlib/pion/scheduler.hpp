@@ -26,6 +26,7 @@
 #ifndef STATICLIB_PION_SCHEDULER_HPP
 #define STATICLIB_PION_SCHEDULER_HPP
 
+#include <atomic>
 #include <cstdint>
 #include <chrono>
 #include <condition_variable>
@@ -43,9 +44,32 @@ namespace staticlib {
 namespace pion {
 
 /**
- * Scheduler, combines Boost.ASIO with a managed thread pool for scheduling server threads
+ * Scheduler, combines Boost.ASIO with a managed thread pool for scheduling server threads;
+ * all threads may share a single IO service (default) or each thread may run its own one
  */
 class scheduler {
+    /**
+     * IO service with the timer used to keep it running
+     */
+    struct service_pair {
+        /**
+         * Service used to manage async I/O events
+         */
+        asio::io_service service;
+
+        /**
+         * Timer used to periodically check for shutdown
+         */
+        asio::steady_timer timer;
+
+        /**
+         * Constructor
+         */
+        service_pair() :
+        service(),
+        timer(service) { }
+    };
+
     /**
      * Mutex to make class thread-safe
      */
@@ -82,14 +106,20 @@ class scheduler {
     std::vector<std::unique_ptr<std::thread>> thread_pool;
 
     /**
-     * Service used to manage async I/O events
+     * Pool of IO services, contains single service shared by all threads
+     * or one service for each thread
+     */
+    std::vector<std::unique_ptr<service_pair>> service_pool;
+
+    /**
+     * Index of the service to be returned by the next call to "next_io_service_index()"
      */
-    asio::io_service asio_service;
+    std::atomic<uint32_t> next_service;
 
     /**
-     * Timer used to periodically check for shutdown
+     * True if the worker thread N is pinned to the CPU N on startup
      */
-    asio::steady_timer timer;
+    bool pin_threads;
 
     /**
      * Hook function, that is called after each scheduled thread will exit
@@ -105,9 +135,11 @@ public:
     num_threads(number_of_threads),
     active_users(0),
     running(false),
-    asio_service(),
-    timer(asio_service),
-    thread_stop_hook([]() STATICLIB_NOEXCEPT {}) { }
+    next_service(0),
+    pin_threads(false),
+    thread_stop_hook([]() STATICLIB_NOEXCEPT {}) {
+        service_pool.emplace_back(new service_pair());
+    }
 
     /**
      * Deleted copy constructor
@@ -163,12 +195,70 @@ public:
     }
 
     /**
-     * Returns an async I/O service used to schedule work
+     * Returns the number of worker threads in the pool
+     * 
+     * @return number of worker threads
+     */
+    uint32_t get_num_threads() const {
+        return num_threads;
+    }
+
+    /**
+     * Switches scheduler between the single IO service shared by all threads
+     * and one IO service per thread, must be called before the scheduler is started
+     * 
+     * @param enabled whether each thread should run its own IO service
+     */
+    void set_io_service_per_thread(bool enabled);
+
+    /**
+     * Enables pinning of the worker thread N to the CPU N (modulo the number
+     * of CPUs, Linux only), must be called before the scheduler is started
+     * 
+     * @param enabled whether worker threads should be pinned to CPUs
+     */
+    void set_thread_affinity(bool enabled);
+
+    /**
+     * Returns the number of IO services used by this scheduler
+     * 
+     * @return number of IO services
+     */
+    uint32_t get_io_services_count() const {
+        return static_cast<uint32_t>(service_pool.size());
+    }
+
+    /**
+     * Returns an async I/O service used to schedule work, when running one
+     * service per thread, returns the service of the first thread
      * 
      * @return asio service
      */
     asio::io_service& get_io_service() {
-        return asio_service;
+        return service_pool.front()->service;
+    }
+
+    /**
+     * Returns an async I/O service with the specified index
+     * 
+     * @param index service index, taken modulo the number of services
+     * @return asio service
+     */
+    asio::io_service& get_io_service(uint32_t index) {
+        return service_pool[index % service_pool.size()]->service;
+    }
+
+    /**
+     * Returns the index of the IO service that should be used for the next
+     * unit of work, services are chosen in round-robin order
+     * 
+     * @return service index
+     */
+    uint32_t next_io_service_index() {
+        if (1 == service_pool.size()) {
+            return 0;
+        }
+        return next_service.fetch_add(1, std::memory_order_relaxed) % service_pool.size();
     }
 
     /**
@@ -177,7 +267,7 @@ public:
      * @param work_func work function to be executed
      */
     void post(std::function<void()> work_func) {
-        get_io_service().post(work_func);
+        get_io_service(next_io_service_index()).post(work_func);
     }
 
     /**
@@ -208,6 +298,16 @@ public:
 
 private:
 
+    /**
+     * Stops all IO services
+     */
+    void stop_services();
+
+    /**
+     * Resets all IO services so they can be run again
+     */
+    void reset_services();
+
     /**
      * Stops all threads used to perform work
      */
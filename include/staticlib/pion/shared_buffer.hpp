@@ -0,0 +1,143 @@
+/*
+ * Copyright 2026, alex at staticlibs.net
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   shared_buffer.hpp
+ * Author: alex
+ *
+ * Created on October 18, 2026, 2:40 AM
+ */
+
+#ifndef STATICLIB_PION_SHARED_BUFFER_HPP
+#define STATICLIB_PION_SHARED_BUFFER_HPP
+
+#include <memory>
+#include <string>
+
+#include "staticlib/config.hpp"
+#include "staticlib/io/span.hpp"
+#include "staticlib/support.hpp"
+
+#include "staticlib/pion/pion_exception.hpp"
+
+namespace staticlib {
+namespace pion {
+
+/**
+ * Immutable data with shared ownership, data is kept alive while any copy
+ * of the buffer exists, so it can be sent without copying and without
+ * tracking the completion of the send operation; copies are cheap
+ * and can be used from different threads
+ */
+class shared_buffer {
+    /**
+     * Object that owns the data
+     */
+    std::shared_ptr<const void> owner;
+
+    /**
+     * Pointer to the data
+     */
+    const char* buf_data;
+
+    /**
+     * Data length
+     */
+    std::size_t buf_size;
+
+public:
+    /**
+     * Constructor for an empty buffer
+     */
+    shared_buffer() :
+    buf_data(nullptr),
+    buf_size(0) { }
+
+    /**
+     * Constructor, buffer shares the ownership of the specified string
+     *
+     * @param str string with the data, must not be modified after this call
+     */
+    shared_buffer(std::shared_ptr<const std::string> str) :
+    buf_data(nullptr != str.get() ? str->data() : nullptr),
+    buf_size(nullptr != str.get() ? str->length() : 0) {
+        owner = std::move(str);
+    }
+
+    /**
+     * Constructor for the data owned by some other object, i.e. cached
+     * payload or a memory-mapped file
+     *
+     * @param owner object that keeps the data alive
+     * @param data data, must not be modified while the owner is alive
+     */
+    shared_buffer(std::shared_ptr<const void> owner, sl::io::span<const char> data) :
+    owner(std::move(owner)),
+    buf_data(data.data()),
+    buf_size(data.size()) { }
+
+    /**
+     * Creates a buffer with a copy of the specified data
+     *
+     * @param data data to copy
+     * @return buffer owning the copy
+     */
+    static shared_buffer copy_of(sl::io::span<const char> data) {
+        return shared_buffer(std::make_shared<const std::string>(data.data(), data.size()));
+    }
+
+    /**
+     * Returns a pointer to the data
+     *
+     * @return pointer to the data, null for an empty buffer
+     */
+    const char* data() const {
+        return buf_data;
+    }
+
+    /**
+     * Returns data length
+     *
+     * @return data length
+     */
+    std::size_t size() const {
+        return buf_size;
+    }
+
+    /**
+     * Returns a buffer that points to the part of this buffer's data
+     * and shares the ownership of it
+     *
+     * @param offset offset of the part
+     * @param len length of the part
+     * @return buffer with the part of the data
+     * @throws pion_exception if the part is out of the data bounds
+     */
+    shared_buffer slice(std::size_t offset, std::size_t len) const {
+        if (offset > buf_size || len > buf_size - offset) {
+            throw pion_exception("Invalid slice, offset: [" + sl::support::to_string(offset) + "]," +
+                    " length: [" + sl::support::to_string(len) + "]," +
+                    " buffer size: [" + sl::support::to_string(buf_size) + "]");
+        }
+        return shared_buffer(owner, {buf_data + offset, len});
+    }
+};
+
+} // namespace
+}
+
+#endif /* STATICLIB_PION_SHARED_BUFFER_HPP */
+
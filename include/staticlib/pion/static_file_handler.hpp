@@ -0,0 +1,165 @@
+/*
+ * Copyright 2026, alex at staticlibs.net
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   static_file_handler.hpp
+ * Author: alex
+ *
+ * Created on October 18, 2026, 4:20 AM
+ */
+
+#ifndef STATICLIB_PION_STATIC_FILE_HANDLER_HPP
+#define STATICLIB_PION_STATIC_FILE_HANDLER_HPP
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "staticlib/config.hpp"
+
+#include "staticlib/pion/http_request.hpp"
+#include "staticlib/pion/http_response_writer.hpp"
+
+namespace staticlib {
+namespace pion {
+
+// forward declaration
+class static_file_cache;
+
+/**
+ * Settings for the static file handler
+ */
+struct static_file_options {
+    /**
+     * Directory to serve files from
+     */
+    std::string root_directory;
+
+    /**
+     * Prefix of the URL path that is stripped before mapping
+     * the rest of the path to the file in the root directory
+     */
+    std::string url_prefix;
+
+    /**
+     * File served for the paths that end with a slash
+     */
+    std::string index_file;
+
+    /**
+     * Files up to this size are read into memory and kept in the cache
+     */
+    uint64_t max_cached_file_size;
+
+    /**
+     * Max number of bytes of file contents kept in memory
+     */
+    uint64_t memory_cache_size;
+
+    /**
+     * Files up to this size (and larger than max_cached_file_size) are
+     * mapped into memory, larger files are sent from disk on each request
+     */
+    uint64_t max_mapped_file_size;
+
+    /**
+     * Max number of bytes of files that are kept mapped
+     */
+    uint64_t mapped_cache_size;
+
+    /**
+     * Cached files are checked for changes on disk not more often than
+     * once in this interval, requests between the checks are served
+     * without touching the file system
+     */
+    uint32_t revalidate_interval_millis;
+
+    /**
+     * Serve the "file.gz" sibling with "Content-Encoding: gzip" instead
+     * of the "file" to the clients that accept gzip encoding
+     */
+    bool serve_precompressed;
+
+    /**
+     * Content types by the file extension (without a dot), in addition
+     * to (or instead of) the built-in ones for the common web files
+     */
+    std::unordered_map<std::string, std::string> mime_types;
+
+    /**
+     * Constructor, sets default values
+     */
+    static_file_options() :
+    index_file("index.html"),
+    max_cached_file_size(64 * 1024),
+    memory_cache_size(32 * 1024 * 1024),
+    max_mapped_file_size(16 * 1024 * 1024),
+    mapped_cache_size(512 * 1024 * 1024),
+    revalidate_interval_millis(1000),
+    serve_precompressed(true) { }
+};
+
+/**
+ * Request handler that serves files from the directory on disk.
+ *
+ * Small files are kept in the LRU memory cache together with their
+ * pre-serialized headers, medium files are kept memory-mapped, so the requests
+ * for the hot files are served without disk access. Large files are
+ * sent from disk with `http_response_writer::send_file`, the opened file is checked
+ * against the cached metadata and the entry is reloaded if the file was changed.
+ * Mapped files are sent from disk over TLS. Served files should be updated
+ * by replacing (renaming over) them, not by truncating them in place,
+ * as the mapped contents must not shrink while being sent.
+ *
+ * Supports conditional requests ("If-None-Match", and "If-Modified-Since"
+ * that is compared exactly to "Last-Modified" the same way as the browsers
+ * send it back), single byte ranges ("Range" and "If-Range", multiple ranges
+ * are ignored and the whole file is sent) and precompressed ".gz" siblings.
+ *
+ * Handler is cheap to copy, copies share the same cache; it is intended
+ * to be registered for GET requests (HEAD requests are handled too).
+ */
+class static_file_handler {
+    /**
+     * Cache of files, shared between copies of the handler
+     */
+    std::shared_ptr<static_file_cache> cache;
+
+public:
+    /**
+     * Constructor
+     *
+     * @param options handler settings
+     * @throws pion_exception if the root directory is not specified
+     */
+    explicit static_file_handler(static_file_options options);
+
+    /**
+     * Handles the request, sends the file, "304 Not Modified"
+     * or "404 Not Found" response
+     *
+     * @param request request to handle
+     * @param resp response writer
+     */
+    void operator()(http_request_ptr request, response_writer_ptr resp) const;
+};
+
+} // namespace
+}
+
+#endif /* STATICLIB_PION_STATIC_FILE_HANDLER_HPP */
+
@@ -30,21 +30,46 @@
 #include <functional>
 #include <memory>
 #include <string>
+#include <tuple>
+
+#ifdef __linux__
+#include <cerrno>
+#include <sys/sendfile.h>
+#endif // __linux__
 
 #include "asio.hpp"
+#ifndef STATICLIB_PION_DISABLE_SSL
 #include "asio/ssl.hpp"
+#endif // STATICLIB_PION_DISABLE_SSL
 
 #include "staticlib/config.hpp"
 
 #include "staticlib/pion/algorithm.hpp"
+#include "staticlib/pion/content_buffer_pool.hpp"
+#include "staticlib/pion/disk_io_pool.hpp"
+#include "staticlib/pion/read_buffer_pool.hpp"
+#include "staticlib/pion/tcp_connection_registry.hpp"
 
 namespace staticlib { 
 namespace pion {
 
+/**
+ * Base class for the protocol objects, that are cached by the connection
+ * to be reused by the subsequent requests over the same connection
+ */
+class tcp_connection_cache {
+public:
+    /**
+     * Virtual destructor
+     */
+    virtual ~tcp_connection_cache() STATICLIB_NOEXCEPT { }
+};
+
 /**
  * Represents a single tcp connection
  */
 class tcp_connection : public std::enable_shared_from_this<tcp_connection> {
+    friend class tcp_connection_registry;
 
 public:
 
@@ -65,39 +90,90 @@ public:
     /**
      * Data type for an I/O read buffer
      */
-    using read_buffer_type = std::array<char, 8192>;
+    using read_buffer_type = read_buffer_pool::buffer_type;
+
+    /**
+     * Size of the read buffer, reads of this size (or smaller) use the read buffer,
+     * larger reads use the bulk read buffer
+     */
+    static const std::size_t READ_BUFFER_SIZE = std::tuple_size<read_buffer_type>::value;
 
     /**
      * Data type for a socket connection
      */
     using socket_type = asio::ip::tcp::socket;
 
+#ifndef STATICLIB_PION_DISABLE_SSL
     /**
-     * Data type for an SSL socket connection
+     * Data type for an SSL socket connection, SSL stream works
+     * over the TCP socket owned by the connection
      */
-    using ssl_socket_type = asio::ssl::stream<asio::ip::tcp::socket>;
+    using ssl_socket_type = asio::ssl::stream<asio::ip::tcp::socket&>;
 
     /**
      * Data type for SSL configuration context
      */
     using ssl_context_type = asio::ssl::context;
+#endif // STATICLIB_PION_DISABLE_SSL
 
 private:
 
     /**
-     * SSL connection socket
+     * TCP connection socket
+     */
+    socket_type socket;
+
+#ifndef STATICLIB_PION_DISABLE_SSL
+    /**
+     * SSL context, null for plain connections
+     */
+    ssl_context_type* ssl_context;
+
+    /**
+     * SSL stream over the TCP socket, null for plain connections
+     */
+    std::unique_ptr<ssl_socket_type> ssl_socket;
+#endif // STATICLIB_PION_DISABLE_SSL
+
+    /**
+     * Buffer used for reading data from the TCP connection,
+     * null while the connection waits for the data
+     */
+    std::unique_ptr<read_buffer_type> read_buffer;
+
+    /**
+     * Pool the read buffer is borrowed from, if null the read buffer
+     * is owned by the connection for its whole lifetime
+     */
+    read_buffer_pool* buffer_pool;
+
+    /**
+     * Pool the content buffers of the requests read from this connection
+     * are taken from, if null content buffers are allocated directly
+     */
+    std::shared_ptr<content_buffer_pool> content_pool;
+
+    /**
+     * Pool that runs the disk reads for the responses sent over this connection,
+     * if null the disk reads are done on the IO thread
+     */
+    disk_io_pool* disk_pool;
+
+    /**
+     * Buffer used for reads larger than the read buffer (request body),
+     * allocated on demand and kept while the large reads are requested
      */
-    ssl_socket_type ssl_socket;
+    std::unique_ptr<char[]> bulk_read_buffer;
 
     /**
-     * True if the connection is encrypted using SSL
+     * Size of the bulk read buffer
      */
-    bool ssl_flag;
+    std::size_t bulk_read_buffer_size;
 
     /**
-     * Buffer used for reading data from the TCP connection
+     * Points to the data read by the last read operation
      */
-    read_buffer_type read_buffer;
+    char* read_data;
 
     /**
      * Saved read position bookmark
@@ -124,28 +200,84 @@ private:
      */
     asio::steady_timer timer;
 
+    /**
+     * Protocol objects cached by the connection, cache is kept
+     * when the closed connection object is reused
+     */
+    std::shared_ptr<tcp_connection_cache> cache;
+
+    /**
+     * True if the connection is added to the server's connection registry
+     */
+    bool registered;
+
+    /**
+     * Index of the registry shard this connection belongs to
+     */
+    uint32_t registry_shard;
+
+    /**
+     * Previous connection in the registry shard list
+     */
+    tcp_connection* registry_prev;
+
+    /**
+     * Next connection in the registry shard list
+     */
+    tcp_connection* registry_next;
+
 public:
 
     /**
-     * Constructor to be used with `std::make_shared`
+     * Constructor for plain (not encrypted) connections, to be used with
+     * `std::make_shared` or with `std::shared_ptr` and a custom deleter
      *
      * @param io_service asio service associated with the connection
-     * @param ssl_context asio ssl context associated with the connection
-     * @param ssl_flag if true then the connection will be encrypted using SSL 
      * @param finished_handler function called when a server has finished
      *                         handling the connection
      */
-    tcp_connection(asio::io_service& io_service, ssl_context_type& ssl_context, const bool ssl_flag_in,
-            connection_handler finished_handler_in) :
-    ssl_socket(io_service, ssl_context), 
-    ssl_flag(ssl_flag_in),
+    tcp_connection(asio::io_service& io_service, connection_handler finished_handler_in) :
+    socket(io_service),
+#ifndef STATICLIB_PION_DISABLE_SSL
+    ssl_context(nullptr),
+#endif // STATICLIB_PION_DISABLE_SSL
+    buffer_pool(nullptr),
+    disk_pool(nullptr),
+    bulk_read_buffer_size(0),
+    read_data(nullptr),
     current_lifecycle(lifecycle::close),
     finished_handler(finished_handler_in),
     strand(io_service),
-    timer(io_service) {
+    timer(io_service),
+    registered(false),
+    registry_shard(0),
+    registry_prev(nullptr),
+    registry_next(nullptr) {
         save_read_pos(nullptr, nullptr);
     }
 
+#ifndef STATICLIB_PION_DISABLE_SSL
+    /**
+     * Constructor to be used with `std::make_shared` or with `std::shared_ptr`
+     * and a custom deleter
+     *
+     * @param io_service asio service associated with the connection
+     * @param ssl_context asio ssl context associated with the connection
+     * @param ssl_flag if true then the connection will be encrypted using SSL,
+     *        otherwise SSL context is not used
+     * @param finished_handler function called when a server has finished
+     *                         handling the connection
+     */
+    tcp_connection(asio::io_service& io_service, ssl_context_type& ssl_context_in, const bool ssl_flag_in,
+            connection_handler finished_handler_in) :
+    tcp_connection(io_service, std::move(finished_handler_in)) {
+        if (ssl_flag_in) {
+            this->ssl_context = std::addressof(ssl_context_in);
+            this->ssl_socket.reset(new ssl_socket_type(socket, ssl_context_in));
+        }
+    }
+#endif // STATICLIB_PION_DISABLE_SSL
+
     /**
      * Deleted copy constructor
      */
@@ -161,6 +293,25 @@ public:
      */
     virtual ~tcp_connection() {
         close();
+        release_read_buffer();
+    }
+
+    /**
+     * Resets the state of the closed connection, so the object
+     * can be reused to accept another connection
+     */
+    void reset() {
+        cancel_timer();
+        current_lifecycle = lifecycle::close;
+        save_read_pos(nullptr, nullptr);
+        release_read_buffer();
+        release_bulk_read_buffer();
+#ifndef STATICLIB_PION_DISABLE_SSL
+        if (nullptr != ssl_socket.get()) {
+            // SSL stream state cannot be reset, new stream is created over the same socket
+            ssl_socket.reset(new ssl_socket_type(socket, *ssl_context));
+        }
+#endif // STATICLIB_PION_DISABLE_SSL
     }
 
     /**
@@ -169,7 +320,7 @@ public:
      * @return true if the connection is currently open
      */
     bool is_open() const {
-        return const_cast<ssl_socket_type&> (ssl_socket).lowest_layer().is_open();
+        return socket.is_open();
     }
 
     /**
@@ -180,17 +331,17 @@ public:
             try {
                 // shutting down SSL will wait forever for a response from the remote end,
                 // which causes it to hang indefinitely if the other end died unexpectedly
-                // if (get_ssl_flag()) ssl_socket.shutdown();
+                // if (get_ssl_flag()) ssl_socket->shutdown();
 
                 // windows seems to require this otherwise it doesn't
                 // recognize that connections have been closed
-                ssl_socket.next_layer().shutdown(asio::ip::tcp::socket::shutdown_both);
+                socket.shutdown(asio::ip::tcp::socket::shutdown_both);
             } catch (...) {
             } // ignore exceptions
 
             // close the underlying socket (ignore errors)
             std::error_code ec;
-            ssl_socket.next_layer().close(ec);
+            socket.close(ec);
         }
     }
 
@@ -204,7 +355,7 @@ public:
         // and the suggested #define statements cause WAY too much trouble and heartache
         #if !defined(_MSC_VER) || (_WIN32_WINNT >= 0x0600)
             std::error_code ec;
-            ssl_socket.next_layer().cancel(ec);
+            socket.cancel(ec);
         #endif // !WINXP
     }
 
@@ -228,9 +379,10 @@ public:
      */
     template <typename AcceptHandler>
     void async_accept(asio::ip::tcp::acceptor& tcp_acceptor, AcceptHandler handler) {
-        tcp_acceptor.async_accept(ssl_socket.lowest_layer(), handler);
+        tcp_acceptor.async_accept(socket, handler);
     }
 
+#ifndef STATICLIB_PION_DISABLE_SSL
     /**
      * Asynchronously performs server-side SSL handshake for a new connection
      *
@@ -240,12 +392,19 @@ public:
      */
     template <typename SSLHandshakeHandler>
     void async_handshake_server(SSLHandshakeHandler handler) {
-        ssl_socket.async_handshake(asio::ssl::stream_base::server, handler);
-        ssl_flag = true;
+        ssl_socket->async_handshake(asio::ssl::stream_base::server, handler);
     }
+#endif // STATICLIB_PION_DISABLE_SSL
 
     /**
-     * Asynchronously reads some data into the connection's read buffer 
+     * Asynchronously reads some data into the connection's read buffer,
+     * data previously read into the buffer must be already consumed;
+     * when the read buffer is borrowed from the pool, connection returns
+     * the buffer and waits for the socket to become readable before borrowing
+     * it again; SSL connection does the same only between the messages
+     * (see the overload with "between_messages" flag);
+     * socket is switched to non-blocking mode on the first readiness wait
+     * and stays in it, the connection does not use blocking socket operations
      *
      * @param handler called after the read operation has completed
      *
@@ -253,11 +412,57 @@ public:
      */
     template <typename ReadHandler>
     void async_read_some(ReadHandler handler) {
-        if (get_ssl_flag()) {
-            ssl_socket.async_read_some(asio::buffer(read_buffer), handler);
-        } else {
-            ssl_socket.next_layer().async_read_some(asio::buffer(read_buffer), handler);
+        async_read_some(READ_BUFFER_SIZE, std::move(handler));
+    }
+
+    /**
+     * Asynchronously reads up to the specified number of bytes, reads larger
+     * than the read buffer use the bulk read buffer; plain connection with
+     * the pooled read buffer reads only the data that is already available
+     * on the socket, so the bulk buffer is only grown when there is a backlog;
+     * SSL stream may keep received data that is not visible on the socket, so
+     * SSL connection waits for the socket readiness without the read buffer only
+     * between the messages, when the peer is not expected to have sent anything;
+     * data read is available through "get_read_data()"
+     *
+     * @param max_bytes max number of bytes to read
+     * @param handler called after the read operation has completed
+     * @param between_messages true if the previous message is fully consumed
+     *        and the next one is not started yet
+     */
+    template <typename ReadHandler>
+    void async_read_some(std::size_t max_bytes, ReadHandler handler, bool between_messages = false) {
+        if (max_bytes <= READ_BUFFER_SIZE) {
+            release_bulk_read_buffer();
+        }
+#ifndef STATICLIB_PION_DISABLE_SSL
+        if (nullptr != ssl_socket.get()) {
+            if (nullptr == buffer_pool || !between_messages || is_ssl_input_pending()) {
+                ssl_socket->async_read_some(prepare_read_buffer(max_bytes), handler);
+                return;
+            }
+            release_read_buffer();
+            auto self = shared_from_this();
+            async_wait_readable(strand.wrap([self, max_bytes, handler](const std::error_code& ec) mutable {
+                if (ec) {
+                    handler(ec, 0);
+                    return;
+                }
+                self->ssl_socket->async_read_some(self->prepare_read_buffer(max_bytes), handler);
+            }));
+            return;
         }
+#endif // STATICLIB_PION_DISABLE_SSL
+        if (nullptr == buffer_pool) {
+            socket.async_read_some(prepare_read_buffer(max_bytes), handler);
+            return;
+        }
+        release_read_buffer();
+        auto self = shared_from_this();
+        // speculative read runs on the strand, so it does not race with the writes
+        async_wait_readable(strand.wrap([self, max_bytes, handler](const std::error_code& ec) mutable {
+            self->read_when_ready(ec, max_bytes, handler);
+        }));
     }
 
     /**
@@ -270,13 +475,34 @@ public:
      */
     template <typename ConstBufferSequence, typename write_handler_t>
     void async_write(const ConstBufferSequence& buffers, write_handler_t handler) {
-        if (get_ssl_flag()) {
-            asio::async_write(ssl_socket, buffers, handler);
-        } else {
-            asio::async_write(ssl_socket.next_layer(), buffers, handler);
+#ifndef STATICLIB_PION_DISABLE_SSL
+        if (nullptr != ssl_socket.get()) {
+            asio::async_write(*ssl_socket, buffers, handler);
+            return;
         }
+#endif // STATICLIB_PION_DISABLE_SSL
+        asio::async_write(socket, buffers, handler);
     }
 
+#ifdef __linux__
+    /**
+     * Asynchronously sends the part of the file with "sendfile(2)", so the file
+     * data is copied to the socket inside the kernel; only usable with plain
+     * connections; handler is called directly (before this call returns)
+     * if the data is sent without waiting for the socket
+     *
+     * @param fd file descriptor
+     * @param offset offset of the first byte to send
+     * @param len number of bytes to send
+     * @param handler called with the error and the number of bytes sent,
+     *        "asio::error::eof" is reported if the file is shorter than expected
+     */
+    template <typename WriteHandler>
+    void async_sendfile(int fd, uint64_t offset, std::size_t len, WriteHandler handler) {
+        sendfile_when_ready(std::error_code(), fd, offset, len, 0, handler);
+    }
+#endif // __linux__
+
     /**
      * This function should be called when a server has finished handling the connection
      */
@@ -293,7 +519,11 @@ public:
      * @return true if the connection is encrypted using SSL
      */
     bool get_ssl_flag() const {
-        return ssl_flag;
+#ifndef STATICLIB_PION_DISABLE_SSL
+        return nullptr != ssl_socket.get();
+#else // STATICLIB_PION_DISABLE_SSL
+        return false;
+#endif // STATICLIB_PION_DISABLE_SSL
     }
 
     /**
@@ -329,7 +559,68 @@ public:
      * @return buffer used for reading data from the TCP connection
      */
     read_buffer_type& get_read_buffer() {
-        return read_buffer;
+        acquire_read_buffer();
+        return *read_buffer;
+    }
+
+    /**
+     * Returns the data read by the last read operation, it is placed either
+     * into the read buffer or into the bulk read buffer
+     * 
+     * @return pointer to the data read by the last read operation
+     */
+    const char* get_read_data() const {
+        return read_data;
+    }
+
+    /**
+     * Sets the pool the read buffer is borrowed from
+     * 
+     * @param pool buffer pool, if null the read buffer is owned by the connection
+     */
+    void set_read_buffer_pool(read_buffer_pool* pool) {
+        if (pool != buffer_pool) {
+            release_read_buffer();
+            buffer_pool = pool;
+        }
+    }
+
+    /**
+     * Returns the pool the content buffers of the received requests are taken from
+     *
+     * @return content buffer pool, may be null
+     */
+    const std::shared_ptr<content_buffer_pool>& get_content_buffer_pool() const {
+        return content_pool;
+    }
+
+    /**
+     * Sets the pool the content buffers of the received requests are taken from
+     *
+     * @param pool content buffer pool, if null content buffers are allocated directly
+     */
+    void set_content_buffer_pool(const std::shared_ptr<content_buffer_pool>& pool) {
+        if (pool != content_pool) {
+            content_pool = pool;
+        }
+    }
+
+    /**
+     * Returns the pool that runs the disk reads for the responses
+     *
+     * @return disk IO pool, may be null
+     */
+    disk_io_pool* get_disk_io_pool() const {
+        return disk_pool;
+    }
+
+    /**
+     * Sets the pool that runs the disk reads for the responses
+     *
+     * @param pool disk IO pool, if null disk reads are done on the IO thread
+     */
+    void set_disk_io_pool(disk_io_pool* pool) {
+        disk_pool = pool;
     }
 
     /**
@@ -362,8 +653,7 @@ public:
     asio::ip::tcp::endpoint get_remote_endpoint() const {
         asio::ip::tcp::endpoint remote_endpoint;
         try {
-            // const_cast is required since lowest_layer() is only defined non-const in asio
-            remote_endpoint = const_cast<ssl_socket_type&> (ssl_socket).lowest_layer().remote_endpoint();
+            remote_endpoint = socket.remote_endpoint();
         } catch (asio::system_error& /* e */) {
             // do nothing
         }
@@ -395,9 +685,9 @@ public:
      */
     asio::io_service& get_io_service() {
 #if ASIO_VERSION >= 101400
-        return static_cast<asio::io_service&>(ssl_socket.lowest_layer().get_executor().context());
+        return static_cast<asio::io_service&>(socket.get_executor().context());
 #else
-        return ssl_socket.lowest_layer().get_io_service();
+        return socket.get_io_service();
 #endif
     }
 
@@ -407,16 +697,37 @@ public:
      * @return underlying TCP socket object
      */
     socket_type& get_socket() {
-        return ssl_socket.next_layer();
+        return socket;
     }
 
+#ifndef STATICLIB_PION_DISABLE_SSL
     /**
-     * Returns non-const reference to underlying SSL socket object
+     * Returns non-const reference to underlying SSL socket object,
+     * must only be called for SSL connections
      * 
      * @return underlying SSL socket object
      */
     ssl_socket_type& get_ssl_socket() {
-        return ssl_socket;
+        return *ssl_socket;
+    }
+#endif // STATICLIB_PION_DISABLE_SSL
+
+    /**
+     * Returns protocol objects cached by the connection
+     * 
+     * @return cache, null if not set
+     */
+    std::shared_ptr<tcp_connection_cache>& get_cache() {
+        return cache;
+    }
+
+    /**
+     * Sets the protocol objects cache
+     * 
+     * @param cache cache
+     */
+    void set_cache(std::shared_ptr<tcp_connection_cache> cache) {
+        this->cache = std::move(cache);
     }
 
     /**
@@ -437,6 +748,187 @@ public:
         return timer;
     }
 
+private:
+
+    /**
+     * Borrows the read buffer from the pool (or allocates it if pool is not used),
+     * does nothing if the buffer is already held
+     */
+    void acquire_read_buffer() {
+        if (nullptr == read_buffer.get()) {
+            read_buffer = nullptr != buffer_pool ? buffer_pool->acquire() :
+                    std::unique_ptr<read_buffer_type>(new read_buffer_type);
+        }
+    }
+
+    /**
+     * Returns the read buffer to the pool, does nothing
+     * if the pool is not used
+     */
+    void release_read_buffer() {
+        if (nullptr != buffer_pool && nullptr != read_buffer.get()) {
+            buffer_pool->release(std::move(read_buffer));
+        }
+    }
+
+    /**
+     * Frees the bulk read buffer
+     */
+    void release_bulk_read_buffer() {
+        if (nullptr != bulk_read_buffer.get()) {
+            bulk_read_buffer.reset();
+            bulk_read_buffer_size = 0;
+        }
+    }
+
+    /**
+     * Chooses the buffer for the next read operation
+     *
+     * @param size number of bytes to read
+     * @return buffer to read into
+     */
+    asio::mutable_buffers_1 prepare_read_buffer(std::size_t size) {
+        if (size <= READ_BUFFER_SIZE) {
+            acquire_read_buffer();
+            read_data = read_buffer->data();
+            return asio::mutable_buffers_1(read_data, READ_BUFFER_SIZE);
+        }
+        if (bulk_read_buffer_size < size) {
+            // not zero-filled
+            bulk_read_buffer.reset(new char[size]);
+            bulk_read_buffer_size = size;
+        }
+        read_data = bulk_read_buffer.get();
+        return asio::mutable_buffers_1(read_data, size);
+    }
+
+#ifdef __linux__
+    /**
+     * Sends the file data until the socket buffer is full, then waits
+     * for the socket to become writable again
+     *
+     * @param wait_error error of the readiness wait
+     * @param fd file descriptor
+     * @param offset offset of the next byte to send
+     * @param len number of bytes left to send
+     * @param sent number of bytes already sent
+     * @param handler called after the whole data has been sent
+     */
+    template <typename WriteHandler>
+    void sendfile_when_ready(const std::error_code& wait_error, int fd, uint64_t offset, std::size_t len,
+            std::size_t sent, WriteHandler& handler) {
+        if (wait_error) {
+            handler(wait_error, sent);
+            return;
+        }
+        std::error_code ec;
+        if (!socket.non_blocking()) {
+            socket.non_blocking(true, ec);
+        }
+        while (!ec && len > 0) {
+            off_t off = static_cast<off_t>(offset);
+            ssize_t res = ::sendfile(socket.native_handle(), fd, std::addressof(off), len);
+            if (res > 0) {
+                std::size_t count = static_cast<std::size_t>(res);
+                offset += count;
+                len -= count;
+                sent += count;
+            } else if (0 == res) {
+                ec = asio::error::eof;
+            } else if (EINTR == errno) {
+                continue;
+            } else if (EAGAIN == errno || EWOULDBLOCK == errno) {
+                auto self = shared_from_this();
+                auto cb = [self, fd, offset, len, sent, handler](const std::error_code& ec) mutable {
+                    self->sendfile_when_ready(ec, fd, offset, len, sent, handler);
+                };
+#if ASIO_VERSION >= 101100
+                socket.async_wait(asio::ip::tcp::socket::wait_write, std::move(cb));
+#else // ASIO_VERSION < 101100
+                socket.async_write_some(asio::null_buffers(), [cb](const std::error_code& ec, std::size_t) mutable {
+                    cb(ec);
+                });
+#endif // ASIO_VERSION
+                return;
+            } else {
+                ec = std::error_code(errno, std::system_category());
+            }
+        }
+        handler(ec, sent);
+    }
+#endif // __linux__
+
+    /**
+     * Waits for the socket to become readable without reading any data
+     *
+     * @param handler called when the socket is readable
+     */
+    template <typename WaitHandler>
+    void async_wait_readable(WaitHandler handler) {
+#if ASIO_VERSION >= 101100
+        socket.async_wait(asio::ip::tcp::socket::wait_read, std::move(handler));
+#else // ASIO_VERSION < 101100
+        socket.async_read_some(asio::null_buffers(), [handler](const std::error_code& ec, std::size_t) mutable {
+            handler(ec);
+        });
+#endif // ASIO_VERSION
+    }
+
+#ifndef STATICLIB_PION_DISABLE_SSL
+    /**
+     * Checks whether the SSL stream holds the data that can be read without
+     * waiting for the socket: decrypted bytes of the current record or
+     * received encrypted bytes not yet processed by the SSL engine (bytes that
+     * asio keeps outside of the engine BIO are not visible here)
+     *
+     * @return true if SSL stream has the input data
+     */
+    bool is_ssl_input_pending() {
+        SSL* ssl = ssl_socket->native_handle();
+        if (SSL_pending(ssl) > 0) {
+            return true;
+        }
+        BIO* rbio = SSL_get_rbio(ssl);
+        return nullptr != rbio && BIO_ctrl_pending(rbio) > 0;
+    }
+#endif // STATICLIB_PION_DISABLE_SSL
+
+    /**
+     * Reads the data available on the socket into the borrowed buffer,
+     * waits for the socket to become readable again if no data is available
+     *
+     * @param wait_error error of the readiness wait
+     * @param max_bytes max number of bytes to read
+     * @param handler called after the read operation has completed
+     */
+    template <typename ReadHandler>
+    void read_when_ready(const std::error_code& wait_error, std::size_t max_bytes, ReadHandler& handler) {
+        if (wait_error) {
+            handler(wait_error, 0);
+            return;
+        }
+        std::error_code ec;
+        if (!socket.non_blocking()) {
+            socket.non_blocking(true, ec);
+        }
+        std::size_t size = max_bytes;
+        if (!ec && max_bytes > READ_BUFFER_SIZE) {
+            // FIONREAD, bulk buffer is only used when there is a backlog on the socket
+            std::size_t available = socket.available(ec);
+            size = available < max_bytes ? available : max_bytes;
+        }
+        std::size_t bytes_read = 0;
+        if (!ec) {
+            bytes_read = socket.read_some(prepare_read_buffer(size), ec);
+        }
+        if (asio::error::would_block == ec || asio::error::try_again == ec) {
+            // spurious wakeup, nothing to read
+            async_read_some(max_bytes, std::move(handler));
+            return;
+        }
+        handler(ec, bytes_read);
+    }
+
 };
 
 /**
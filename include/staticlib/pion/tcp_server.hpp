@@ -26,16 +26,21 @@
 #ifndef STATICLIB_PION_TCP_SERVER_HPP
 #define STATICLIB_PION_TCP_SERVER_HPP
 
+#include <atomic>
 #include <condition_variable>
+#include <memory>
 #include <mutex>
-#include <set>
+#include <vector>
 
 #include "asio.hpp"
 
 #include "staticlib/config.hpp"
 
 #include "staticlib/pion/scheduler.hpp"
+#include "staticlib/pion/disk_io_pool.hpp"
 #include "staticlib/pion/tcp_connection.hpp"
+#include "staticlib/pion/tcp_connection_registry.hpp"
+#include "staticlib/pion/tcp_server_options.hpp"
 
 namespace staticlib { 
 namespace pion {
@@ -52,29 +57,40 @@ protected:
     scheduler active_scheduler;
 
     /**
-     * Manages async TCP connections
+     * Threads that run disk reads for the responses, destroyed
+     * before the scheduler, null until the server is started
      */
-    asio::ip::tcp::acceptor tcp_acceptor;
+    std::unique_ptr<disk_io_pool> disk_pool;
 
     /**
-     * Context used for SSL configuration
+     * Manage async TCP connections, contains one acceptor per
+     * scheduler thread when SO_REUSEPORT is used, single acceptor otherwise
      */
-    tcp_connection::ssl_context_type ssl_context;
+    std::vector<std::unique_ptr<asio::ip::tcp::acceptor>> acceptors;
 
     /**
-     * Condition triggered when the server has stopped listening for connections
+     * Strands (one per acceptor) that serialize accepting with closing of the acceptor,
+     * acceptors and strands are recreated only on start, so accept path takes no lock
      */
-    std::condition_variable server_has_stopped;
+    std::vector<std::unique_ptr<asio::io_service::strand>> acceptor_strands;
 
+#ifndef STATICLIB_PION_DISABLE_SSL
     /**
-     * Condition triggered when the connection pool is empty
+     * Context used for SSL configuration, null if the server does not use SSL
      */
-    std::condition_variable no_more_connections;
+    std::unique_ptr<tcp_connection::ssl_context_type> ssl_context;
+#endif // STATICLIB_PION_DISABLE_SSL
 
     /**
-     * Pool of active connections associated with this server 
+     * Condition triggered when the server has stopped listening for connections
      */
-    std::set<tcp_connection_ptr> conn_pool;
+    std::condition_variable server_has_stopped;
+
+    /**
+     * Registry of active connections associated with this server, it is shared
+     * with connections, that are released to it when the last reference is dropped
+     */
+    std::shared_ptr<tcp_connection_registry> conn_registry;
 
     /**
      * TCP endpoint used to listen for new connections
@@ -82,14 +98,14 @@ protected:
     asio::ip::tcp::endpoint tcp_endpoint;
 
     /**
-     * true if the server uses SSL to encrypt connections
+     * Server options
      */
-    bool ssl_flag;
+    tcp_server_options options;
 
     /**
      * Set to true when the server is listening for new connections
      */
-    bool listening;
+    std::atomic<bool> listening;
 
     /**
      * Mutex to make class thread-safe
@@ -105,10 +121,8 @@ public:
      */
     tcp_server(const asio::ip::tcp::endpoint& endpoint, uint32_t number_of_threads) :
     active_scheduler(number_of_threads),
-    tcp_acceptor(active_scheduler.get_io_service()),
-    ssl_context(asio::ssl::context::sslv23),
+    conn_registry(std::make_shared<tcp_connection_registry>(number_of_threads)),
     tcp_endpoint(endpoint), 
-    ssl_flag(false),
     listening(false) { }
 
     /**
@@ -133,6 +147,8 @@ public:
     //            STATICLIB_PION_LOG_WARN("Exception thrown in tcp::server destructor: " << e.message());
             }
         }
+        // spare connections must be destroyed before the scheduler services
+        conn_registry->clear_spare();
     }
     
     /**
@@ -167,6 +183,22 @@ public:
         tcp_conn->finish();
     }
 
+    /**
+     * Sets server options, options cannot be changed while the server is listening
+     * 
+     * @param opts server options
+     */
+    void set_options(const tcp_server_options& opts);
+
+    /**
+     * Returns server options
+     * 
+     * @return server options
+     */
+    const tcp_server_options& get_options() const {
+        return options;
+    }
+
     /**
      * Returns an async I/O service used to schedule work
      * 
@@ -201,19 +233,54 @@ private:
      */
     void handle_stop_request();
 
+    /**
+     * Opens, binds and starts listening on all acceptors,
+     * assumes that a server lock has already been acquired
+     */
+    void open_acceptors();
+
+    /**
+     * Applies socket options to the listening socket, options
+     * that cannot be applied are reported in log
+     * 
+     * @param acceptor acceptor opened but not yet bound
+     */
+    void apply_acceptor_options(asio::ip::tcp::acceptor& acceptor);
+
+    /**
+     * Applies socket options to the accepted socket, options
+     * that cannot be applied are reported in log
+     * 
+     * @param tcp_conn accepted connection
+     */
+    void apply_socket_options(tcp_connection& tcp_conn);
+
     /**
      * Listens for a new connection
+     * 
+     * @param acceptor_idx index of the acceptor to use
      */
-    void listen();
+    void listen(std::size_t acceptor_idx);
 
     /**
      * Handles new connections (checks if there was an accept error)
      *
+     * @param acceptor_idx index of the acceptor that accepted this connection
      * @param tcp_conn the new TCP connection (if no error occurred)
      * @param accept_error true if an error occurred while accepting connections
      */
-    void handle_accept(tcp_connection_ptr& tcp_conn, const std::error_code& accept_error);
+    void handle_accept(std::size_t acceptor_idx, tcp_connection_ptr& tcp_conn,
+            const std::error_code& accept_error);
+
+    /**
+     * Starts handling of the accepted connection, performs SSL handshake if necessary,
+     * must be called from the thread that runs the connection's IO service
+     *
+     * @param tcp_conn the new TCP connection
+     */
+    void handle_new_connection(tcp_connection_ptr& tcp_conn);
 
+#ifndef STATICLIB_PION_DISABLE_SSL
     /**
      * Handles new connections following an SSL handshake (checks for errors)
      *
@@ -221,25 +288,19 @@ private:
      * @param handshake_error true if an error occurred during the SSL handshake
      */
     void handle_ssl_handshake(tcp_connection_ptr& tcp_conn, const std::error_code& handshake_error);
+#endif // STATICLIB_PION_DISABLE_SSL
 
     /**
      * This will be called by connection::finish() after a server has
      * finished handling a connection. If the keep_alive flag is true,
-     * it will call handle_connection(); otherwise, it will close the
-     * connection and remove it from the server's management pool
+     * it will call handle_connection(); otherwise the connection is closed
+     * and removed from the server's registry once the last reference
+     * to it is released
      * 
      * @param tcp_conn TCP connection
      */
     void finish_connection(tcp_connection_ptr& tcp_conn);
 
-    /**
-     * Prunes orphaned connections that did not close cleanly
-     * and returns the remaining number of connections in the pool
-     * 
-     * @return remaining number of connections in the pool
-     */
-    std::size_t prune_connections();
-
 };
 
 } // namespace
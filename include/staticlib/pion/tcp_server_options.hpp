@@ -0,0 +1,209 @@
+/*
+ * Copyright 2026, alex at staticlibs.net
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   tcp_server_options.hpp
+ * Author: alex
+ *
+ * Created on October 16, 2026, 11:15 PM
+ */
+
+#ifndef STATICLIB_PION_TCP_SERVER_OPTIONS_HPP
+#define STATICLIB_PION_TCP_SERVER_OPTIONS_HPP
+
+#include <cstdint>
+#include <string>
+
+namespace staticlib {
+namespace pion {
+
+/**
+ * Options used by TCP server, socket-level options that are not
+ * supported on the current platform are ignored
+ */
+struct tcp_server_options {
+    /**
+     * Open one acceptor per scheduler thread, all of them bound to the same
+     * endpoint with SO_REUSEPORT, so the kernel spreads incoming connections
+     * between them; connections accepted by the acceptor N are handled
+     * by the IO service N of the scheduler
+     */
+    bool reuse_port;
+
+    /**
+     * Attach a CBPF program (Linux only) to the SO_REUSEPORT group that
+     * selects the acceptor by the index of the CPU that received the connection,
+     * only used when "reuse_port" is enabled; when the scheduler runs one IO service
+     * per thread and is not started yet, the thread N is pinned to the CPU N,
+     * otherwise steering only helps if scheduler threads are pinned externally
+     */
+    bool reuse_port_cpu_steering;
+
+    /**
+     * Max number of closed connection objects kept for reuse
+     * per scheduler thread, zero disables recycling of connections
+     */
+    uint32_t connection_pool_size;
+
+    /**
+     * Max number of free read buffers kept for reuse per scheduler thread;
+     * when enabled, idle connections return their read buffers to the pool
+     * while waiting for data (SSL connections only while waiting for the next
+     * request), zero disables pooling and each connection
+     * keeps its own read buffer for its whole lifetime
+     */
+    uint32_t read_buffer_pool_size;
+
+    /**
+     * Max number of bytes held in free request content buffers kept for reuse
+     * per scheduler thread; buffers are pooled by size classes from 4 KB to 1 MB
+     * and are not zero-filled on reuse, the same pool provides slabs for the data
+     * copied by response writers; zero disables pooling and content buffers
+     * are allocated for each request
+     */
+    uint32_t content_buffer_pool_bytes;
+
+    /**
+     * Number of threads that read files sent with "send_file()" over TLS
+     * connections (and over plain connections where "sendfile(2)" is not
+     * available), zero means that files are read on the IO threads
+     */
+    uint32_t disk_io_threads;
+
+    /**
+     * Max number of bytes read from the socket in a single operation while
+     * receiving the request body; body reads start with the size of the read
+     * buffer (8 KB) and grow while the reads fill the whole buffer,
+     * headers are always read with the read buffer
+     */
+    uint32_t max_read_size;
+
+    /**
+     * Max length of the request body stored by the server, longer bodies are
+     * truncated; only applies to requests without payload handlers
+     */
+    uint64_t max_content_length;
+
+    /**
+     * Request bodies longer than this are written to unlinked temporary files
+     * instead of memory, and are mapped to memory on the first access to the
+     * content, zero disables temporary files
+     */
+    uint32_t content_spill_threshold;
+
+    /**
+     * Directory for temporary files with request bodies, system
+     * temporary directory is used if empty
+     */
+    std::string content_spill_directory;
+
+    /**
+     * Max length of the queue of pending connections passed to "listen()",
+     * zero means the system default ("SOMAXCONN")
+     */
+    uint32_t listen_backlog;
+
+    /**
+     * Disable Nagle algorithm (TCP_NODELAY) on accepted sockets, so small
+     * responses are not delayed waiting for the ACK from client
+     */
+    bool tcp_no_delay;
+
+    /**
+     * Timeout in seconds for TCP_DEFER_ACCEPT (Linux only), accepted connection
+     * is reported only after client sends the data, zero disables it
+     */
+    uint32_t defer_accept_seconds;
+
+    /**
+     * Length of the queue of pending TCP_FASTOPEN requests,
+     * zero disables TCP Fast Open
+     */
+    uint32_t fast_open_queue_length;
+
+    /**
+     * Value of TCP_NOTSENT_LOWAT for accepted sockets in bytes,
+     * zero means the system default
+     */
+    uint32_t not_sent_low_watermark;
+
+    /**
+     * Value of SO_RCVBUF in bytes, set on the listening socket
+     * to be inherited by accepted ones, zero means the system default
+     */
+    uint32_t receive_buffer_size;
+
+    /**
+     * Value of SO_SNDBUF for accepted sockets in bytes,
+     * zero means the system default
+     */
+    uint32_t send_buffer_size;
+
+    /**
+     * Enable SO_KEEPALIVE on accepted sockets
+     */
+    bool keep_alive;
+
+    /**
+     * Idle time in seconds before the first keep-alive probe (TCP_KEEPIDLE),
+     * only used when "keep_alive" is enabled, zero means the system default
+     */
+    uint32_t keep_alive_idle_seconds;
+
+    /**
+     * Interval in seconds between keep-alive probes (TCP_KEEPINTVL),
+     * only used when "keep_alive" is enabled, zero means the system default
+     */
+    uint32_t keep_alive_interval_seconds;
+
+    /**
+     * Number of unanswered keep-alive probes before the connection is dropped (TCP_KEEPCNT),
+     * only used when "keep_alive" is enabled, zero means the system default
+     */
+    uint32_t keep_alive_count;
+
+    /**
+     * Constructor, sets default values
+     */
+    tcp_server_options() :
+    reuse_port(false),
+    reuse_port_cpu_steering(false),
+    connection_pool_size(64),
+    read_buffer_pool_size(64),
+    content_buffer_pool_bytes(4194304),
+    disk_io_threads(2),
+    max_read_size(262144),
+    max_content_length(1048576),
+    content_spill_threshold(0),
+    content_spill_directory(),
+    listen_backlog(0),
+    tcp_no_delay(true),
+    defer_accept_seconds(0),
+    fast_open_queue_length(0),
+    not_sent_low_watermark(0),
+    receive_buffer_size(0),
+    send_buffer_size(0),
+    keep_alive(false),
+    keep_alive_idle_seconds(0),
+    keep_alive_interval_seconds(0),
+    keep_alive_count(0) { }
+};
+
+} // namespace
+}
+
+#endif /* STATICLIB_PION_TCP_SERVER_OPTIONS_HPP */
+
@@ -38,6 +38,7 @@
 
 #include "staticlib/pion/logger.hpp"
 #include "staticlib/pion/http_request.hpp"
+#include "staticlib/pion/shared_buffer.hpp"
 #include "staticlib/pion/tcp_connection.hpp"
 
 namespace staticlib { 
@@ -152,7 +153,7 @@ class websocket {
     };
 
     // IO
-    std::unique_ptr<http_request> request;
+    http_request_ptr request;
     std::shared_ptr<tcp_connection> connection;
 
     // handlers
@@ -167,6 +168,7 @@ class websocket {
     // output state
     std::vector<asio::const_buffer> payload_buffers;
     std::vector<std::unique_ptr<char[]>> payload_cache;
+    std::vector<shared_buffer> payload_shared;
     size_t payload_length = 0;
 
     // input state
@@ -186,7 +188,7 @@ public:
      * @param max_receive_cache_size_bytes max allowed size of the receive buffer, 1MB by default
      * @param max_cached_frames_count max allowed number of continuation frames, 1024 by default
      */
-    websocket(std::unique_ptr<http_request> req, std::shared_ptr<tcp_connection> conn,
+    websocket(http_request_ptr req, std::shared_ptr<tcp_connection> conn,
             std::function<void(std::unique_ptr<websocket>)> open_handler,
             std::function<void(std::unique_ptr<websocket>)> message_handler,
             std::function<void(std::unique_ptr<websocket>)> close_handler,
@@ -229,7 +231,7 @@ public:
      * @return value of `Sec-WebSocket-Key` request handshake header
      */
     const std::string& get_id() {
-        return request->get_header("Sec-WebSocket-Key");
+        return request->get_header(http_message::HEADER_ID_SEC_WEBSOCKET_KEY);
     }
 
     /**
@@ -301,6 +303,20 @@ public:
         }
     }
 
+    /**
+     * Write payload content; the data written is not copied,
+     * a reference to it is kept until the message is sent
+     *
+     * @param data the data to append to the payload content
+     */
+    void write_shared(shared_buffer data) {
+        if (data.size() > 0) {
+            payload_buffers.push_back(asio::buffer(data.data(), data.size()));
+            payload_length += data.size();
+            payload_shared.emplace_back(std::move(data));
+        }
+    }
+
     /**
      * Checks whether specified request is a WebSocket handshake
      */
@@ -308,8 +324,8 @@ public:
         return req.has_header_value("Upgrade", "websocket") &&
                 req.has_header_value("Sec-WebSocket-Version", "13") &&
                 req.has_header_value("Connection", "Upgrade") &&
-                !req.get_header("Host").empty() &&
-                24 == req.get_header("Sec-WebSocket-Key").length();
+                !req.get_header(http_message::HEADER_ID_HOST).empty() &&
+                24 == req.get_header(http_message::HEADER_ID_SEC_WEBSOCKET_KEY).length();
     }
 
     /**
@@ -398,6 +414,28 @@ public:
         }
     }
 
+    /**
+     * Broadcasts the specified message as a WebSocket frame to every specified connection,
+     * message data is not copied, only the frame header is allocated.
+     * 
+     * Thread-safe: may be called concurrently from any thread, the same
+     * interleaving rules apply as for the copying `broadcast`.
+     * 
+     * @param connections list of connections to broadcast
+     * @param msg message to broadcast
+     * @param msg_type frame type (opcode) to use
+     */
+    static void broadcast(std::vector<std::shared_ptr<tcp_connection>>& connections,
+            shared_buffer msg,
+            sl::websocket::frame_type msg_type = sl::websocket::frame_type::text) {
+        auto hbuf = std::array<char, 10>();
+        auto header = sl::websocket::frame::make_header(hbuf, msg_type, msg.size());
+        auto holder = shared_buffer::copy_of(header);
+        for (auto& el : connections) {
+            send_broadcast(std::move(el), holder, msg);
+        }
+    }
+
     /**
      * Sends `close` frame to client and closes the underlying TCP connection
      * 
@@ -451,6 +489,7 @@ private:
         payload_buffers.clear();
         payload_buffers.push_back(asio::buffer(sl::utils::empty_string().data(), 0));
         payload_cache.clear();
+        payload_shared.clear();
         payload_length = 0;
     }
 
@@ -474,7 +513,7 @@ private:
 
     void prepare_handshake() {
         write(sl::websocket::handshake::make_response_line());
-        auto& key = request->get_header("Sec-WebSocket-Key");
+        auto& key = request->get_header(http_message::HEADER_ID_SEC_WEBSOCKET_KEY);
         auto headers = sl::websocket::handshake::make_response_headers(key);
         for (auto& ha : headers) {
             write(ha.first);
@@ -592,6 +631,20 @@ private:
         conn->get_strand().post(std::move(handler));
     }
 
+    static void send_broadcast(std::shared_ptr<tcp_connection> conn,
+            shared_buffer header, shared_buffer msg) {
+        auto handler =
+            [conn, header, msg]() {
+                auto buffers = std::array<asio::const_buffer, 2>{{
+                    asio::buffer(header.data(), header.size()),
+                    asio::buffer(msg.data(), msg.size())
+                }};
+                conn->async_write(buffers,
+                    [header, msg](const std::error_code&, size_t){ /* no-op */ });
+            };
+        conn->get_strand().post(std::move(handler));
+    }
+
     static void consume(std::unique_ptr<websocket> self, sl::io::span<const char> buf) {
         // append incoming data to receive buffer
         if (self->receive_buffer_overflow(buf.size())) {
@@ -0,0 +1,141 @@
+/*
+ * Copyright 2026, alex at staticlibs.net
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   write_arena.hpp
+ * Author: alex
+ *
+ * Created on October 18, 2026, 1:40 AM
+ */
+
+#ifndef STATICLIB_PION_WRITE_ARENA_HPP
+#define STATICLIB_PION_WRITE_ARENA_HPP
+
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "staticlib/config.hpp"
+
+#include "staticlib/pion/content_buffer_pool.hpp"
+
+namespace staticlib {
+namespace pion {
+
+/**
+ * Chain of memory slabs that holds the data copied for the send operations,
+ * memory is taken sequentially and is released all at once with `clear()`;
+ * slabs are taken from the content buffer pool (if set), so the memory
+ * is reused by the following responses without being held by idle connections
+ */
+class write_arena {
+    /**
+     * Pool to take slabs from, slabs are allocated with `new` if null
+     */
+    std::shared_ptr<content_buffer_pool> pool;
+
+    /**
+     * Slabs chain, memory is taken from the last slab, block size
+     * is used as the number of bytes taken
+     */
+    std::vector<content_block> slabs;
+
+public:
+    /**
+     * Size of the regular slab, larger data gets a dedicated slab
+     */
+    static const std::size_t SLAB_SIZE = content_buffer_pool::MIN_CLASS_CAPACITY;
+
+    /**
+     * Constructor, slabs are taken on the first use
+     */
+    write_arena() { }
+
+    /**
+     * Deleted copy constructor
+     */
+    write_arena(const write_arena&) = delete;
+
+    /**
+     * Deleted copy assignment operator
+     */
+    write_arena& operator=(const write_arena&) = delete;
+
+    /**
+     * Sets the pool to take slabs from
+     *
+     * @param pool content buffer pool, may be null
+     */
+    void set_pool(const std::shared_ptr<content_buffer_pool>& pool) {
+        if (pool != this->pool) {
+            this->pool = pool;
+        }
+    }
+
+    /**
+     * Takes a contiguous block of memory from the arena, memory taken
+     * by the subsequent calls follows the previous block when it fits
+     * into the same slab
+     *
+     * @param len number of bytes
+     * @return pointer to the block, valid until `clear()` is called
+     */
+    char* allocate(std::size_t len) {
+        if (!slabs.empty()) {
+            content_block& cur = slabs.back();
+            if (cur.capacity() - cur.size() >= len) {
+                char* res = cur.data() + cur.size();
+                cur.set_size(cur.size() + len);
+                return res;
+            }
+        }
+        std::size_t capacity = SLAB_SIZE;
+        if (len > capacity) {
+            capacity = len;
+        }
+        slabs.emplace_back(content_buffer_pool::acquire(pool, capacity));
+        content_block& cur = slabs.back();
+        cur.set_size(len);
+        return cur.data();
+    }
+
+    /**
+     * Copies the specified data into the arena
+     *
+     * @param data data to copy
+     * @param len data length
+     * @return pointer to copied data, valid until `clear()` is called
+     */
+    char* copy(const char* data, std::size_t len) {
+        char* dest = allocate(len);
+        std::memcpy(dest, data, len);
+        return dest;
+    }
+
+    /**
+     * Returns all the slabs to the pool, invalidates
+     * all the pointers returned
+     */
+    void clear() {
+        slabs.clear();
+    }
+};
+
+} // namespace
+}
+
+#endif /* STATICLIB_PION_WRITE_ARENA_HPP */
+
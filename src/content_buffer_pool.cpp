@@ -0,0 +1,142 @@
+/*
+ * Copyright 2026, alex at staticlibs.net
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   content_buffer_pool.cpp
+ * Author: alex
+ *
+ * Created on October 17, 2026, 9:10 PM
+ */
+
+#include "staticlib/pion/content_buffer_pool.hpp"
+
+namespace staticlib {
+namespace pion {
+
+namespace { // anonymous
+
+const std::size_t MAX_CLASS_CAPACITY = content_buffer_pool::MIN_CLASS_CAPACITY << (content_buffer_pool::CLASSES_COUNT - 1);
+
+// returns CLASSES_COUNT if capacity does not match a size class
+std::size_t class_index(std::size_t capacity) {
+    std::size_t cap = content_buffer_pool::MIN_CLASS_CAPACITY;
+    for (std::size_t i = 0; i < content_buffer_pool::CLASSES_COUNT; i++) {
+        if (cap == capacity) {
+            return i;
+        }
+        cap <<= 1;
+    }
+    return content_buffer_pool::CLASSES_COUNT;
+}
+
+} // namespace
+
+const std::size_t content_buffer_pool::MIN_CLASS_CAPACITY;
+const std::size_t content_buffer_pool::CLASSES_COUNT;
+
+void content_block::reset() STATICLIB_NOEXCEPT {
+    if (nullptr != block_data) {
+        if (nullptr != pool.get()) {
+            pool->release(block_data, block_capacity);
+        } else {
+            delete[] block_data;
+        }
+    }
+    block_data = nullptr;
+    block_size = 0;
+    block_capacity = 0;
+    pool.reset();
+}
+
+content_buffer_pool::content_buffer_pool(std::size_t limit) :
+spare_bytes(0),
+spare_limit(limit) { }
+
+content_block content_buffer_pool::acquire(const std::shared_ptr<content_buffer_pool>& pool,
+        std::size_t capacity) {
+    if (nullptr == pool.get()) {
+        // default-initialized, block is not zero-filled
+        return content_block(new char[capacity + 1], capacity, nullptr);
+    }
+    std::size_t cap = class_capacity(capacity);
+    std::size_t idx = class_index(cap);
+    if (idx < CLASSES_COUNT) {
+        std::lock_guard<std::mutex> guard{pool->mutex};
+        auto& list = pool->spare[idx];
+        if (!list.empty()) {
+            auto data = list.back().release();
+            list.pop_back();
+            pool->spare_bytes -= cap;
+            return content_block(data, cap, pool);
+        }
+    }
+    return content_block(new char[cap + 1], cap, pool);
+}
+
+void content_buffer_pool::release(char* data, std::size_t capacity) STATICLIB_NOEXCEPT {
+    std::unique_ptr<char[]> buf{data};
+    std::size_t idx = class_index(capacity);
+    if (idx >= CLASSES_COUNT) {
+        return;
+    }
+    std::lock_guard<std::mutex> guard{mutex};
+    if (spare_bytes + capacity <= spare_limit.load(std::memory_order_acquire)) {
+        try {
+            spare[idx].emplace_back(std::move(buf));
+            spare_bytes += capacity;
+        } catch (...) {
+            // block is destroyed on exit
+        }
+    }
+    // otherwise block is destroyed on exit
+}
+
+void content_buffer_pool::set_spare_limit(std::size_t limit) {
+    std::lock_guard<std::mutex> guard{mutex};
+    spare_limit.store(limit, std::memory_order_release);
+    // largest blocks are dropped first
+    for (std::size_t i = CLASSES_COUNT; i > 0 && spare_bytes > limit; i--) {
+        auto& list = spare[i - 1];
+        std::size_t cap = MIN_CLASS_CAPACITY << (i - 1);
+        while (!list.empty() && spare_bytes > limit) {
+            list.pop_back();
+            spare_bytes -= cap;
+        }
+    }
+}
+
+std::size_t content_buffer_pool::spare_count() {
+    std::lock_guard<std::mutex> guard{mutex};
+    std::size_t res = 0;
+    for (auto& list : spare) {
+        res += list.size();
+    }
+    return res;
+}
+
+std::size_t content_buffer_pool::class_capacity(std::size_t len) {
+    if (len > MAX_CLASS_CAPACITY) {
+        return len;
+    }
+    std::size_t cap = MIN_CLASS_CAPACITY;
+    while (cap < len) {
+        cap <<= 1;
+    }
+    return cap;
+}
+
+} // namespace
+}
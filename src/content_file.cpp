@@ -0,0 +1,292 @@
+/*
+ * Copyright 2026, alex at staticlibs.net
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   content_file.cpp
+ * Author: alex
+ *
+ * Created on October 17, 2026, 10:05 PM
+ */
+
+#include "staticlib/pion/content_file.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif // NOMINMAX
+#include <windows.h>
+#else // !_WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif // _WIN32
+
+#include "staticlib/support.hpp"
+
+#include "staticlib/pion/pion_exception.hpp"
+
+namespace staticlib {
+namespace pion {
+
+namespace { // anonymous
+
+#ifdef _WIN32
+
+std::string last_error() {
+    return "error code: [" + sl::support::to_string(::GetLastError()) + "]";
+}
+
+OVERLAPPED offset_overlapped(std::size_t offset) {
+    OVERLAPPED ol;
+    std::memset(std::addressof(ol), '\0', sizeof(ol));
+    uint64_t off = static_cast<uint64_t>(offset);
+    ol.Offset = static_cast<DWORD>(off & 0xffffffff);
+    ol.OffsetHigh = static_cast<DWORD>(off >> 32);
+    return ol;
+}
+
+#else // !_WIN32
+
+std::string last_error() {
+    return "error: [" + std::string(::strerror(errno)) + "]";
+}
+
+#endif // _WIN32
+
+} // namespace
+
+#ifdef _WIN32
+
+content_file::content_file(const std::string& directory) :
+handle(INVALID_HANDLE_VALUE),
+mapping_handle(nullptr),
+content_size(0),
+mapped(nullptr),
+mapped_size(0) {
+    std::string dir = directory;
+    if (dir.empty()) {
+        char buf[MAX_PATH + 1];
+        DWORD len = ::GetTempPathA(sizeof(buf), buf);
+        if (0 == len || len > MAX_PATH) {
+            throw pion_exception("Cannot find temporary directory, " + last_error());
+        }
+        dir.assign(buf, len);
+    }
+    char path[MAX_PATH + 1];
+    if (0 == ::GetTempFileNameA(dir.c_str(), "pio", 0, path)) {
+        throw pion_exception("Cannot create temporary file, directory: [" + dir + "], " + last_error());
+    }
+    // file is deleted when the handle is closed
+    handle = ::CreateFileA(path, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_DELETE, nullptr, OPEN_EXISTING,
+            FILE_ATTRIBUTE_TEMPORARY | FILE_FLAG_DELETE_ON_CLOSE, nullptr);
+    if (INVALID_HANDLE_VALUE == handle) {
+        auto err = last_error();
+        ::DeleteFileA(path);
+        throw pion_exception("Cannot open temporary file, path: [" + std::string(path) + "], " + err);
+    }
+}
+
+content_file::~content_file() STATICLIB_NOEXCEPT {
+    unmap();
+    ::CloseHandle(handle);
+}
+
+void content_file::append(const char* data, std::size_t len) {
+    unmap();
+    std::size_t written = 0;
+    while (written < len) {
+        auto ol = offset_overlapped(content_size + written);
+        DWORD chunk = static_cast<DWORD>((std::min)(len - written, static_cast<std::size_t>(1 << 30)));
+        DWORD res = 0;
+        if (!::WriteFile(handle, data + written, chunk, std::addressof(res), std::addressof(ol))) {
+            throw pion_exception("Cannot write temporary file, " + last_error());
+        }
+        written += res;
+    }
+    content_size += len;
+}
+
+char* content_file::map() {
+    if (nullptr != mapped) {
+        return mapped;
+    }
+    // extra zero byte at the end keeps the content null-terminated
+    std::size_t len = content_size + 1;
+    uint64_t len64 = static_cast<uint64_t>(len);
+    LARGE_INTEGER end;
+    end.QuadPart = static_cast<LONGLONG>(len64);
+    if (!::SetFilePointerEx(handle, end, nullptr, FILE_BEGIN) || !::SetEndOfFile(handle)) {
+        throw pion_exception("Cannot resize temporary file, " + last_error());
+    }
+    mapping_handle = ::CreateFileMappingA(handle, nullptr, PAGE_WRITECOPY,
+            static_cast<DWORD>(len64 >> 32), static_cast<DWORD>(len64 & 0xffffffff), nullptr);
+    if (nullptr == mapping_handle) {
+        throw pion_exception("Cannot map temporary file, " + last_error());
+    }
+    void* ptr = ::MapViewOfFile(mapping_handle, FILE_MAP_COPY, 0, 0, len);
+    if (nullptr == ptr) {
+        auto err = last_error();
+        ::CloseHandle(mapping_handle);
+        mapping_handle = nullptr;
+        throw pion_exception("Cannot map temporary file, " + err);
+    }
+    mapped = static_cast<char*>(ptr);
+    mapped_size = len;
+    mapped[content_size] = '\0';
+    return mapped;
+}
+
+std::size_t content_file::read_at(std::size_t offset, char* buf, std::size_t len) const {
+    if (offset >= content_size) {
+        return 0;
+    }
+    auto ol = offset_overlapped(offset);
+    DWORD chunk = static_cast<DWORD>((std::min)((std::min)(len, content_size - offset),
+            static_cast<std::size_t>(1 << 30)));
+    DWORD res = 0;
+    if (!::ReadFile(handle, buf, chunk, std::addressof(res), std::addressof(ol))) {
+        throw pion_exception("Cannot read temporary file, " + last_error());
+    }
+    return static_cast<std::size_t>(res);
+}
+
+void content_file::unmap() STATICLIB_NOEXCEPT {
+    if (nullptr != mapped) {
+        ::UnmapViewOfFile(mapped);
+        ::CloseHandle(mapping_handle);
+        mapped = nullptr;
+        mapping_handle = nullptr;
+        mapped_size = 0;
+    }
+}
+
+#else // !_WIN32
+
+content_file::content_file(const std::string& directory) :
+fd(-1),
+content_size(0),
+mapped(nullptr),
+mapped_size(0) {
+    std::string dir = directory;
+    if (dir.empty()) {
+        const char* tmpdir = std::getenv("TMPDIR");
+        dir = nullptr != tmpdir && '\0' != tmpdir[0] ? tmpdir : "/tmp";
+    }
+    std::string templ = dir + "/pion_content_XXXXXX";
+    std::vector<char> path(templ.begin(), templ.end());
+    path.push_back('\0');
+    fd = ::mkstemp(path.data());
+    if (-1 == fd) {
+        throw pion_exception("Cannot create temporary file, directory: [" + dir + "], " + last_error());
+    }
+    // file is only reachable through the descriptor
+    ::unlink(path.data());
+    ::fcntl(fd, F_SETFD, FD_CLOEXEC);
+}
+
+content_file::~content_file() STATICLIB_NOEXCEPT {
+    unmap();
+    ::close(fd);
+}
+
+void content_file::append(const char* data, std::size_t len) {
+    unmap();
+    std::size_t written = 0;
+    while (written < len) {
+        auto res = ::pwrite(fd, data + written, len - written, static_cast<off_t>(content_size + written));
+        if (-1 == res) {
+            if (EINTR == errno) {
+                continue;
+            }
+            throw pion_exception("Cannot write temporary file, " + last_error());
+        }
+        written += static_cast<std::size_t>(res);
+    }
+    content_size += len;
+}
+
+char* content_file::map() {
+    if (nullptr != mapped) {
+        return mapped;
+    }
+    // extra zero byte at the end keeps the content null-terminated
+    std::size_t len = content_size + 1;
+    if (-1 == ::ftruncate(fd, static_cast<off_t>(len))) {
+        throw pion_exception("Cannot resize temporary file, " + last_error());
+    }
+    void* ptr = ::mmap(nullptr, len, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    if (MAP_FAILED == ptr) {
+        throw pion_exception("Cannot map temporary file, " + last_error());
+    }
+    mapped = static_cast<char*>(ptr);
+    mapped_size = len;
+    mapped[content_size] = '\0';
+    return mapped;
+}
+
+std::size_t content_file::read_at(std::size_t offset, char* buf, std::size_t len) const {
+    if (offset >= content_size) {
+        return 0;
+    }
+    std::size_t to_read = (std::min)(len, content_size - offset);
+    for (;;) {
+        auto res = ::pread(fd, buf, to_read, static_cast<off_t>(offset));
+        if (-1 == res) {
+            if (EINTR == errno) {
+                continue;
+            }
+            throw pion_exception("Cannot read temporary file, " + last_error());
+        }
+        return static_cast<std::size_t>(res);
+    }
+}
+
+void content_file::unmap() STATICLIB_NOEXCEPT {
+    if (nullptr != mapped) {
+        ::munmap(mapped, mapped_size);
+        mapped = nullptr;
+        mapped_size = 0;
+    }
+}
+
+#endif // _WIN32
+
+std::streamsize content_source::read(sl::io::span<char> span) {
+    if (offset >= length) {
+        return std::char_traits<char>::eof();
+    }
+    std::size_t len = (std::min)(span.size(), length - offset);
+    if (nullptr != file) {
+        len = file->read_at(offset, span.data(), len);
+        if (0 == len) {
+            return std::char_traits<char>::eof();
+        }
+    } else {
+        std::memcpy(span.data(), data + offset, len);
+    }
+    offset += len;
+    return static_cast<std::streamsize>(len);
+}
+
+} // namespace
+}
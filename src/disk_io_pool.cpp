@@ -0,0 +1,108 @@
+/*
+ * Copyright 2026, alex at staticlibs.net
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   disk_io_pool.cpp
+ * Author: alex
+ *
+ * Created on October 18, 2026, 3:20 AM
+ */
+
+#include "staticlib/pion/disk_io_pool.hpp"
+
+#include "staticlib/pion/logger.hpp"
+
+namespace staticlib {
+namespace pion {
+
+namespace { // anonymous
+
+const std::string log = "staticlib.pion.disk_io_pool";
+
+} // namespace
+
+disk_io_pool::disk_io_pool(uint32_t threads_count) :
+stopping(false) {
+    threads.reserve(threads_count);
+    for (uint32_t i = 0; i < threads_count; i++) {
+        threads.emplace_back([this] {
+            run();
+        });
+    }
+}
+
+disk_io_pool::~disk_io_pool() STATICLIB_NOEXCEPT {
+    try {
+        stop();
+    } catch (const std::exception& e) {
+        (void) e;
+        STATICLIB_PION_LOG_WARN(log, "Error stopping disk IO threads: " << e.what());
+    }
+}
+
+void disk_io_pool::post(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> guard{mutex};
+        if (stopping) {
+            return;
+        }
+        tasks.emplace_back(std::move(task));
+    }
+    cv.notify_one();
+}
+
+void disk_io_pool::stop() {
+    std::deque<std::function<void()>> dropped;
+    {
+        std::lock_guard<std::mutex> guard{mutex};
+        stopping = true;
+        dropped.swap(tasks);
+    }
+    cv.notify_all();
+    for (auto& th : threads) {
+        if (!th.joinable()) {
+            continue;
+        }
+        if (th.get_id() != std::this_thread::get_id()) {
+            th.join();
+        } else {
+            // pool is stopped from its own task
+            th.detach();
+        }
+    }
+    // dropped tasks are destroyed outside of the lock
+}
+
+void disk_io_pool::run() {
+    for (;;) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock{mutex};
+            cv.wait(lock, [this] {
+                return stopping || !tasks.empty();
+            });
+            if (stopping) {
+                return;
+            }
+            task = std::move(tasks.front());
+            tasks.pop_front();
+        }
+        task();
+    }
+}
+
+} // namespace
+}
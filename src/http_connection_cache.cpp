@@ -0,0 +1,99 @@
+/*
+ * Copyright 2026, alex at staticlibs.net
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   http_connection_cache.cpp
+ * Author: alex
+ *
+ * Created on October 17, 2026, 3:20 PM
+ */
+
+#include "staticlib/pion/http_connection_cache.hpp"
+
+#include "staticlib/pion/http_request_reader.hpp"
+
+namespace staticlib {
+namespace pion {
+
+http_connection_cache::http_connection_cache() :
+reader(nullptr),
+request(nullptr),
+writer(nullptr) { }
+
+http_connection_cache::~http_connection_cache() STATICLIB_NOEXCEPT {
+    delete reader.exchange(nullptr);
+    delete request.exchange(nullptr);
+    delete writer.exchange(nullptr);
+}
+
+std::shared_ptr<http_connection_cache> http_connection_cache::get(tcp_connection& conn) {
+    auto& cache = conn.get_cache();
+    if (nullptr == cache.get()) {
+        cache = std::make_shared<http_connection_cache>();
+    }
+    return std::static_pointer_cast<http_connection_cache>(cache);
+}
+
+std::unique_ptr<http_request_reader> http_connection_cache::take_reader() {
+    return std::unique_ptr<http_request_reader>(reader.exchange(nullptr));
+}
+
+void http_connection_cache::put_reader(std::unique_ptr<http_request_reader> rd) {
+    delete reader.exchange(rd.release());
+}
+
+http_request_ptr http_connection_cache::take_request() {
+    return http_request_ptr(request.exchange(nullptr));
+}
+
+void http_connection_cache::put_request(http_request* req) {
+    delete request.exchange(req);
+}
+
+response_writer_ptr http_connection_cache::take_writer() {
+    return response_writer_ptr(writer.exchange(nullptr));
+}
+
+void http_connection_cache::put_writer(http_response_writer* wr) {
+    delete writer.exchange(wr);
+}
+
+// deleters are defined here to not depend on the cache in the messages headers
+
+void http_request_deleter::operator()(http_request* req) const {
+    auto cache = req->m_connection_cache.lock();
+    if (nullptr != cache.get()) {
+        req->clear();
+        cache->put_request(req);
+    } else {
+        delete req;
+    }
+}
+
+void http_response_writer_deleter::operator()(http_response_writer* wr) const {
+    // writer must not keep its connection while cached
+    auto conn = std::move(wr->tcp_conn);
+    if (nullptr != conn.get() && nullptr != conn->get_cache().get()) {
+        wr->clear();
+        wr->response->clear();
+        static_cast<http_connection_cache*>(conn->get_cache().get())->put_writer(wr);
+    } else {
+        delete wr;
+    }
+}
+
+} // namespace
+}
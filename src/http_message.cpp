@@ -30,6 +30,7 @@
 #include <ctime>
 #include <iostream>
 #include <algorithm>
+#include <array>
 #include <mutex>
 
 #include "asio.hpp"
@@ -72,6 +73,20 @@ const std::string http_message::HEADER_REFERER("Referer");
 const std::string http_message::HEADER_USER_AGENT("User-Agent");
 const std::string http_message::HEADER_X_FORWARDED_FOR("X-Forwarded-For");
 const std::string http_message::HEADER_CLIENT_IP("Client-IP");
+const std::string http_message::HEADER_EXPECT("Expect");
+const std::string http_message::HEADER_UPGRADE("Upgrade");
+const std::string http_message::HEADER_ACCEPT("Accept");
+const std::string http_message::HEADER_ACCEPT_ENCODING("Accept-Encoding");
+const std::string http_message::HEADER_IF_NONE_MATCH("If-None-Match");
+const std::string http_message::HEADER_RANGE("Range");
+const std::string http_message::HEADER_SEC_WEBSOCKET_KEY("Sec-WebSocket-Key");
+const std::string http_message::HEADER_SEC_WEBSOCKET_VERSION("Sec-WebSocket-Version");
+const std::string http_message::HEADER_DATE("Date");
+const std::string http_message::HEADER_ETAG("ETag");
+const std::string http_message::HEADER_IF_RANGE("If-Range");
+const std::string http_message::HEADER_CONTENT_RANGE("Content-Range");
+const std::string http_message::HEADER_ACCEPT_RANGES("Accept-Ranges");
+const std::string http_message::HEADER_VARY("Vary");
 
 // common HTTP content types
 const std::string http_message::CONTENT_TYPE_HTML("text/html");
@@ -93,6 +108,7 @@ const std::string http_message::RESPONSE_MESSAGE_OK("OK");
 const std::string http_message::RESPONSE_MESSAGE_CREATED("Created");
 const std::string http_message::RESPONSE_MESSAGE_ACCEPTED("Accepted");
 const std::string http_message::RESPONSE_MESSAGE_NO_CONTENT("No Content");
+const std::string http_message::RESPONSE_MESSAGE_PARTIAL_CONTENT("Partial Content");
 const std::string http_message::RESPONSE_MESSAGE_FOUND("Found");
 const std::string http_message::RESPONSE_MESSAGE_UNAUTHORIZED("Unauthorized");
 const std::string http_message::RESPONSE_MESSAGE_FORBIDDEN("Forbidden");
@@ -100,6 +116,8 @@ const std::string http_message::RESPONSE_MESSAGE_NOT_FOUND("Not Found");
 const std::string http_message::RESPONSE_MESSAGE_METHOD_NOT_ALLOWED("Method Not Allowed");
 const std::string http_message::RESPONSE_MESSAGE_NOT_MODIFIED("Not Modified");
 const std::string http_message::RESPONSE_MESSAGE_BAD_REQUEST("Bad Request");
+const std::string http_message::RESPONSE_MESSAGE_PAYLOAD_TOO_LARGE("Payload Too Large");
+const std::string http_message::RESPONSE_MESSAGE_RANGE_NOT_SATISFIABLE("Range Not Satisfiable");
 const std::string http_message::RESPONSE_MESSAGE_SERVER_ERROR("Server Error");
 const std::string http_message::RESPONSE_MESSAGE_NOT_IMPLEMENTED("Not Implemented");
 const std::string http_message::RESPONSE_MESSAGE_CONTINUE("Continue");
@@ -109,6 +127,7 @@ const unsigned int http_message::RESPONSE_CODE_OK = 200;
 const unsigned int http_message::RESPONSE_CODE_CREATED = 201;
 const unsigned int http_message::RESPONSE_CODE_ACCEPTED = 202;
 const unsigned int http_message::RESPONSE_CODE_NO_CONTENT = 204;
+const unsigned int http_message::RESPONSE_CODE_PARTIAL_CONTENT = 206;
 const unsigned int http_message::RESPONSE_CODE_FOUND = 302;
 const unsigned int http_message::RESPONSE_CODE_UNAUTHORIZED = 401;
 const unsigned int http_message::RESPONSE_CODE_FORBIDDEN = 403;
@@ -116,6 +135,8 @@ const unsigned int http_message::RESPONSE_CODE_NOT_FOUND = 404;
 const unsigned int http_message::RESPONSE_CODE_METHOD_NOT_ALLOWED = 405;
 const unsigned int http_message::RESPONSE_CODE_NOT_MODIFIED = 304;
 const unsigned int http_message::RESPONSE_CODE_BAD_REQUEST = 400;
+const unsigned int http_message::RESPONSE_CODE_PAYLOAD_TOO_LARGE = 413;
+const unsigned int http_message::RESPONSE_CODE_RANGE_NOT_SATISFIABLE = 416;
 const unsigned int http_message::RESPONSE_CODE_SERVER_ERROR = 500;
 const unsigned int http_message::RESPONSE_CODE_NOT_IMPLEMENTED = 501;
 const unsigned int http_message::RESPONSE_CODE_CONTINUE = 100;
@@ -124,5 +145,155 @@ const unsigned int http_message::RESPONSE_CODE_CONTINUE = 100;
 // see https://groups.google.com/d/msg/mongoose-users/92fD1Elk5m4/Op6fPLZtlrEJ
 const std::string http_message::RESPONSE_FULLMESSAGE_100_CONTINUE("HTTP/1.1 100 Continue\r\n\r\n");
 
+namespace { // anonymous
+
+const std::string log = "staticlib.pion.http_message";
+
+// names of the well-known headers indexed by header_id
+const std::string* const HEADER_NAMES[] = {
+    std::addressof(http_message::STRING_EMPTY),
+    std::addressof(http_message::HEADER_HOST),
+    std::addressof(http_message::HEADER_COOKIE),
+    std::addressof(http_message::HEADER_SET_COOKIE),
+    std::addressof(http_message::HEADER_CONNECTION),
+    std::addressof(http_message::HEADER_CONTENT_TYPE),
+    std::addressof(http_message::HEADER_CONTENT_LENGTH),
+    std::addressof(http_message::HEADER_CONTENT_LOCATION),
+    std::addressof(http_message::HEADER_CONTENT_ENCODING),
+    std::addressof(http_message::HEADER_CONTENT_DISPOSITION),
+    std::addressof(http_message::HEADER_LAST_MODIFIED),
+    std::addressof(http_message::HEADER_IF_MODIFIED_SINCE),
+    std::addressof(http_message::HEADER_TRANSFER_ENCODING),
+    std::addressof(http_message::HEADER_LOCATION),
+    std::addressof(http_message::HEADER_AUTHORIZATION),
+    std::addressof(http_message::HEADER_REFERER),
+    std::addressof(http_message::HEADER_USER_AGENT),
+    std::addressof(http_message::HEADER_X_FORWARDED_FOR),
+    std::addressof(http_message::HEADER_CLIENT_IP),
+    std::addressof(http_message::HEADER_EXPECT),
+    std::addressof(http_message::HEADER_UPGRADE),
+    std::addressof(http_message::HEADER_ACCEPT),
+    std::addressof(http_message::HEADER_ACCEPT_ENCODING),
+    std::addressof(http_message::HEADER_IF_NONE_MATCH),
+    std::addressof(http_message::HEADER_RANGE),
+    std::addressof(http_message::HEADER_SEC_WEBSOCKET_KEY),
+    std::addressof(http_message::HEADER_SEC_WEBSOCKET_VERSION),
+    std::addressof(http_message::HEADER_DATE),
+    std::addressof(http_message::HEADER_ETAG),
+    std::addressof(http_message::HEADER_IF_RANGE),
+    std::addressof(http_message::HEADER_CONTENT_RANGE),
+    std::addressof(http_message::HEADER_ACCEPT_RANGES),
+    std::addressof(http_message::HEADER_VARY)
+};
+
+static_assert(sizeof(HEADER_NAMES) / sizeof(HEADER_NAMES[0]) == http_message::HEADER_ID_COUNT,
+        "Header names must match header identifiers");
+
+const std::size_t HEADER_IDS_TABLE_SIZE = 64;
+
+// perfect hash over the well-known names: length and case-folded
+// first, middle and last chars, coefficients are chosen so that
+// the well-known names do not collide
+std::size_t header_name_hash(const char* name, std::size_t len) {
+    auto fold = [](char ch) {
+        return static_cast<std::size_t>(static_cast<unsigned char>(ch) | 0x20);
+    };
+    return (len + fold(name[0]) + 17 * fold(name[len - 1]) + 4 * fold(name[len / 2])) &
+            (HEADER_IDS_TABLE_SIZE - 1);
+}
+
+std::array<uint8_t, HEADER_IDS_TABLE_SIZE> build_header_ids_table() {
+    std::array<uint8_t, HEADER_IDS_TABLE_SIZE> table;
+    table.fill(http_message::HEADER_ID_UNKNOWN);
+    for (std::size_t id = 1; id < http_message::HEADER_ID_COUNT; id++) {
+        auto& name = *HEADER_NAMES[id];
+        table[header_name_hash(name.data(), name.length())] = static_cast<uint8_t>(id);
+    }
+    return table;
+}
+
+// initialized after the header names, that are defined above in this file
+const std::array<uint8_t, HEADER_IDS_TABLE_SIZE> HEADER_IDS_TABLE = build_header_ids_table();
+
+// header lines written for each send operation
+const char CONNECTION_KEEP_ALIVE_LINE[] = "Connection: Keep-Alive\r\n";
+const char CONNECTION_CLOSE_LINE[] = "Connection: close\r\n";
+const char TRANSFER_ENCODING_CHUNKED_LINE[] = "Transfer-Encoding: chunked\r\n";
+const char CONTENT_LENGTH_PREFIX[] = "Content-Length: ";
+
+template<std::size_t N>
+void append_literal(std::string& head, const char (&literal)[N]) {
+    head.append(literal, N - 1);
+}
+
+void append_decimal(std::string& head, uint64_t value) {
+    char buf[20];
+    std::size_t pos = sizeof(buf);
+    do {
+        buf[--pos] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while (value > 0);
+    head.append(buf + pos, sizeof(buf) - pos);
+}
+
+} // namespace
+
+http_message::header_id http_message::resolve_header_id(const char* name, std::size_t len) {
+    if (0 == len) {
+        return HEADER_ID_UNKNOWN;
+    }
+    uint8_t id = HEADER_IDS_TABLE[header_name_hash(name, len)];
+    if (HEADER_ID_UNKNOWN != id && algorithm::iequals(name, len, *HEADER_NAMES[id])) {
+        return static_cast<header_id>(id);
+    }
+    return HEADER_ID_UNKNOWN;
+}
+
+void http_message::decode_cookie_headers() const {
+    m_cookie_params_pending = false;
+    visit_header_values(HEADER_ID_COOKIE, [this](const std::string& cookie_header) {
+        if (!http_parser::parse_cookie_header(m_cookie_params, cookie_header, false)) {
+            STATICLIB_PION_LOG_WARN(log, "Cookie header parsing failed");
+        }
+    });
+}
+
+void http_message::append_headers(std::string& head, const bool keep_alive, const bool using_chunks) {
+    materialize_headers();
+    bool send_chunked = using_chunks && get_chunks_supported();
+    bool send_length = !using_chunks && !m_do_not_send_content_length;
+    for (headers_type::const_iterator i = m_headers.begin(); i != m_headers.end(); ++i) {
+        auto& name = i->first;
+        if (algorithm::iequals(name.data(), name.length(), HEADER_CONNECTION) ||
+                (send_chunked && algorithm::iequals(name.data(), name.length(), HEADER_TRANSFER_ENCODING)) ||
+                (send_length && algorithm::iequals(name.data(), name.length(), HEADER_CONTENT_LENGTH))) {
+            continue;
+        }
+        head.append(name);
+        head.append(HEADER_NAME_VALUE_DELIMITER);
+        head.append(i->second);
+        head.append(STRING_CRLF);
+    }
+    if (keep_alive) {
+        append_literal(head, CONNECTION_KEEP_ALIVE_LINE);
+    } else {
+        append_literal(head, CONNECTION_CLOSE_LINE);
+    }
+    if (send_chunked) {
+        append_literal(head, TRANSFER_ENCODING_CHUNKED_LINE);
+    } else if (send_length) {
+        append_literal(head, CONTENT_LENGTH_PREFIX);
+        append_decimal(head, get_content_length());
+        head.append(STRING_CRLF);
+    }
+}
+
+const std::string& http_message::get_header_name(header_id id) {
+    if (id >= HEADER_ID_COUNT) {
+        return STRING_EMPTY;
+    }
+    return *HEADER_NAMES[id];
+}
+
 } // namespace
 }
@@ -25,15 +25,25 @@
 
 #include "staticlib/pion/http_parser.hpp"
 
+#include <algorithm>
 #include <cassert>
 #include <cstdlib>
 #include <cstring>
 #include <unordered_map>
 
+#ifdef STATICLIB_PION_SSE42_PARSER
+#ifdef _MSC_VER
+#include <intrin.h>
+#else // !_MSC_VER
+#include <cpuid.h>
+#endif // _MSC_VER
+#endif // STATICLIB_PION_SSE42_PARSER
+
 #include "staticlib/utils.hpp"
 
 #include "staticlib/pion/http_request.hpp"
 #include "staticlib/pion/http_response.hpp"
+#include "staticlib/pion/multipart_parser.hpp"
 
 namespace staticlib { 
 namespace pion {
@@ -42,6 +52,38 @@ namespace { // anonymous
 
 const std::string log = "staticlib.pion.http_parser";
 
+// allowed bytes ranges, delimiters, control and special bytes are left
+// for the state machine, unusual but valid '~' byte in header names too
+const char URI_STEM_RANGES[16] = {'\x21', '\x3E', '\x40', '\x7E', '\x80', '\xFF'};
+const char URI_QUERY_RANGES[16] = {'\x21', '\x7E', '\x80', '\xFF'};
+const char HEADER_NAME_RANGES[16] = {'\x21', '\x21', '\x23', '\x27', '\x2A', '\x2B', '\x2D', '\x2E',
+        '\x30', '\x39', '\x41', '\x5A', '\x5E', '\x7A', '\x7C', '\x7C'};
+const char HEADER_VALUE_RANGES[16] = {'\x09', '\x09', '\x20', '\x7E', '\x80', '\xFF'};
+
+// SIMD scanning is effective only on the longer tokens
+const std::size_t SIMD_MIN_BYTES = 16;
+
+bool detect_sse42() {
+#ifdef STATICLIB_PION_SSE42_PARSER
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 1);
+    return 0 != (info[2] & (1 << 20));
+#else // !_MSC_VER
+    unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+    if (0 == __get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+        return false;
+    }
+    return 0 != (ecx & bit_SSE4_2);
+#endif // _MSC_VER
+#else // !STATICLIB_PION_SSE42_PARSER
+    return false;
+#endif // STATICLIB_PION_SSE42_PARSER
+}
+
+// checked once on startup
+const bool SSE42_SUPPORTED = detect_sse42();
+
 } // namespace
 
 // static members of parser
@@ -97,7 +139,7 @@ sl::support::tribool http_parser::parse(http_message& http_msg, std::error_code&
             // parsing chunked payload content
             case PARSE_CHUNKS:
                 try { // payload_handler may throw
-                    rc = parse_chunks(http_msg.get_chunk_cache(), ec);
+                    rc = parse_chunks(http_msg, ec);
                     total_bytes_parsed += m_bytes_last_read;
                 } catch(const std::exception& e) {
                     (void) e;
@@ -129,7 +171,7 @@ sl::support::tribool http_parser::parse(http_message& http_msg, std::error_code&
             // parsing payload content with no length (until EOF)
             case PARSE_CONTENT_NO_LENGTH:
                 try { // payload_handler may throw
-                    consume_content_as_next_chunk(http_msg.get_chunk_cache());
+                    consume_content_as_next_chunk(http_msg);
                     total_bytes_parsed += m_bytes_last_read;
                 } catch (const std::exception& e) {
                     (void) e;
@@ -171,11 +213,21 @@ sl::support::tribool http_parser::parse_headers(http_message& http_msg,
     //
     const char *read_start_ptr = m_read_ptr;
     m_bytes_last_read = 0;
+    // available bytes are appended to the header block in bulk, tokens are tracked
+    // as offsets into it, so tokens split between reads do not need to be copied
+    const std::size_t block_offset = http_msg.append_header_block(m_read_ptr,
+            static_cast<std::size_t>(m_read_end_ptr - m_read_ptr));
     while (m_read_ptr < m_read_end_ptr) {
 
-        if (m_save_raw_headers)
-            m_raw_headers += *m_read_ptr;
-        
+        if (m_use_simd) {
+            skip_plain_token_bytes();
+            if (m_read_ptr == m_read_end_ptr) {
+                break;
+            }
+        }
+
+        const std::size_t pos = block_offset + static_cast<std::size_t>(m_read_ptr - read_start_ptr);
+
         switch (m_headers_parse_state) {
         case PARSE_METHOD_START:
             // we have not yet started parsing the HTTP method string
@@ -185,24 +237,24 @@ sl::support::tribool http_parser::parse_headers(http_message& http_msg,
                     return false;
                 }
                 m_headers_parse_state = PARSE_METHOD;
-                m_method.erase();
-                m_method.push_back(*m_read_ptr);
+                m_method = token_view(pos);
+                m_method.length += 1;
             }
             break;
 
         case PARSE_METHOD:
             // we have started parsing the HTTP method string
             if (*m_read_ptr == ' ') {
-                m_resource.erase();
+                m_resource = token_view(pos + 1);
                 m_headers_parse_state = PARSE_URI_STEM;
             } else if (!algorithm::is_char(*m_read_ptr) || algorithm::is_control(*m_read_ptr) || algorithm::is_special(*m_read_ptr)) {
                 set_error(ec, ERROR_METHOD_CHAR);
                 return false;
-            } else if (m_method.size() >= METHOD_MAX) {
+            } else if (m_method.length >= METHOD_MAX) {
                 set_error(ec, ERROR_METHOD_SIZE);
                 return false;
             } else {
-                m_method.push_back(*m_read_ptr);
+                m_method.length += 1;
             }
             break;
 
@@ -211,7 +263,7 @@ sl::support::tribool http_parser::parse_headers(http_message& http_msg,
             if (*m_read_ptr == ' ') {
                 m_headers_parse_state = PARSE_HTTP_VERSION_H;
             } else if (*m_read_ptr == '?') {
-                m_query_string.erase();
+                m_query_string = token_view(pos + 1);
                 m_headers_parse_state = PARSE_URI_QUERY;
             } else if (*m_read_ptr == '\r') {
                 http_msg.set_version_major(0);
@@ -224,11 +276,11 @@ sl::support::tribool http_parser::parse_headers(http_message& http_msg,
             } else if (algorithm::is_control(*m_read_ptr)) {
                 set_error(ec, ERROR_URI_CHAR);
                 return false;
-            } else if (m_resource.size() >= RESOURCE_MAX) {
+            } else if (m_resource.length >= RESOURCE_MAX) {
                 set_error(ec, ERROR_URI_SIZE);
                 return false;
             } else {
-                m_resource.push_back(*m_read_ptr);
+                m_resource.length += 1;
             }
             break;
 
@@ -247,11 +299,11 @@ sl::support::tribool http_parser::parse_headers(http_message& http_msg,
             } else if (algorithm::is_control(*m_read_ptr)) {
                 set_error(ec, ERROR_QUERY_CHAR);
                 return false;
-            } else if (m_query_string.size() >= QUERY_STRING_MAX) {
+            } else if (m_query_string.length >= QUERY_STRING_MAX) {
                 set_error(ec, ERROR_QUERY_SIZE);
                 return false;
             } else {
-                m_query_string.push_back(*m_read_ptr);
+                m_query_string.length += 1;
             }
             break;
 
@@ -417,8 +469,7 @@ sl::support::tribool http_parser::parse_headers(http_message& http_msg,
                 if (http_msg.get_version_major() == 0) {
                     STATICLIB_PION_LOG_DEBUG(log, "HTTP 0.9 Simple-Request found");
                     ++m_read_ptr;
-                    m_bytes_last_read = (m_read_ptr - read_start_ptr);
-                    m_bytes_total_read += m_bytes_last_read;
+                    finish_headers_read(http_msg, read_start_ptr, block_offset);
                     return true;
                 } else {
                     m_headers_parse_state = PARSE_HEADER_START;
@@ -428,8 +479,7 @@ sl::support::tribool http_parser::parse_headers(http_message& http_msg,
                 // assume CR only is (incorrectly) being used for line termination
                 // therefore, the message is finished
                 ++m_read_ptr;
-                m_bytes_last_read = (m_read_ptr - read_start_ptr);
-                m_bytes_total_read += m_bytes_last_read;
+                finish_headers_read(http_msg, read_start_ptr, block_offset);
                 return true;
             } else if (*m_read_ptr == '\t' || *m_read_ptr == ' ') {
                 m_headers_parse_state = PARSE_HEADER_WHITESPACE;
@@ -438,8 +488,8 @@ sl::support::tribool http_parser::parse_headers(http_message& http_msg,
                 return false;
             } else {
                 // assume it is the first character for the name of a header
-                m_header_name.erase();
-                m_header_name.push_back(*m_read_ptr);
+                m_header_name = token_view(pos);
+                m_header_name.length += 1;
                 m_headers_parse_state = PARSE_HEADER_NAME;
             }
             break;
@@ -453,8 +503,7 @@ sl::support::tribool http_parser::parse_headers(http_message& http_msg,
                 // assume newline only is (incorrectly) being used for line termination
                 // therefore, the message is finished
                 ++m_read_ptr;
-                m_bytes_last_read = (m_read_ptr - read_start_ptr);
-                m_bytes_total_read += m_bytes_last_read;
+                finish_headers_read(http_msg, read_start_ptr, block_offset);
                 return true;
             } else if (*m_read_ptr == '\t' || *m_read_ptr == ' ') {
                 m_headers_parse_state = PARSE_HEADER_WHITESPACE;
@@ -463,8 +512,8 @@ sl::support::tribool http_parser::parse_headers(http_message& http_msg,
                 return false;
             } else {
                 // assume it is the first character for the name of a header
-                m_header_name.erase();
-                m_header_name.push_back(*m_read_ptr);
+                m_header_name = token_view(pos);
+                m_header_name.length += 1;
                 m_headers_parse_state = PARSE_HEADER_NAME;
             }
             break;
@@ -481,8 +530,8 @@ sl::support::tribool http_parser::parse_headers(http_message& http_msg,
                     return false;
                 }
                 // assume it is the first character for the name of a header
-                m_header_name.erase();
-                m_header_name.push_back(*m_read_ptr);
+                m_header_name = token_view(pos);
+                m_header_name.length += 1;
                 m_headers_parse_state = PARSE_HEADER_NAME;
             }
             break;
@@ -500,8 +549,8 @@ sl::support::tribool http_parser::parse_headers(http_message& http_msg,
                 return false;
             } else {
                 // first character for the name of a header
-                m_header_name.erase();
-                m_header_name.push_back(*m_read_ptr);
+                m_header_name = token_view(pos);
+                m_header_name.length += 1;
                 m_headers_parse_state = PARSE_HEADER_NAME;
             }
             break;
@@ -509,36 +558,39 @@ sl::support::tribool http_parser::parse_headers(http_message& http_msg,
         case PARSE_HEADER_NAME:
             // parsing the name of a header
             if (*m_read_ptr == ':') {
-                m_header_value.erase();
+                m_header_value = token_view(pos + 1);
                 m_headers_parse_state = PARSE_SPACE_BEFORE_HEADER_VALUE;
             } else if (!algorithm::is_char(*m_read_ptr) || algorithm::is_control(*m_read_ptr) || algorithm::is_special(*m_read_ptr)) {
                 set_error(ec, ERROR_HEADER_CHAR);
                 return false;
-            } else if (m_header_name.size() >= HEADER_NAME_MAX) {
+            } else if (m_header_name.length >= HEADER_NAME_MAX) {
                 set_error(ec, ERROR_HEADER_NAME_SIZE);
                 return false;
             } else {
                 // character (not first) for the name of a header
-                m_header_name.push_back(*m_read_ptr);
+                m_header_name.length += 1;
             }
             break;
 
         case PARSE_SPACE_BEFORE_HEADER_VALUE:
             // parsing space character before a header's value
             if (*m_read_ptr == ' ') {
+                m_header_value = token_view(pos + 1);
                 m_headers_parse_state = PARSE_HEADER_VALUE;
             } else if (*m_read_ptr == '\r') {
-                http_msg.add_header(m_header_name, m_header_value);
+                http_msg.add_header_view(m_header_name.offset, m_header_name.length,
+                        m_header_value.offset, m_header_value.length);
                 m_headers_parse_state = PARSE_EXPECTING_NEWLINE;
             } else if (*m_read_ptr == '\n') {
-                http_msg.add_header(m_header_name, m_header_value);
+                http_msg.add_header_view(m_header_name.offset, m_header_name.length,
+                        m_header_value.offset, m_header_value.length);
                 m_headers_parse_state = PARSE_EXPECTING_CR;
             } else if (!algorithm::is_char(*m_read_ptr) || algorithm::is_control(*m_read_ptr) || algorithm::is_special(*m_read_ptr)) {
                 set_error(ec, ERROR_HEADER_CHAR);
                 return false;
             } else {
                 // assume it is the first character for the value of a header
-                m_header_value.push_back(*m_read_ptr);
+                m_header_value.length += 1;
                 m_headers_parse_state = PARSE_HEADER_VALUE;
             }
             break;
@@ -546,10 +598,12 @@ sl::support::tribool http_parser::parse_headers(http_message& http_msg,
         case PARSE_HEADER_VALUE:
             // parsing the value of a header
             if (*m_read_ptr == '\r') {
-                http_msg.add_header(m_header_name, m_header_value);
+                http_msg.add_header_view(m_header_name.offset, m_header_name.length,
+                        m_header_value.offset, m_header_value.length);
                 m_headers_parse_state = PARSE_EXPECTING_NEWLINE;
             } else if (*m_read_ptr == '\n') {
-                http_msg.add_header(m_header_name, m_header_value);
+                http_msg.add_header_view(m_header_name.offset, m_header_name.length,
+                        m_header_value.offset, m_header_value.length);
                 m_headers_parse_state = PARSE_EXPECTING_CR;
             } else if (*m_read_ptr != '\t' && algorithm::is_control(*m_read_ptr)) {
                 // RFC 2616, 2.2 basic Rules.
@@ -560,34 +614,77 @@ sl::support::tribool http_parser::parse_headers(http_message& http_msg,
                 //       doesn't work properly still
                 set_error(ec, ERROR_HEADER_CHAR);
                 return false;
-            } else if (m_header_value.size() >= HEADER_VALUE_MAX) {
+            } else if (m_header_value.length >= HEADER_VALUE_MAX) {
                 set_error(ec, ERROR_HEADER_VALUE_SIZE);
                 return false;
             } else {
                 // character (not first) for the value of a header
-                m_header_value.push_back(*m_read_ptr);
+                m_header_value.length += 1;
             }
             break;
 
         case PARSE_EXPECTING_FINAL_NEWLINE:
             if (*m_read_ptr == '\n') ++m_read_ptr;
-            m_bytes_last_read = (m_read_ptr - read_start_ptr);
-            m_bytes_total_read += m_bytes_last_read;
+            finish_headers_read(http_msg, read_start_ptr, block_offset);
             return true;
 
         case PARSE_EXPECTING_FINAL_CR:
             if (*m_read_ptr == '\r') ++m_read_ptr;
-            m_bytes_last_read = (m_read_ptr - read_start_ptr);
-            m_bytes_total_read += m_bytes_last_read;
+            finish_headers_read(http_msg, read_start_ptr, block_offset);
             return true;
         }
         
         ++m_read_ptr;
     }
 
+    finish_headers_read(http_msg, read_start_ptr, block_offset);
+    return sl::support::indeterminate;
+}
+
+bool http_parser::is_simd_supported() {
+    return SSE42_SUPPORTED;
+}
+
+void http_parser::skip_plain_token_bytes() {
+    switch (m_headers_parse_state) {
+    case PARSE_URI_STEM:
+        skip_allowed_bytes(m_resource, RESOURCE_MAX, URI_STEM_RANGES, 6);
+        break;
+    case PARSE_URI_QUERY:
+        skip_allowed_bytes(m_query_string, QUERY_STRING_MAX, URI_QUERY_RANGES, 4);
+        break;
+    case PARSE_HEADER_NAME:
+        skip_allowed_bytes(m_header_name, HEADER_NAME_MAX, HEADER_NAME_RANGES, 16);
+        break;
+    case PARSE_HEADER_VALUE:
+        skip_allowed_bytes(m_header_value, HEADER_VALUE_MAX, HEADER_VALUE_RANGES, 6);
+        break;
+    default:
+        break;
+    }
+}
+
+void http_parser::skip_allowed_bytes(token_view& token, std::size_t max_length,
+        const char* ranges, int ranges_length) {
+    std::size_t avail = static_cast<std::size_t>(m_read_end_ptr - m_read_ptr);
+    if (avail < SIMD_MIN_BYTES || token.length >= max_length) {
+        return;
+    }
+    std::size_t count = count_allowed_sse42(m_read_ptr, avail, ranges, ranges_length);
+    // token overflow is reported by the state machine on the next byte
+    count = std::min(count, max_length - token.length);
+    m_read_ptr += count;
+    token.length += count;
+}
+
+void http_parser::finish_headers_read(http_message& http_msg, const char* read_start_ptr,
+        std::size_t block_offset) {
     m_bytes_last_read = (m_read_ptr - read_start_ptr);
     m_bytes_total_read += m_bytes_last_read;
-    return sl::support::indeterminate;
+    http_msg.truncate_header_block(block_offset + m_bytes_last_read);
+    if (m_save_raw_headers) {
+        m_raw_headers.append(read_start_ptr, m_bytes_last_read);
+    }
 }
 
 void http_parser::update_message_with_header_data(http_message& http_msg) const
@@ -595,30 +692,17 @@ void http_parser::update_message_with_header_data(http_message& http_msg) const
     // finish an HTTP request message
 
     http_request& req(reinterpret_cast<http_request&>(http_msg));
-    req.set_method(m_method);
-    req.set_resource(m_resource);
-    req.set_query_string(m_query_string);
-
-    // parse query pairs from the URI query string
-    if (! m_query_string.empty()) {
-        if (! parse_url_encoded(req.get_queries(),
-                              m_query_string.c_str(),
-                              m_query_string.size())) {
-            STATICLIB_PION_LOG_WARN(log, "Request query string parsing failed (URI)");
-        }
+    const char* block = req.get_header_block().data();
+    req.set_method(block + m_method.offset, m_method.length);
+    req.set_resource(block + m_resource.offset, m_resource.length);
+    req.set_query_string(block + m_query_string.offset, m_query_string.length);
+
+    // query pairs and "Cookie" headers are decoded on first access
+    if (m_query_string.length > 0) {
+        req.set_query_params_pending();
     }
-
-    // parse "Cookie" headers in request
-    std::pair<std::unordered_multimap<std::string, std::string, algorithm::ihash, algorithm::iequal_to>::const_iterator, std::unordered_multimap<std::string, std::string, algorithm::ihash, algorithm::iequal_to>::const_iterator>
-    cookie_pair = req.get_headers().equal_range(http_message::HEADER_COOKIE);
-    for (std::unordered_multimap<std::string, std::string, algorithm::ihash, algorithm::iequal_to>::const_iterator cookie_iterator = cookie_pair.first;
-         cookie_iterator != req.get_headers().end()
-         && cookie_iterator != cookie_pair.second; ++cookie_iterator)
-    {
-        if (! parse_cookie_header(req.get_cookies(),
-                                cookie_iterator->second, false) ) {
-            STATICLIB_PION_LOG_WARN(log, "Cookie header parsing failed");
-        }
+    if (req.has_header(http_message::HEADER_ID_COOKIE)) {
+        req.set_cookie_params_pending();
     }
 }
 
@@ -628,12 +712,41 @@ sl::support::tribool http_parser::finish_header_parsing(http_message& http_msg,
     m_bytes_content_remaining = m_bytes_content_read = 0;
     http_msg.set_content_length(0);
     http_msg.update_transfer_encoding_using_header();
+    m_bytes_chunks_declared = 0;
     update_message_with_header_data(http_msg);
 
+    // content length is validated before the headers are passed to the hook
+    if (!http_msg.is_chunked() && !http_msg.is_content_length_implied() &&
+            http_msg.has_header(http_message::HEADER_ID_CONTENT_LENGTH)) {
+        try {
+            http_msg.update_content_length_using_header();
+        } catch (...) {
+            STATICLIB_PION_LOG_ERROR(log, "Unable to update content length");
+            set_error(ec, ERROR_INVALID_CONTENT_LENGTH);
+            return false;
+        }
+    }
+
+    finished_parsing_headers(ec, rc);
+    if (ec || !indeterminate(rc)) {
+        return ec ? sl::support::tribool(false) : rc;
+    }
+
+    // limit may be set by the hook
+    if (m_content_limit > 0 && http_msg.get_content_length() > m_content_limit) {
+        set_error(ec, ERROR_CONTENT_TOO_LARGE);
+        return false;
+    }
+
     if (http_msg.is_chunked()) {
 
         // content is encoded using chunks
         m_message_parse_state = PARSE_CHUNKS;
+
+        // chunks are appended to the empty content buffer
+        if (nullptr == m_payload_handler) {
+            http_msg.create_content_buffer();
+        }
         
         // return true if parsing headers only
         if (m_parse_headers_only)
@@ -648,16 +761,9 @@ sl::support::tribool http_parser::finish_header_parsing(http_message& http_msg,
     } else {
         // content length should be specified in the headers
 
-        if (http_msg.has_header(http_message::HEADER_CONTENT_LENGTH)) {
+        if (http_msg.has_header(http_message::HEADER_ID_CONTENT_LENGTH)) {
 
-            // message has a content-length header
-            try {
-                http_msg.update_content_length_using_header();
-            } catch (...) {
-                STATICLIB_PION_LOG_ERROR(log, "Unable to update content length");
-                set_error(ec, ERROR_INVALID_CONTENT_LENGTH);
-                return false;
-            }
+            // message has a content-length header, that is already validated
 
             // check if content-length header == 0
             if (http_msg.get_content_length() == 0) {
@@ -674,7 +780,22 @@ sl::support::tribool http_parser::finish_header_parsing(http_message& http_msg,
                 if (m_parse_headers_only) {
                     // return true if parsing headers only
                     rc = true;
-                } else {
+                } else if (m_content_spill_threshold > 0 && nullptr == m_payload_handler &&
+                        http_msg.get_content_length() > m_content_spill_threshold) {
+                    // large content is written to a temporary file as it arrives
+                    try {
+                        std::size_t content_length = http_msg.get_content_length();
+                        http_msg.set_content_length(0);
+                        http_msg.create_content_buffer();
+                        http_msg.spill_content(m_content_spill_directory);
+                        http_msg.set_content_length(content_length);
+                    } catch (const std::exception& e) {
+                        (void) e;
+                        STATICLIB_PION_LOG_ERROR(log, "Unable to create content file: " << e.what());
+                        set_error(ec, ERROR_CONTENT_FILE);
+                        return false;
+                    }
+                } else if (nullptr == m_payload_handler) {
                     // allocate a buffer for payload content (may be zero-size)
                     http_msg.create_content_buffer();
                 }
@@ -690,8 +811,6 @@ sl::support::tribool http_parser::finish_header_parsing(http_message& http_msg,
         }
     }
 
-    finished_parsing_headers(ec, rc);
-    
     return rc;
 }
     
@@ -851,161 +970,33 @@ bool http_parser::parse_multipart_form_data(std::unordered_multimap<std::string,
     // sanity check
     if (ptr == nullptr || len == 0)
         return true;
-    
-    // parse field boundary
-    std::size_t pos = content_type.find("boundary=");
-    if (pos == std::string::npos)
-        return false;
-    const std::string boundary = std::string("--") + content_type.substr(pos+9);
-    
-    // used to track what we are parsing
-    enum MultiPartParseState {
-        MP_PARSE_START,
-        MP_PARSE_HEADER_CR, MP_PARSE_HEADER_LF,
-        MP_PARSE_HEADER_NAME, MP_PARSE_HEADER_SPACE, MP_PARSE_HEADER_VALUE,
-        MP_PARSE_HEADER_LAST_LF, MP_PARSE_FIELD_DATA
-    } parse_state = MP_PARSE_START;
-
-    // a few variables used for parsing
-    std::string header_name;
-    std::string header_value;
-    std::string field_name;
-    std::string field_value;
-    bool found_parameter = false;
-    bool save_current_field = true;
-    const char * const end_ptr = ptr + len;
-
-    ptr = std::search(ptr, end_ptr, boundary.begin(), boundary.end());
 
-    while (ptr != nullptr && ptr < end_ptr) {
-        switch (parse_state) {
-            case MP_PARSE_START:
-                // start parsing a new field
-                header_name.clear();
-                header_value.clear();
-                field_name.clear();
-                field_value.clear();
-                save_current_field = true;
-                ptr += boundary.size() - 1;
-                parse_state = MP_PARSE_HEADER_CR;
-                break;
-            case MP_PARSE_HEADER_CR:
-                // expecting CR while parsing headers
-                if (*ptr == '\r') {
-                    // got it -> look for linefeed
-                    parse_state = MP_PARSE_HEADER_LF;
-                } else if (*ptr == '\n') {
-                    // got a linefeed? try to ignore and start parsing header
-                    parse_state = MP_PARSE_HEADER_NAME;
-                } else if (*ptr == '-' && ptr+1 < end_ptr && ptr[1] == '-') {
-                    // end of multipart content
-                    return true;
-                } else return false;
-                break;
-            case MP_PARSE_HEADER_LF:
-                // expecting LF while parsing headers
-                if (*ptr == '\n') {
-                    // got it -> start parsing header name
-                    parse_state = MP_PARSE_HEADER_NAME;
-                } else return false;
-                break;
-            case MP_PARSE_HEADER_NAME:
-                // parsing the name of a header
-                if (*ptr == '\r' || *ptr == '\n') {
-                    if (header_name.empty()) {
-                        // got CR or LF at beginning; skip to data
-                        parse_state = (*ptr == '\r' ? MP_PARSE_HEADER_LAST_LF : MP_PARSE_FIELD_DATA);
-                    } else {
-                        // premature CR or LF -> just ignore and start parsing next header
-                        parse_state = (*ptr == '\r' ? MP_PARSE_HEADER_LF : MP_PARSE_HEADER_NAME);
-                    }
-                } else if (*ptr == ':') {
-                    // done parsing header name -> consume space next
-                    parse_state = MP_PARSE_HEADER_SPACE;
-                } else {
-                    // one more byte for header name
-                    header_name += *ptr;
-                }
-                break;
-            case MP_PARSE_HEADER_SPACE:
-                // expecting a space before header value
-                if (*ptr == '\r') {
-                    // premature CR -> just ignore and start parsing next header
-                    parse_state = MP_PARSE_HEADER_LF;
-                } else if (*ptr == '\n') {
-                    // premature LF -> just ignore and start parsing next header
-                    parse_state = MP_PARSE_HEADER_NAME;
-                } else if (*ptr != ' ') {
-                    // not a space -> assume it's a value char
-                    header_value += *ptr;
-                    parse_state = MP_PARSE_HEADER_VALUE;
-                }
-                // otherwise just ignore the space(s)
-                break;
-            case MP_PARSE_HEADER_VALUE:
-                // parsing the value of a header
-                if (*ptr == '\r' || *ptr == '\n') {
-                    // reached the end of the value -> check if it's important
-                    if (sl::utils::iequals(header_name, http_message::HEADER_CONTENT_TYPE)) {
-                        // only keep fields that have a text type or no type
-                        save_current_field = sl::utils::iequals(header_value.substr(0, 5), "text/");
-                    } else if (sl::utils::iequals(header_name, http_message::HEADER_CONTENT_DISPOSITION)) {
-                        // get current field from content-disposition header
-                        std::size_t name_pos = header_value.find("name=\"");
-                        if (name_pos != std::string::npos) {
-                            for (name_pos += 6; name_pos < header_value.size() && header_value[name_pos] != '\"'; ++name_pos) {
-                                field_name += header_value[name_pos];
-                            }
-                        }
-                    }
-                    // clear values and start parsing next header
-                    header_name.clear();
-                    header_value.clear();
-                    parse_state = (*ptr == '\r' ? MP_PARSE_HEADER_LF : MP_PARSE_HEADER_NAME);
-                } else {
-                    // one more byte for header value
-                    header_value += *ptr;
-                }
-                break;
-            case MP_PARSE_HEADER_LAST_LF:
-                // expecting final linefeed to terminate headers and begin field data
-                if (*ptr == '\n') {
-                    // got it
-                    if (save_current_field && !field_name.empty()) {
-                        // parse the field if we care & know enough about it
-                        parse_state = MP_PARSE_FIELD_DATA;
-                    } else {
-                        // otherwise skip ahead to next field
-                        parse_state = MP_PARSE_START;
-                        ptr = std::search(ptr, end_ptr, boundary.begin(), boundary.end());
-                    }
-                } else return false;
-                break;
-            case MP_PARSE_FIELD_DATA:
-                // parsing the value of a field -> find the end of it
-                const char *field_end_ptr = end_ptr;
-                const char *next_ptr = std::search(ptr, end_ptr, boundary.begin(), boundary.end());
-                if (next_ptr) {
-                    // don't include CRLF before next boundary
-                    const char *temp_ptr = next_ptr - 2;
-                    if (temp_ptr[0] == '\r' && temp_ptr[1] == '\n')
-                        field_end_ptr = temp_ptr;
-                    else field_end_ptr = next_ptr;
-                }
-                field_value.assign(ptr, field_end_ptr - ptr);
-                // add the field to the query dictionary
-                dict.insert( std::make_pair(field_name, field_value) );
-                found_parameter = true;
-                // skip ahead to next field
-                parse_state = MP_PARSE_START;
-                ptr = next_ptr;
-                break;
-        }
-        // we've already bumped position if MP_PARSE_START
-        if (parse_state != MP_PARSE_START)
-            ++ptr;
+    bool found_parameter = false;
+    try {
+        multipart_parser parser(content_type, [&dict, &found_parameter](
+                const multipart_parser::headers_type& headers) -> multipart_parser::part_sink_type {
+            // only keep fields that have a text type or no type
+            auto ct = headers.find(http_message::HEADER_CONTENT_TYPE);
+            if (headers.end() != ct && !sl::utils::iequals(ct->second.substr(0, 5), "text/")) {
+                return nullptr;
+            }
+            auto name = multipart_parser::get_disposition_param(headers, "name");
+            if (name.empty()) {
+                return nullptr;
+            }
+            // references to multimap elements are stable, value is appended in place
+            auto it = dict.insert(std::make_pair(std::move(name), std::string()));
+            std::string* value = std::addressof(it->second);
+            found_parameter = true;
+            return [value](const char* data, std::size_t data_len) {
+                value->append(data, data_len);
+            };
+        });
+        parser(ptr, len);
+    } catch (const std::exception& e) {
+        STATICLIB_PION_LOG_DEBUG(log, "Multipart form data parsing error: [" << e.what() << "]");
+        return false;
     }
-    
     return found_parameter;
 }
 
@@ -1140,7 +1131,7 @@ bool http_parser::parse_multipart_form_data(std::unordered_multimap<std::string,
 
 
 
-sl::support::tribool http_parser::parse_chunks(std::vector<char>& chunks, std::error_code& ec) {
+sl::support::tribool http_parser::parse_chunks(http_message& http_msg, std::error_code& ec) {
     //
     // note that tribool may have one of THREE states:
     //
@@ -1156,8 +1147,7 @@ sl::support::tribool http_parser::parse_chunks(std::vector<char>& chunks, std::e
         case PARSE_CHUNK_SIZE_START:
             // we have not yet started parsing the next chunk size
             if (is_hex_digit(*m_read_ptr)) {
-                m_chunk_size_str.erase();
-                m_chunk_size_str.push_back(*m_read_ptr);
+                m_size_of_current_chunk = hex_digit_value(*m_read_ptr);
                 m_chunked_content_parse_state = PARSE_CHUNK_SIZE;
             } else if (*m_read_ptr == ' ' || *m_read_ptr == '\x09' || *m_read_ptr == '\x0D' || *m_read_ptr == '\x0A') {
                 // Ignore leading whitespace.  Technically, the standard probably doesn't allow white space here, 
@@ -1171,7 +1161,10 @@ sl::support::tribool http_parser::parse_chunks(std::vector<char>& chunks, std::e
 
         case PARSE_CHUNK_SIZE:
             if (is_hex_digit(*m_read_ptr)) {
-                m_chunk_size_str.push_back(*m_read_ptr);
+                if (!append_chunk_size_digit(*m_read_ptr)) {
+                    set_error(ec, ERROR_CHUNK_CHAR);
+                    return false;
+                }
             } else if (*m_read_ptr == '\x0D') {
                 m_chunked_content_parse_state = PARSE_EXPECTING_LF_AFTER_CHUNK_SIZE;
             } else if (*m_read_ptr == ' ' || *m_read_ptr == '\x09') {
@@ -1212,11 +1205,26 @@ sl::support::tribool http_parser::parse_chunks(std::vector<char>& chunks, std::e
             // if we see anything other than LF, we can't be certain where the chunk starts.
             if (*m_read_ptr == '\x0A') {
                 m_bytes_read_in_current_chunk = 0;
-                m_size_of_current_chunk = strtol(m_chunk_size_str.c_str(), 0, 16);
                 if (m_size_of_current_chunk == 0) {
                     m_chunked_content_parse_state = PARSE_EXPECTING_FINAL_CR_OR_FOOTERS_AFTER_LAST_CHUNK;
                 } else {
                     m_chunked_content_parse_state = PARSE_CHUNK;
+                    // chunked content is rejected before reading the chunk that exceeds the limit
+                    m_bytes_chunks_declared += m_size_of_current_chunk;
+                    if (m_content_limit > 0 && m_bytes_chunks_declared > m_content_limit) {
+                        set_error(ec, ERROR_CONTENT_TOO_LARGE);
+                        return false;
+                    }
+                    if (nullptr == m_payload_handler) {
+                        // chunk size is known, grow content buffer once for the whole chunk
+                        std::size_t stored = http_msg.get_appended_content_length();
+                        std::size_t avail = m_max_content_length > stored ? m_max_content_length - stored : 0;
+                        std::size_t reserved = stored + (std::min)(avail, m_size_of_current_chunk);
+                        // content that is going to be spilled is not grown in memory
+                        if (0 == m_content_spill_threshold || reserved <= m_content_spill_threshold) {
+                            http_msg.reserve_content(reserved);
+                        }
+                    }
                 }
             } else {
                 set_error(ec, ERROR_CHUNK_CHAR);
@@ -1226,17 +1234,17 @@ sl::support::tribool http_parser::parse_chunks(std::vector<char>& chunks, std::e
 
         case PARSE_CHUNK:
             if (m_bytes_read_in_current_chunk < m_size_of_current_chunk) {
+                // whole span of the chunk that is available is consumed at once
+                const std::size_t bytes_avail = bytes_available();
+                const std::size_t bytes_in_chunk = m_size_of_current_chunk - m_bytes_read_in_current_chunk;
+                const std::size_t len = (bytes_in_chunk > bytes_avail) ? bytes_avail : bytes_in_chunk;
                 if (nullptr != m_payload_handler) {
-                    const std::size_t bytes_avail = bytes_available();
-                    const std::size_t bytes_in_chunk = m_size_of_current_chunk - m_bytes_read_in_current_chunk;
-                    const std::size_t len = (bytes_in_chunk > bytes_avail) ? bytes_avail : bytes_in_chunk;
                     (*m_payload_handler)(m_read_ptr, len);
-                    m_bytes_read_in_current_chunk += len;
-                    if (len > 1) m_read_ptr += (len - 1);
-                } else if (chunks.size() < m_max_content_length) {
-                    chunks.push_back(*m_read_ptr);
-                    m_bytes_read_in_current_chunk++;
+                } else {
+                    store_content(http_msg, m_read_ptr, len);
                 }
+                m_bytes_read_in_current_chunk += len;
+                if (len > 1) m_read_ptr += (len - 1);
             }
             if (m_bytes_read_in_current_chunk == m_size_of_current_chunk) {
                 m_chunked_content_parse_state = PARSE_EXPECTING_CR_AFTER_CHUNK;
@@ -1329,6 +1337,8 @@ sl::support::tribool http_parser::consume_content(http_message& http_msg,
     // make sure content buffer is not already full
     if (nullptr != m_payload_handler) {
         (*m_payload_handler)(m_read_ptr, content_bytes_to_read);
+    } else if (http_msg.is_content_spilled()) {
+        store_content(http_msg, m_read_ptr, content_bytes_to_read);
     } else if (m_bytes_content_read < m_max_content_length) {
         if (m_bytes_content_read + content_bytes_to_read > m_max_content_length) {
             // read would exceed maximum size for content buffer
@@ -1349,7 +1359,7 @@ sl::support::tribool http_parser::consume_content(http_message& http_msg,
     return rc;
 }
 
-std::size_t http_parser::consume_content_as_next_chunk(std::vector<char>& chunks)
+std::size_t http_parser::consume_content_as_next_chunk(http_message& http_msg)
 {
     if (bytes_available() == 0) {
         m_bytes_last_read = 0;
@@ -1360,11 +1370,8 @@ std::size_t http_parser::consume_content_as_next_chunk(std::vector<char>& chunks
             (*m_payload_handler)(m_read_ptr, m_bytes_last_read);
             m_read_ptr += m_bytes_last_read;
         } else {
-            while (m_read_ptr < m_read_end_ptr) {
-                if (chunks.size() < m_max_content_length)
-                    chunks.push_back(*m_read_ptr);
-                ++m_read_ptr;
-            }
+            store_content(http_msg, m_read_ptr, m_bytes_last_read);
+            m_read_ptr += m_bytes_last_read;
         }
         m_bytes_total_read += m_bytes_last_read;
         m_bytes_content_read += m_bytes_last_read;
@@ -1372,6 +1379,21 @@ std::size_t http_parser::consume_content_as_next_chunk(std::vector<char>& chunks
     return m_bytes_last_read;
 }
 
+void http_parser::store_content(http_message& http_msg, const char* data, std::size_t len) {
+    // data over the max content length is skipped
+    std::size_t stored = http_msg.get_appended_content_length();
+    if (stored >= m_max_content_length) {
+        return;
+    }
+    std::size_t to_store = (std::min)(len, m_max_content_length - stored);
+    if (m_content_spill_threshold > 0 && stored + to_store > m_content_spill_threshold &&
+            !http_msg.is_content_spilled()) {
+        STATICLIB_PION_LOG_DEBUG(log, "Moving content to a temporary file, length: [" << (stored + to_store) << "]");
+        http_msg.spill_content(m_content_spill_directory);
+    }
+    http_msg.append_content(data, to_store);
+}
+
 void http_parser::finish(http_message& http_msg) const
 {
     switch (m_message_parse_state) {
@@ -1410,29 +1432,8 @@ void http_parser::finish(http_message& http_msg) const
     compute_msg_status(http_msg, http_msg.is_valid());
 
     if (nullptr == m_payload_handler && !m_parse_headers_only) {
-        // Parse query pairs from post content if content type is x-www-form-urlencoded.
-        // Type could be followed by parameters (as defined in section 3.6 of RFC 2616)
-        // e.g. Content-Type: application/x-www-form-urlencoded; charset=UTF-8
-        http_request& req(reinterpret_cast<http_request&>(http_msg));
-        const std::string& content_type_header = req.get_header(http_message::HEADER_CONTENT_TYPE);
-        if (content_type_header.compare(0, http_message::CONTENT_TYPE_URLENCODED.length(),
-                                        http_message::CONTENT_TYPE_URLENCODED) == 0)
-        {
-            if (! parse_url_encoded(req.get_queries(),
-                                  req.get_content(),
-                                  req.get_content_length())) {
-                STATICLIB_PION_LOG_WARN(log, "Request form data parsing failed (POST urlencoded)");
-            }
-        } else if (content_type_header.compare(0, http_message::CONTENT_TYPE_MULTIPART_FORM_DATA.length(),
-                                               http_message::CONTENT_TYPE_MULTIPART_FORM_DATA) == 0)
-        {
-            if (! parse_multipart_form_data(req.get_queries(),
-                                            content_type_header,
-                                            req.get_content(),
-                                            req.get_content_length())) {
-                STATICLIB_PION_LOG_WARN(log, "Request form data parsing failed (POST multipart)");
-            }
-        }
+        // query pairs from url-encoded or multipart content are decoded on first access
+        reinterpret_cast<http_request&>(http_msg).set_form_params_pending();
     }
 }
 
@@ -1489,6 +1490,10 @@ std::string http_parser::error_category_t::message(int ev) const {
         return "missing chunk data";
     case ERROR_MISSING_TOO_MUCH_CONTENT:
         return "missing too much content";
+    case ERROR_CONTENT_FILE:
+        return "unable to store content in a temporary file";
+    case ERROR_CONTENT_TOO_LARGE:
+        return "content length exceeds the limit";
     }
     return "parser error";
 }
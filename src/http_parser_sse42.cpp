@@ -0,0 +1,68 @@
+/*
+ * Copyright 2026, alex at staticlibs.net
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   http_parser_sse42.cpp
+ * Author: alex
+ *
+ * Created on October 17, 2026, 5:10 PM
+ */
+
+#include "staticlib/pion/http_parser.hpp"
+
+#ifdef STATICLIB_PION_SSE42_PARSER
+#include <nmmintrin.h>
+#endif // STATICLIB_PION_SSE42_PARSER
+
+// SSE4.2 code is kept in a separate file and is compiled for the SSE4.2 target
+// only in this function, the rest of the library does not require SSE4.2
+#if defined(STATICLIB_PION_SSE42_PARSER) && (defined(__GNUC__) || defined(__clang__))
+#define STATICLIB_PION_TARGET_SSE42 __attribute__((target("sse4.2")))
+#else
+#define STATICLIB_PION_TARGET_SSE42
+#endif
+
+namespace staticlib {
+namespace pion {
+
+STATICLIB_PION_TARGET_SSE42
+std::size_t http_parser::count_allowed_sse42(const char* data, std::size_t len,
+        const char* ranges, int ranges_length) {
+#ifdef STATICLIB_PION_SSE42_PARSER
+    const __m128i ranges_vec = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ranges));
+    std::size_t count = 0;
+    while (len - count >= 16) {
+        const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + count));
+        // index of the first byte outside of all ranges, 16 if all bytes are allowed
+        int idx = _mm_cmpestri(ranges_vec, ranges_length, block, 16,
+                _SIDD_UBYTE_OPS | _SIDD_CMP_RANGES | _SIDD_NEGATIVE_POLARITY | _SIDD_LEAST_SIGNIFICANT);
+        count += static_cast<std::size_t>(idx);
+        if (16 != idx) {
+            break;
+        }
+    }
+    return count;
+#else // !STATICLIB_PION_SSE42_PARSER
+    (void) data;
+    (void) len;
+    (void) ranges;
+    (void) ranges_length;
+    return 0;
+#endif // STATICLIB_PION_SSE42_PARSER
+}
+
+} // namespace
+}
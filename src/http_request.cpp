@@ -0,0 +1,65 @@
+/*
+ * Copyright 2026, alex at staticlibs.net
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   http_request.cpp
+ * Author: alex
+ *
+ * Created on October 17, 2026, 7:40 PM
+ */
+
+#include "staticlib/pion/http_request.hpp"
+
+#include "staticlib/pion/logger.hpp"
+
+namespace staticlib {
+namespace pion {
+
+namespace { // anonymous
+
+const std::string log = "staticlib.pion.http_request";
+
+} // namespace
+
+void http_request::decode_query_params() const {
+    // query string parameters go first, same as with the eager decoding
+    if (m_query_params_pending) {
+        m_query_params_pending = false;
+        if (!http_parser::parse_url_encoded(m_query_params, m_query_string)) {
+            STATICLIB_PION_LOG_WARN(log, "Request query string parsing failed (URI)");
+        }
+    }
+    if (m_form_params_pending) {
+        m_form_params_pending = false;
+        // type could be followed by parameters (as defined in section 3.6 of RFC 2616)
+        // e.g. Content-Type: application/x-www-form-urlencoded; charset=UTF-8
+        const std::string& content_type = get_header(HEADER_ID_CONTENT_TYPE);
+        if (0 == content_type.compare(0, CONTENT_TYPE_URLENCODED.length(), CONTENT_TYPE_URLENCODED)) {
+            if (!http_parser::parse_url_encoded(m_query_params, get_content(), get_content_length())) {
+                STATICLIB_PION_LOG_WARN(log, "Request form data parsing failed (POST urlencoded)");
+            }
+        } else if (0 == content_type.compare(0, CONTENT_TYPE_MULTIPART_FORM_DATA.length(),
+                CONTENT_TYPE_MULTIPART_FORM_DATA)) {
+            if (!http_parser::parse_multipart_form_data(m_query_params, content_type,
+                    get_content(), get_content_length())) {
+                STATICLIB_PION_LOG_WARN(log, "Request form data parsing failed (POST multipart)");
+            }
+        }
+    }
+}
+
+} // namespace
+}
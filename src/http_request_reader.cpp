@@ -16,8 +16,11 @@
 
 #include "staticlib/pion/http_request_reader.hpp"
 
+#include <algorithm>
+
 #include "asio.hpp"
 
+#include "staticlib/pion/http_connection_cache.hpp"
 #include "staticlib/pion/http_server.hpp"
 
 namespace staticlib { 
@@ -31,6 +34,19 @@ const std::string log = "staticlib.pion.http_request_reader";
 
 // reader member functions
 
+void http_request_reader::reset(tcp_connection_ptr& conn, uint32_t read_timeout,
+        std::size_t max_read) {
+    http_parser::reset();
+    tcp_conn = conn;
+    read_timeout_millis = read_timeout;
+    has_deadline = false;
+    max_read_size = max_read;
+    body_read_size = tcp_connection::READ_BUFFER_SIZE;
+    last_read_size = tcp_connection::READ_BUFFER_SIZE;
+    routes.reset();
+    prepare_request();
+}
+
 void http_request_reader::receive(std::unique_ptr<http_request_reader> self) {
     if (self->tcp_conn->is_pipelined()) {
         // there are pipelined messages available in the connection's read buffer
@@ -48,14 +64,19 @@ void http_request_reader::consume_bytes(std::unique_ptr<http_request_reader> sel
         const std::error_code& read_error, std::size_t bytes_read) {
     if (read_error) {
         // a read error occured
-        self->handle_read_error(read_error);
+        handle_read_error(std::move(self), read_error);
         return;
     }
 
     STATICLIB_PION_LOG_DEBUG(log, "Read " << bytes_read << " bytes from HTTP request");
 
+    // grow the body reads while they fill the whole buffer
+    if (bytes_read >= self->last_read_size && self->body_read_size < self->max_read_size) {
+        self->body_read_size = std::min(self->body_read_size * 2, self->max_read_size);
+    }
+
     // set pointers for new HTTP header data to be consumed
-    self->set_read_buffer(self->tcp_conn->get_read_buffer().data(), bytes_read);
+    self->set_read_buffer(self->tcp_conn->get_read_data(), bytes_read);
 
     consume_bytes(std::move(self));
 }
@@ -102,13 +123,13 @@ void http_request_reader::consume_bytes(std::unique_ptr<http_request_reader> sel
         }
 
         // we have finished parsing the HTTP message
-        self->finished_reading(ec);
+        finished_reading(std::move(self), ec);
 
     } else if (result == false) {
         // the message is invalid or an error occured
         self->tcp_conn->set_lifecycle(tcp_connection::lifecycle::close); // make sure it will get closed
         self->request->set_is_valid(false);
-        self->finished_reading(ec);
+        finished_reading(std::move(self), ec);
     } else {
         // not yet finished parsing the message -> read more data
         read_bytes_with_timeout(std::move(self));
@@ -119,7 +140,13 @@ void http_request_reader::read_bytes_with_timeout(std::unique_ptr<http_request_r
     // setup timer
     auto& timer = self->tcp_conn->get_timer();
     auto& strand = self->tcp_conn->get_strand();
-    timer.expires_from_now(std::chrono::milliseconds(self->read_timeout_millis));
+    auto timeout = std::chrono::milliseconds(self->read_timeout_millis);
+    if (self->has_deadline) {
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+                self->deadline - std::chrono::steady_clock::now());
+        timeout = (std::max)(std::chrono::milliseconds(0), (std::min)(timeout, remaining));
+    }
+    timer.expires_from_now(timeout);
     auto conn = self->tcp_conn;
     auto timeout_handler =
         [conn] (const std::error_code& ec) {
@@ -129,6 +156,10 @@ void http_request_reader::read_bytes_with_timeout(std::unique_ptr<http_request_r
         };
     auto timeout_handler_stranded = strand.wrap(std::move(timeout_handler));
     // setup read
+    std::size_t read_size = self->next_read_size();
+    self->last_read_size = read_size;
+    // nothing of the next request is received yet
+    bool between_messages = self->is_parsing_not_started();
     auto self_shared = sl::support::make_shared_with_release_deleter(self.release());
     auto read_handler =
         [self_shared](const std::error_code& ec, std::size_t bytes_read) {
@@ -143,24 +174,50 @@ void http_request_reader::read_bytes_with_timeout(std::unique_ptr<http_request_r
             }
         };
     auto read_handler_standed = strand.wrap(std::move(read_handler));
-    // fire
-    conn->async_read_some(std::move(read_handler_standed));
+    // fire, timer is armed first, otherwise the read can complete on another
+    // thread before the timer is set and the connection is kept until the timeout
     timer.async_wait(std::move(timeout_handler_stranded));
+    conn->async_read_some(read_size, std::move(read_handler_standed), between_messages);
+}
+
+std::size_t http_request_reader::next_read_size() {
+    if (!is_parsing_content() || body_read_size <= tcp_connection::READ_BUFFER_SIZE) {
+        return tcp_connection::READ_BUFFER_SIZE;
+    }
+    // do not read past the end of content with a known length
+    std::size_t remaining = get_content_bytes_remaining();
+    if (remaining > tcp_connection::READ_BUFFER_SIZE && remaining < body_read_size) {
+        return remaining;
+    }
+    return body_read_size;
+}
+
+void http_request_reader::prepare_request() {
+    auto cache = http_connection_cache::get(*tcp_conn);
+    request = cache->take_request();
+    if (nullptr == request.get()) {
+        request.reset(new http_request());
+        request->set_connection_cache(cache);
+    }
+    request->set_remote_ip(tcp_conn->get_remote_ip());
+    request->set_content_buffer_pool(tcp_conn->get_content_buffer_pool());
+    request->set_request_reader(this);
 }
 
-void http_request_reader::handle_read_error(const std::error_code& read_error) {
+void http_request_reader::handle_read_error(std::unique_ptr<http_request_reader> self,
+        const std::error_code& read_error) {
     // close the connection, forcing the client to establish a new one
-    tcp_conn->set_lifecycle(tcp_connection::lifecycle::close); // make sure it will get closed
+    self->tcp_conn->set_lifecycle(tcp_connection::lifecycle::close); // make sure it will get closed
 
     // check if this is just a message with unknown content length
-    if (!check_premature_eof(*request)) {
+    if (!self->check_premature_eof(*self->request)) {
         std::error_code ec; // clear error code
-        finished_reading(ec);
+        finished_reading(std::move(self), ec);
         return;
     }
 
     // only log errors if the parsing has already begun
-    if (get_total_bytes_read() > 0) {
+    if (self->get_total_bytes_read() > 0) {
         if (read_error == asio::error::operation_aborted) {
             // if the operation was aborted, the acceptor was stopped,
             // which means another thread is shutting-down the server
@@ -170,15 +227,24 @@ void http_request_reader::handle_read_error(const std::error_code& read_error) {
         }
     }
 
-    finished_reading(read_error);
+    finished_reading(std::move(self), read_error);
 }
 
-void http_request_reader::finished_parsing_headers(const std::error_code& ec, sl::support::tribool& rc) {
-    server.handle_request_after_headers_parsed(request, tcp_conn, ec, rc);
+void http_request_reader::finished_parsing_headers(std::error_code& ec, sl::support::tribool& rc) {
+    server.handle_request_after_headers_parsed(*this, request, tcp_conn, ec, rc);
 }
 
-void http_request_reader::finished_reading(const std::error_code& ec) {
-    server.handle_request(std::move(request), tcp_conn, ec);
+void http_request_reader::finished_reading(std::unique_ptr<http_request_reader> self,
+        const std::error_code& ec) {
+    auto& srv = self->server;
+    auto request = std::move(self->request);
+    request->set_request_reader(nullptr);
+    auto conn = std::move(self->tcp_conn);
+    auto table = std::move(self->routes);
+    // reader is cached before the request is handled, so the next
+    // request over this connection can reuse it
+    http_connection_cache::get(*conn)->put_reader(std::move(self));
+    srv.handle_request(std::move(request), conn, ec, std::move(table));
 }
 
 } // namespace
@@ -0,0 +1,228 @@
+/*
+ * Copyright 2026, alex at staticlibs.net
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   http_response.cpp
+ * Author: alex
+ *
+ * Created on October 18, 2026, 12:50 AM
+ */
+
+#include "staticlib/pion/http_response.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+
+namespace staticlib {
+namespace pion {
+
+namespace { // anonymous
+
+// precomputed status lines of the common responses, messages
+// must match the response messages defined in http_message
+const std::string STATUS_LINE_100("HTTP/1.1 100 Continue\r\n");
+const std::string STATUS_LINE_200("HTTP/1.1 200 OK\r\n");
+const std::string STATUS_LINE_201("HTTP/1.1 201 Created\r\n");
+const std::string STATUS_LINE_202("HTTP/1.1 202 Accepted\r\n");
+const std::string STATUS_LINE_204("HTTP/1.1 204 No Content\r\n");
+const std::string STATUS_LINE_206("HTTP/1.1 206 Partial Content\r\n");
+const std::string STATUS_LINE_301("HTTP/1.1 301 Moved Permanently\r\n");
+const std::string STATUS_LINE_302("HTTP/1.1 302 Found\r\n");
+const std::string STATUS_LINE_304("HTTP/1.1 304 Not Modified\r\n");
+const std::string STATUS_LINE_400("HTTP/1.1 400 Bad Request\r\n");
+const std::string STATUS_LINE_401("HTTP/1.1 401 Unauthorized\r\n");
+const std::string STATUS_LINE_403("HTTP/1.1 403 Forbidden\r\n");
+const std::string STATUS_LINE_404("HTTP/1.1 404 Not Found\r\n");
+const std::string STATUS_LINE_405("HTTP/1.1 405 Method Not Allowed\r\n");
+const std::string STATUS_LINE_413("HTTP/1.1 413 Payload Too Large\r\n");
+const std::string STATUS_LINE_416("HTTP/1.1 416 Range Not Satisfiable\r\n");
+const std::string STATUS_LINE_500("HTTP/1.1 500 Server Error\r\n");
+const std::string STATUS_LINE_501("HTTP/1.1 501 Not Implemented\r\n");
+const std::string STATUS_LINE_503("HTTP/1.1 503 Service Unavailable\r\n");
+
+// "HTTP/1.1 200 " prefix and CRLF
+const std::size_t STATUS_LINE_PREFIX_LENGTH = 13;
+const std::size_t STATUS_LINE_OVERHEAD = STATUS_LINE_PREFIX_LENGTH + 2;
+
+const char* const DAY_NAMES[] = {"Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat"};
+const char* const MONTH_NAMES[] = {"Jan", "Feb", "Mar", "Apr", "May", "Jun",
+        "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"};
+
+// "Sun, 06 Nov 1994 08:49:37 GMT"
+const std::size_t HTTP_DATE_LENGTH = 29;
+
+// "Date: Sun, 06 Nov 1994 08:49:37 GMT\r\n"
+const std::size_t DATE_LINE_LENGTH = HTTP_DATE_LENGTH + 8;
+
+// "Date" header line, shared by all the connections and formatted
+// at most once per second, published with a sequence lock stored in
+// atomic words, so the responses never wait for each other
+const std::size_t DATE_LINE_WORDS = (DATE_LINE_LENGTH + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+std::atomic<uint32_t> date_seq(0);
+std::atomic<std::time_t> date_second(0);
+std::array<std::atomic<uint64_t>, DATE_LINE_WORDS> date_words;
+std::atomic_flag date_publishing = ATOMIC_FLAG_INIT;
+
+const std::string* find_status_line(unsigned int code) {
+    switch (code) {
+    case 100: return std::addressof(STATUS_LINE_100);
+    case 200: return std::addressof(STATUS_LINE_200);
+    case 201: return std::addressof(STATUS_LINE_201);
+    case 202: return std::addressof(STATUS_LINE_202);
+    case 204: return std::addressof(STATUS_LINE_204);
+    case 206: return std::addressof(STATUS_LINE_206);
+    case 301: return std::addressof(STATUS_LINE_301);
+    case 302: return std::addressof(STATUS_LINE_302);
+    case 304: return std::addressof(STATUS_LINE_304);
+    case 400: return std::addressof(STATUS_LINE_400);
+    case 401: return std::addressof(STATUS_LINE_401);
+    case 403: return std::addressof(STATUS_LINE_403);
+    case 404: return std::addressof(STATUS_LINE_404);
+    case 405: return std::addressof(STATUS_LINE_405);
+    case 413: return std::addressof(STATUS_LINE_413);
+    case 416: return std::addressof(STATUS_LINE_416);
+    case 500: return std::addressof(STATUS_LINE_500);
+    case 501: return std::addressof(STATUS_LINE_501);
+    case 503: return std::addressof(STATUS_LINE_503);
+    default: return nullptr;
+    }
+}
+
+void write_two_digits(char* dest, int value) {
+    dest[0] = static_cast<char>('0' + value / 10);
+    dest[1] = static_cast<char>('0' + value % 10);
+}
+
+// IMF-fixdate from RFC 7231, formatted without locale-dependent "strftime"
+void format_http_date(std::time_t t, char* p) {
+    std::tm tm;
+#ifdef _WIN32
+    gmtime_s(std::addressof(tm), std::addressof(t));
+#else // !_WIN32
+    gmtime_r(std::addressof(t), std::addressof(tm));
+#endif // _WIN32
+    std::memcpy(p, DAY_NAMES[tm.tm_wday], 3);
+    std::memcpy(p + 3, ", ", 2);
+    write_two_digits(p + 5, tm.tm_mday);
+    p[7] = ' ';
+    std::memcpy(p + 8, MONTH_NAMES[tm.tm_mon], 3);
+    p[11] = ' ';
+    int year = tm.tm_year + 1900;
+    write_two_digits(p + 12, year / 100);
+    write_two_digits(p + 14, year % 100);
+    p[16] = ' ';
+    write_two_digits(p + 17, tm.tm_hour);
+    p[19] = ':';
+    write_two_digits(p + 20, tm.tm_min);
+    p[22] = ':';
+    write_two_digits(p + 23, tm.tm_sec);
+    std::memcpy(p + 25, " GMT", 4);
+}
+
+void format_date_line(std::time_t t, char* p) {
+    std::memcpy(p, "Date: ", 6);
+    format_http_date(t, p + 6);
+    std::memcpy(p + 6 + HTTP_DATE_LENGTH, "\r\n", 2);
+}
+
+// returns false if the line is being published by other thread
+bool publish_date_line(std::time_t now) {
+    if (date_publishing.test_and_set(std::memory_order_acquire)) {
+        return false;
+    }
+    if (now != date_second.load(std::memory_order_relaxed)) {
+        std::array<uint64_t, DATE_LINE_WORDS> words;
+        words.fill(0);
+        format_date_line(now, reinterpret_cast<char*>(words.data()));
+        auto seq = date_seq.load(std::memory_order_relaxed);
+        date_seq.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (std::size_t i = 0; i < DATE_LINE_WORDS; i++) {
+            date_words[i].store(words[i], std::memory_order_relaxed);
+        }
+        date_seq.store(seq + 2, std::memory_order_release);
+        date_second.store(now, std::memory_order_release);
+    }
+    date_publishing.clear(std::memory_order_release);
+    return true;
+}
+
+void append_date_line(std::string& head) {
+    auto now = std::time(nullptr);
+    std::array<uint64_t, DATE_LINE_WORDS> words;
+    if (now != date_second.load(std::memory_order_acquire) && !publish_date_line(now)) {
+        // rare case, other thread is formatting the line for the new second
+        format_date_line(now, reinterpret_cast<char*>(words.data()));
+        head.append(reinterpret_cast<const char*>(words.data()), DATE_LINE_LENGTH);
+        return;
+    }
+    for (;;) {
+        auto seq = date_seq.load(std::memory_order_acquire);
+        if (0 == (seq & 1)) {
+            for (std::size_t i = 0; i < DATE_LINE_WORDS; i++) {
+                words[i] = date_words[i].load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (seq == date_seq.load(std::memory_order_relaxed)) {
+                break;
+            }
+        }
+    }
+    head.append(reinterpret_cast<const char*>(words.data()), DATE_LINE_LENGTH);
+}
+
+} // namespace
+
+std::string http_response::make_http_date(std::time_t t) {
+    std::array<char, HTTP_DATE_LENGTH> buf;
+    format_http_date(t, buf.data());
+    return std::string(buf.data(), buf.size());
+}
+
+void http_response::set_last_modified(const unsigned long t) {
+    change_header(HEADER_LAST_MODIFIED, make_http_date(static_cast<std::time_t>(t)));
+}
+
+void http_response::serialize_head(std::string& head, const bool keep_alive, const bool using_chunks) {
+    const std::string* line = nullptr;
+    if (1 == get_version_major() && 1 == get_version_minor()) {
+        line = find_status_line(status_code);
+        if (nullptr != line && 0 != line->compare(STATUS_LINE_PREFIX_LENGTH,
+                line->length() - STATUS_LINE_OVERHEAD, status_message)) {
+            line = nullptr;
+        }
+    }
+    if (nullptr != line) {
+        head.append(*line);
+    } else {
+        head.append(get_first_line());
+        head.append(STRING_CRLF);
+    }
+    append_headers(head, keep_alive, using_chunks);
+    if (raw_headers.size() > 0) {
+        head.append(raw_headers.data(), raw_headers.size());
+    }
+    if (get_header(HEADER_ID_DATE).empty()) {
+        append_date_line(head);
+    }
+    head.append(STRING_CRLF);
+}
+
+} // namespace
+}
@@ -0,0 +1,388 @@
+/*
+ * Copyright 2026, alex at staticlibs.net
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   http_response_writer.cpp
+ * Author: alex
+ *
+ * Created on October 18, 2026, 3:40 AM
+ */
+
+#include "staticlib/pion/http_response_writer.hpp"
+
+#include <array>
+#include <cerrno>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif // WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <io.h>
+#else // !_WIN32
+#include <unistd.h>
+#endif // _WIN32
+
+#include "staticlib/pion/content_buffer_pool.hpp"
+#include "staticlib/pion/disk_io_pool.hpp"
+
+namespace staticlib {
+namespace pion {
+
+namespace { // anonymous
+
+const std::string log = "staticlib.pion.http_response_writer";
+
+// size of each of the two buffers used to read the file
+const std::size_t FILE_BUFFER_SIZE = 65536;
+
+void close_file(int fd) {
+#ifdef _WIN32
+    _close(fd);
+#else // !_WIN32
+    ::close(fd);
+#endif // _WIN32
+}
+
+// positional read, does not move the file offset, so reads
+// into both buffers can run concurrently
+std::size_t read_file(int fd, uint64_t offset, char* buf, std::size_t len, std::error_code& ec) {
+    std::size_t total = 0;
+    while (total < len) {
+#ifdef _WIN32
+        auto handle = reinterpret_cast<HANDLE>(_get_osfhandle(fd));
+        OVERLAPPED ov;
+        std::memset(std::addressof(ov), '\0', sizeof(ov));
+        uint64_t pos = offset + total;
+        ov.Offset = static_cast<DWORD>(pos & 0xffffffff);
+        ov.OffsetHigh = static_cast<DWORD>(pos >> 32);
+        DWORD count = 0;
+        if (!ReadFile(handle, buf + total, static_cast<DWORD>(len - total), std::addressof(count), std::addressof(ov))) {
+            DWORD err = GetLastError();
+            if (ERROR_HANDLE_EOF != err) {
+                ec = std::error_code(static_cast<int>(err), std::system_category());
+                return total;
+            }
+        }
+        auto res = static_cast<long long>(count);
+#else // !_WIN32
+        auto res = static_cast<long long>(::pread(fd, buf + total, len - total,
+                static_cast<off_t>(offset + total)));
+        if (res < 0) {
+            if (EINTR == errno) {
+                continue;
+            }
+            ec = std::error_code(errno, std::system_category());
+            return total;
+        }
+#endif // _WIN32
+        if (0 == res) {
+            ec = asio::error::eof;
+            return total;
+        }
+        total += static_cast<std::size_t>(res);
+    }
+    return total;
+}
+
+} // namespace
+
+/**
+ * State of the file being sent by the writer, all the state except
+ * the buffer contents is accessed only on the connection strand
+ */
+class file_transfer : public std::enable_shared_from_this<file_transfer> {
+    /**
+     * State of the read buffer
+     */
+    enum class buffer_state {
+        free, reading, full
+    };
+
+    /**
+     * Writer that sends the file, it is finished when the transfer is completed
+     */
+    response_writer_ptr writer;
+
+    /**
+     * Connection used to send the file
+     */
+    tcp_connection_ptr conn;
+
+    /**
+     * File descriptor, closed on destruction
+     */
+    int fd;
+
+    /**
+     * Offset of the next byte to read
+     */
+    uint64_t read_offset;
+
+    /**
+     * Number of bytes not yet requested to be read
+     */
+    uint64_t read_remaining;
+
+    /**
+     * Number of bytes not yet written to the connection
+     */
+    uint64_t write_remaining;
+
+    /**
+     * Number of bytes written, including the response head
+     */
+    std::size_t bytes_written;
+
+    /**
+     * Read buffers, taken from the content buffer pool of the connection
+     */
+    std::array<content_block, 2> buffers;
+
+    /**
+     * States of the read buffers
+     */
+    std::array<buffer_state, 2> states;
+
+    /**
+     * Index of the buffer to be written next
+     */
+    std::size_t write_idx;
+
+    /**
+     * True while the write to the connection is in progress
+     */
+    bool writing;
+
+    /**
+     * True if the writer was already finished
+     */
+    bool finished;
+
+public:
+    /**
+     * Constructor
+     *
+     * @param writer writer that sends the file
+     * @param fd file descriptor
+     * @param offset offset of the first byte to send
+     * @param length number of bytes to send
+     */
+    file_transfer(response_writer_ptr writer, int fd, uint64_t offset, uint64_t length) :
+    writer(std::move(writer)),
+    conn(this->writer->get_connection()),
+    fd(fd),
+    read_offset(offset),
+    read_remaining(length),
+    write_remaining(length),
+    bytes_written(0),
+    write_idx(0),
+    writing(false),
+    finished(false) {
+        states.fill(buffer_state::free);
+    }
+
+    /**
+     * Destructor, closes the file
+     */
+    ~file_transfer() STATICLIB_NOEXCEPT {
+        close_file(fd);
+    }
+
+    /**
+     * Deleted copy constructor
+     */
+    file_transfer(const file_transfer&) = delete;
+
+    /**
+     * Deleted copy assignment operator
+     */
+    file_transfer& operator=(const file_transfer&) = delete;
+
+    /**
+     * Sends the response head and buffered data, then the file
+     */
+    void start() {
+        auto self = shared_from_this();
+        writer->send_more_data(false, [self](const std::error_code& ec, std::size_t bytes) {
+            self->bytes_written += bytes;
+            if (ec) {
+                self->finish(ec);
+            } else {
+                self->send_body();
+            }
+        });
+    }
+
+private:
+    /**
+     * Sends the file data after the response head was sent
+     */
+    void send_body() {
+        if (0 == write_remaining || !writer->get_response().is_body_allowed()) {
+            finish(std::error_code());
+            return;
+        }
+#if defined(__linux__) && !defined(STATICLIB_PION_DISABLE_SSL)
+        bool use_sendfile = !conn->get_ssl_flag();
+#elif defined(__linux__)
+        bool use_sendfile = true;
+#else // !__linux__
+        bool use_sendfile = false;
+#endif // __linux__
+        if (use_sendfile) {
+#ifdef __linux__
+            auto self = shared_from_this();
+            auto handler = conn->get_strand().wrap([self](const std::error_code& ec, std::size_t bytes) {
+                self->bytes_written += bytes;
+                self->finish(ec);
+            });
+            conn->async_sendfile(fd, read_offset, static_cast<std::size_t>(write_remaining), std::move(handler));
+#endif // __linux__
+            return;
+        }
+        // double buffering, next block is read while the previous one is sent
+        for (std::size_t i = 0; i < buffers.size() && read_remaining > 0; i++) {
+            read_block(i);
+        }
+    }
+
+    /**
+     * Reads the next block of the file into the specified buffer
+     *
+     * @param idx buffer index
+     */
+    void read_block(std::size_t idx) {
+        auto& buf = buffers[idx];
+        if (nullptr == buf.data()) {
+            buf = content_buffer_pool::acquire(conn->get_content_buffer_pool(), FILE_BUFFER_SIZE);
+        }
+        std::size_t len = read_remaining < FILE_BUFFER_SIZE ? static_cast<std::size_t>(read_remaining) : FILE_BUFFER_SIZE;
+        uint64_t offset = read_offset;
+        read_offset += len;
+        read_remaining -= len;
+        states[idx] = buffer_state::reading;
+        auto pool = conn->get_disk_io_pool();
+        if (nullptr == pool) {
+            std::error_code ec;
+            buf.set_size(read_file(fd, offset, buf.data(), len, ec));
+            handle_read(idx, ec);
+            return;
+        }
+        auto self = shared_from_this();
+        pool->post([self, idx, offset, len] {
+            std::error_code ec;
+            auto& buf = self->buffers[idx];
+            buf.set_size(read_file(self->fd, offset, buf.data(), len, ec));
+            self->conn->get_strand().post([self, idx, ec] {
+                self->handle_read(idx, ec);
+            });
+        });
+    }
+
+    /**
+     * Called on the strand after the block was read
+     *
+     * @param idx buffer index
+     * @param ec read error
+     */
+    void handle_read(std::size_t idx, const std::error_code& ec) {
+        if (ec) {
+            STATICLIB_PION_LOG_WARN(log, "File read error, code: [" << ec.value() << "]," <<
+                    " message: [" << ec.message() << "]");
+            finish(ec);
+            return;
+        }
+        states[idx] = buffer_state::full;
+        write_block();
+    }
+
+    /**
+     * Writes the next full buffer to the connection,
+     * if no write is in progress
+     */
+    void write_block() {
+        if (finished || writing || buffer_state::full != states[write_idx]) {
+            return;
+        }
+        writing = true;
+        auto& buf = buffers[write_idx];
+        auto self = shared_from_this();
+        auto handler = conn->get_strand().wrap([self](const std::error_code& ec, std::size_t bytes) {
+            self->handle_write(ec, bytes);
+        });
+        conn->async_write(asio::buffer(buf.data(), buf.size()), std::move(handler));
+    }
+
+    /**
+     * Called on the strand after the buffer was written
+     *
+     * @param ec write error
+     * @param bytes number of bytes written
+     */
+    void handle_write(const std::error_code& ec, std::size_t bytes) {
+        writing = false;
+        bytes_written += bytes;
+        if (ec) {
+            finish(ec);
+            return;
+        }
+        std::size_t written_idx = write_idx;
+        write_remaining -= buffers[written_idx].size();
+        states[written_idx] = buffer_state::free;
+        if (0 == write_remaining) {
+            finish(ec);
+            return;
+        }
+        // index is advanced before the read, as without disk IO pool
+        // the block is read (and the next write is started) synchronously
+        write_idx = (write_idx + 1) % buffers.size();
+        if (read_remaining > 0) {
+            read_block(written_idx);
+        }
+        write_block();
+    }
+
+    /**
+     * Finishes the writer, connection is closed on error
+     *
+     * @param ec error
+     */
+    void finish(const std::error_code& ec) {
+        if (finished) {
+            return;
+        }
+        finished = true;
+        if (ec) {
+            conn->set_lifecycle(tcp_connection::lifecycle::close);
+        }
+        http_response_writer::handle_write(std::move(writer), ec, bytes_written);
+    }
+};
+
+void http_response_writer::send_file(response_writer_ptr self, int fd, uint64_t offset, uint64_t length) {
+    if (self->sending_chunks) {
+        close_file(fd);
+        throw pion_exception("Invalid 'send_file' call for the chunked response");
+    }
+    // response content length includes the data written before
+    self->content_length += static_cast<std::size_t>(length);
+    auto transfer = std::make_shared<file_transfer>(std::move(self), fd, offset, length);
+    transfer->start();
+}
+
+} // namespace
+}
@@ -25,16 +25,19 @@
 
 #include <algorithm>
 #include <functional>
+#include <limits>
+#include <memory>
 #include <stdexcept>
 #include <tuple>
 
+#include "staticlib/pion/http_connection_cache.hpp"
 #include "staticlib/pion/http_request_reader.hpp"
 #include "staticlib/pion/http_response_writer.hpp"
 #include "staticlib/pion/pion_exception.hpp"
 
-#ifdef STATICLIB_PION_USE_SSL
+#ifndef STATICLIB_PION_DISABLE_SSL
 #include "openssl/ssl.h"
-#endif
+#endif // STATICLIB_PION_DISABLE_SSL
 
 namespace staticlib { 
 namespace pion {
@@ -69,6 +72,16 @@ T& choose_map_by_method(const std::string& method, T& get_map, T& post_map, T& p
     } 
 }
 
+response_writer_ptr make_response_writer(tcp_connection_ptr& conn, const http_request& request) {
+    auto writer = http_connection_cache::get(*conn)->take_writer();
+    if (nullptr != writer.get()) {
+        writer->reset(conn, request);
+    } else {
+        writer.reset(new http_response_writer(conn, request));
+    }
+    return writer;
+}
+
 http_server::websocket_map_type& choose_ws_map(const std::string& event,
         http_server::websocket_map_type& open_map,
         http_server::websocket_map_type& message_map,
@@ -96,6 +109,18 @@ void handle_bad_request(http_request_ptr, response_writer_ptr resp) {
     resp->send(std::move(resp));
 }
 
+void handle_payload_too_large(http_request_ptr, response_writer_ptr resp) {
+    static const std::string PAYLOAD_TOO_LARGE_MSG = R"({
+    "code": 413,
+    "message": "Payload Too Large",
+    "description": "The request content is larger than the server is willing to process."
+})";
+    resp->get_response().set_status_code(http_message::RESPONSE_CODE_PAYLOAD_TOO_LARGE);
+    resp->get_response().set_status_message(http_message::RESPONSE_MESSAGE_PAYLOAD_TOO_LARGE);
+    resp->write_nocopy(PAYLOAD_TOO_LARGE_MSG);
+    resp->send(std::move(resp));
+}
+
 void handle_not_found_request(http_request_ptr request, response_writer_ptr resp) {
     static const std::string NOT_FOUND_MSG_START = R"({
     "code": 404,
@@ -118,26 +143,56 @@ void handle_root_options(http_request_ptr, response_writer_ptr resp) {
     resp->send(std::move(resp));
 }
 
-template<typename T>
-typename T::iterator find_submatch(T& map, const std::string& path) {
-    std::string st{path};
-    auto end = map.end();
-    std::string::size_type slash_ind = st.length();
-    do {
-        // todo: fixme
-        st = st.substr(0, slash_ind);
-        auto it = map.find(st);
-        if (end != it) {
-            return it;
-        }
-        slash_ind = st.find_last_of("/");
-    } while(std::string::npos != slash_ind);
-    return end;
+template<typename Router, typename T>
+void add_route(Router& router, const std::string& method, const std::string& resource, const T& value) {
+    try {
+        router.add(resource, value);
+    } catch (const pion_exception& e) {
+        throw pion_exception(std::string(e.what()) + ", method: [" + method + "]");
+    }
+}
+
+template<typename T, typename Publisher>
+void add_definition(std::map<std::pair<std::string, std::string>, T>& definitions,
+        const std::string& method, std::string resource, T value, const std::string& duplicate_msg,
+        Publisher publish) {
+    auto key = std::make_pair(method, std::move(resource));
+    auto it = definitions.emplace(key, std::move(value));
+    if (!it.second) {
+        throw pion_exception(duplicate_msg + ": [" + key.second + "], method: [" + method + "]");
+    }
+    try {
+        publish();
+    } catch (...) {
+        definitions.erase(it.first);
+        throw;
+    }
+}
+
+void invoke_handler(const http_server::request_handler_type& handler, http_request_ptr request,
+        response_writer_ptr writer) {
+    try {
+        handler(std::move(request), std::move(writer));
+    } catch (std::bad_alloc&) {
+        // propagate memory errors (FATAL)
+        throw;
+    } catch (std::exception& e) {
+        // log exception from handler, but do not try to notify client
+        // because response is consumed by handler (and its state is indeterminate)
+        STATICLIB_PION_LOG_ERROR(log, "HTTP request handler: " << e.what());
+    }
+}
+
+std::size_t path_length(const std::string& resource) {
+    if (!resource.empty() && '/' == resource[resource.length() - 1]) {
+        return resource.length() - 1;
+    }
+    return resource.length();
 }
 
 std::tuple<bool, websocket_handler_type, websocket_handler_type, websocket_handler_type>
-find_ws_handlers(const std::string& path, http_server::websocket_map_type& open_map,
-        http_server::websocket_map_type& message_map, http_server::websocket_map_type& close_map) {
+find_ws_handlers(const std::string& path, const http_server::websocket_map_type& open_map,
+        const http_server::websocket_map_type& message_map, const http_server::websocket_map_type& close_map) {
     auto it_open = open_map.find(path);
     auto has_open = open_map.end() != it_open;
     auto it_message = message_map.find(path);
@@ -192,6 +247,7 @@ std::vector<std::shared_ptr<tcp_connection>> find_ws_conns(
 
 } // namespace
 
+#ifndef STATICLIB_PION_DISABLE_SSL
 http_server::http_server(uint32_t number_of_threads, uint16_t port,
         asio::ip::address_v4 ip_address,
         uint32_t read_timeout_millis,
@@ -203,54 +259,124 @@ http_server::http_server(uint32_t number_of_threads, uint16_t port,
 tcp_server(asio::ip::tcp::endpoint(ip_address, port), number_of_threads),
 read_timeout(read_timeout_millis),
 bad_request_handler(handle_bad_request),
-not_found_handler(handle_not_found_request) {
+not_found_handler(handle_not_found_request),
+routes(std::make_shared<route_table>()) {
     if (!ssl_key_file.empty()) {
-        this->ssl_flag = true;
-        this->ssl_context.set_options(asio::ssl::context::default_workarounds
+        this->ssl_context.reset(new tcp_connection::ssl_context_type(asio::ssl::context::sslv23));
+        this->ssl_context->set_options(asio::ssl::context::default_workarounds
                 | asio::ssl::context::no_compression
                 | asio::ssl::context::no_sslv2
                 | asio::ssl::context::single_dh_use);
-        this->ssl_context.set_password_callback(ssl_key_password_callback);
-        this->ssl_context.use_certificate_file(ssl_key_file, asio::ssl::context::pem);
-        this->ssl_context.use_private_key_file(ssl_key_file, asio::ssl::context::pem);
+        // OpenSSL frees record buffers of the idle connections
+        SSL_CTX_set_mode(ssl_context->native_handle(), SSL_MODE_RELEASE_BUFFERS);
+        this->ssl_context->set_password_callback(ssl_key_password_callback);
+        this->ssl_context->use_certificate_file(ssl_key_file, asio::ssl::context::pem);
+        this->ssl_context->use_private_key_file(ssl_key_file, asio::ssl::context::pem);
         if (!ssl_verify_file.empty()) {
-            this->ssl_context.load_verify_file(ssl_verify_file);
-            this->ssl_context.set_verify_callback(ssl_verify_callback);
-            this->ssl_context.set_verify_mode(asio::ssl::verify_peer | asio::ssl::verify_fail_if_no_peer_cert);
+            this->ssl_context->load_verify_file(ssl_verify_file);
+            this->ssl_context->set_verify_callback(ssl_verify_callback);
+            this->ssl_context->set_verify_mode(asio::ssl::verify_peer | asio::ssl::verify_fail_if_no_peer_cert);
             // https://www.openssl.org/docs/manmaster/ssl/SSL_CTX_set_session_id_context.html#WARNINGS
 //            SSL_CTX_set_session_cache_mode(m_ssl_context.native_handle(), SSL_SESS_CACHE_OFF);
-            SSL_CTX_set_session_id_context(ssl_context.native_handle(), reinterpret_cast<const unsigned char*>("pion"), 4);
+            SSL_CTX_set_session_id_context(ssl_context->native_handle(), reinterpret_cast<const unsigned char*>("pion"), 4);
         }
     }
 }
+#else // STATICLIB_PION_DISABLE_SSL
+http_server::http_server(uint32_t number_of_threads, uint16_t port,
+        asio::ip::address_v4 ip_address,
+        uint32_t read_timeout_millis) :
+tcp_server(asio::ip::tcp::endpoint(ip_address, port), number_of_threads),
+read_timeout(read_timeout_millis),
+bad_request_handler(handle_bad_request),
+not_found_handler(handle_not_found_request),
+routes(std::make_shared<route_table>()) { }
+#endif // STATICLIB_PION_DISABLE_SSL
 
 void http_server::add_handler(const std::string& method,
-        const std::string& resource, request_handler_type request_handler) {
-    handlers_map_type& map = choose_map_by_method(method, get_handlers, post_handlers, put_handlers, 
-            delete_handlers, options_handlers);
+        const std::string& resource, request_handler_type request_handler, route_policy policy) {
     auto clean_resource = strip_trailing_slash(resource);
     STATICLIB_PION_LOG_DEBUG(log, "Adding handler for HTTP resource: [" << clean_resource << "], method: [" << method << "]");
-    auto it = map.emplace(clean_resource, std::move(request_handler));
-    if (!it.second) throw pion_exception("Invalid duplicate handler path: [" + clean_resource + "], method: [" + method + "]");
+    handler_route route;
+    route.handler = std::move(request_handler);
+    route.policy = std::move(policy);
+    std::lock_guard<std::mutex> guard{routes_mtx};
+    add_definition(handler_definitions, method, std::move(clean_resource), std::move(route),
+            "Invalid duplicate handler path", [this] { publish_routes(); });
 }
 
 void http_server::add_payload_handler(const std::string& method, const std::string& resource,
         payload_handler_creator_type payload_handler) {
-    payloads_map_type& map = choose_map_by_method(method, get_payloads, post_payloads, put_payloads, 
-            delete_payloads, options_payloads);
     auto clean_resource = strip_trailing_slash(resource);
     STATICLIB_PION_LOG_DEBUG(log, "Adding payload handler for HTTP resource: [" << clean_resource << "], method: [" << method << "]");
-    auto it = map.emplace(clean_resource, std::move(payload_handler));
-    if (!it.second) throw pion_exception("Invalid duplicate payload path: [" + clean_resource + "], method: [" + method + "]");
+    std::lock_guard<std::mutex> guard{routes_mtx};
+    add_definition(payload_definitions, method, std::move(clean_resource), std::move(payload_handler),
+            "Invalid duplicate payload path", [this] { publish_routes(); });
 }
 
 void http_server::add_websocket_handler(const std::string& event, const std::string& resource, 
         websocket_handler_type handler) {
-    auto& map = choose_ws_map(event, wsopen_handlers, wsmessage_handlers, wsclose_handlers);
     auto clean_resource = strip_trailing_slash(resource);
     STATICLIB_PION_LOG_DEBUG(log, "Adding WebSocket handler for resource: [" << clean_resource << "], event: [" << event << "]");
-    auto it = map.emplace(std::move(clean_resource), std::move(handler));
-    if (!it.second) throw pion_exception("Invalid duplicate WebSocket path: [" + clean_resource + "], event: [" + event + "]");
+    std::lock_guard<std::mutex> guard{routes_mtx};
+    add_definition(websocket_definitions, event, std::move(clean_resource), std::move(handler),
+            "Invalid duplicate WebSocket path", [this] { publish_routes(); });
+}
+
+bool http_server::remove_handler(const std::string& method, const std::string& resource) {
+    auto clean_resource = strip_trailing_slash(resource);
+    STATICLIB_PION_LOG_DEBUG(log, "Removing handler for HTTP resource: [" << clean_resource << "], method: [" << method << "]");
+    std::lock_guard<std::mutex> guard{routes_mtx};
+    if (0 == handler_definitions.erase(std::make_pair(method, clean_resource))) {
+        return false;
+    }
+    publish_routes();
+    return true;
+}
+
+bool http_server::remove_payload_handler(const std::string& method, const std::string& resource) {
+    auto clean_resource = strip_trailing_slash(resource);
+    STATICLIB_PION_LOG_DEBUG(log, "Removing payload handler for HTTP resource: [" << clean_resource << "], method: [" << method << "]");
+    std::lock_guard<std::mutex> guard{routes_mtx};
+    if (0 == payload_definitions.erase(std::make_pair(method, clean_resource))) {
+        return false;
+    }
+    publish_routes();
+    return true;
+}
+
+bool http_server::remove_websocket_handler(const std::string& event, const std::string& resource) {
+    auto clean_resource = strip_trailing_slash(resource);
+    STATICLIB_PION_LOG_DEBUG(log, "Removing WebSocket handler for resource: [" << clean_resource << "], event: [" << event << "]");
+    std::lock_guard<std::mutex> guard{routes_mtx};
+    if (0 == websocket_definitions.erase(std::make_pair(event, clean_resource))) {
+        return false;
+    }
+    publish_routes();
+    return true;
+}
+
+void http_server::publish_routes() {
+    auto table = std::make_shared<route_table>();
+    for (auto& en : handler_definitions) {
+        auto& method = en.first.first;
+        auto& router = choose_map_by_method(method, table->get_handlers, table->post_handlers,
+                table->put_handlers, table->delete_handlers, table->options_handlers);
+        add_route(router, method, en.first.second, en.second);
+    }
+    for (auto& en : payload_definitions) {
+        auto& method = en.first.first;
+        auto& router = choose_map_by_method(method, table->get_payloads, table->post_payloads,
+                table->put_payloads, table->delete_payloads, table->options_payloads);
+        add_route(router, method, en.first.second, en.second);
+    }
+    for (auto& en : websocket_definitions) {
+        auto& map = choose_ws_map(en.first.first, table->wsopen_handlers, table->wsmessage_handlers,
+                table->wsclose_handlers);
+        map.emplace(en.first.second, en.second);
+    }
+    std::shared_ptr<const route_table> published = std::move(table);
+    std::atomic_store(std::addressof(routes), std::move(published));
 }
 
 void http_server::broadcast_websocket(const std::string& path, sl::io::span<const char> message,
@@ -265,42 +391,76 @@ void http_server::broadcast_websocket(const std::string& path, sl::io::span<cons
 }
 
 void http_server::handle_connection(tcp_connection_ptr& conn) {
-    auto reader = sl::support::make_unique<http_request_reader>(*this, conn, read_timeout);
+    auto reader = http_connection_cache::get(*conn)->take_reader();
+    if (nullptr != reader.get()) {
+        reader->reset(conn, read_timeout, options.max_read_size);
+    } else {
+        reader = sl::support::make_unique<http_request_reader>(*this, conn, read_timeout,
+                options.max_read_size);
+    }
+    reader->set_max_content_length(static_cast<std::size_t>((std::min)(options.max_content_length,
+            static_cast<uint64_t>(std::numeric_limits<std::size_t>::max()))));
+    reader->set_content_spill(options.content_spill_threshold, options.content_spill_directory);
     reader->receive(std::move(reader));
     // reader is consumed at this point
 }
 
-void http_server::handle_request_after_headers_parsed(http_request_ptr& request,
-        tcp_connection_ptr& conn, const std::error_code& ec, sl::support::tribool& rc) {
+void http_server::handle_request_after_headers_parsed(http_request_reader& reader, http_request_ptr& request,
+        tcp_connection_ptr& conn, std::error_code& ec, sl::support::tribool& rc) {
     if (ec || !rc) return;
+    // snapshot is kept by the reader and passed to handle_request() with the request
+    auto table = get_routes();
+    reader.set_routes(table);
+    auto& resource = request->get_resource();
+    // policy of the request handler is applied before the body is read
+    auto& handlers = choose_map_by_method(request->get_method(), table->get_handlers, table->post_handlers,
+            table->put_handlers, table->delete_handlers, table->options_handlers);
+    auto route = handlers.find(resource.data(), path_length(resource), request->get_path_params());
+    bool send_continue = true;
+    if (nullptr != route) {
+        auto& policy = route->policy;
+        send_continue = policy.send_continue;
+        if (policy.read_timeout_millis > 0) {
+            reader.set_read_timeout(policy.read_timeout_millis);
+        }
+        if (policy.request_deadline_millis > 0) {
+            reader.set_request_deadline(policy.request_deadline_millis);
+        }
+        if (policy.max_content_length > 0) {
+            // "Content-Length" is validated by parser at this point
+            if (request->get_content_length() > policy.max_content_length) {
+                STATICLIB_PION_LOG_INFO(log, "Content length exceeds the limit: [" << policy.max_content_length << "]," <<
+                        " resource: [" << resource << "]");
+                ec = std::error_code(static_cast<int>(http_parser::ERROR_CONTENT_TOO_LARGE),
+                        http_parser::get_error_category());
+                rc = false;
+                return;
+            }
+            // chunked bodies and bodies passed to payload handlers are counted by parser
+            reader.set_content_limit(policy.max_content_length);
+            reader.set_max_content_length(static_cast<std::size_t>((std::min)(policy.max_content_length,
+                    static_cast<uint64_t>(std::numeric_limits<std::size_t>::max()))));
+        }
+    }
     // http://stackoverflow.com/a/17390776/314015
-    if (sl::utils::iequals("100-continue", request->get_header("Expect"))) {
+    if (send_continue && sl::utils::iequals("100-continue", request->get_header(http_message::HEADER_ID_EXPECT))) {
         conn->async_write(asio::buffer(http_message::RESPONSE_FULLMESSAGE_100_CONTINUE),
                 [](const std::error_code&, std::size_t){ /* no-op */ });
     }
     auto& method = request->get_method();
-    payloads_map_type& map = choose_map_by_method(method, get_payloads, post_payloads, put_payloads, 
-            delete_payloads, options_payloads);
-    std::string path{strip_trailing_slash(request->get_resource())};
-    auto it = find_submatch(map, path);
-    if (map.end() != it) {
-        auto ha = it->second(request);
+    auto& router = choose_map_by_method(method, table->get_payloads, table->post_payloads,
+            table->put_payloads, table->delete_payloads, table->options_payloads);
+    auto creator = router.find(resource.data(), path_length(resource), request->get_path_params());
+    if (nullptr != creator) {
+        auto ha = (*creator)(request);
         request->set_payload_handler(std::move(ha));
-    } else {
-        // let's not spam client about GET and DELETE unlikely payloads
-        if (http_message::REQUEST_METHOD_GET != method && 
-                http_message::REQUEST_METHOD_DELETE != method &&
-                http_message::REQUEST_METHOD_HEAD != method &&
-                http_message::REQUEST_METHOD_OPTIONS != method) {
-            STATICLIB_PION_LOG_WARN(log, "No payload handlers found for resource: " << path);
-        }
-        // ignore request body as no payload_handler found
-        rc = true;
     }
+    // without payload handler the body is stored by the parser, in memory or,
+    // above the "content_spill_threshold", in a temporary file
 }
 
 void http_server::handle_request(http_request_ptr request, tcp_connection_ptr& conn,
-        const std::error_code& ec) {
+        const std::error_code& ec, std::shared_ptr<const void> routes) {
 
     // handle error
     if (ec || !request->is_valid()) {
@@ -308,8 +468,12 @@ void http_server::handle_request(http_request_ptr request, tcp_connection_ptr& c
         if (conn->is_open() && (ec.category() == http_parser::get_error_category())) {
             // HTTP parser error
             STATICLIB_PION_LOG_INFO(log, "Invalid HTTP request (" << ec.message() << ")");
-            auto writer = sl::support::make_unique<http_response_writer>(conn, *request);
-            bad_request_handler(std::move(request), std::move(writer));
+            auto writer = make_response_writer(conn, *request);
+            if (http_parser::ERROR_CONTENT_TOO_LARGE == ec.value()) {
+                handle_payload_too_large(std::move(request), std::move(writer));
+            } else {
+                bad_request_handler(std::move(request), std::move(writer));
+            }
         } else {
             if (asio::error::operation_aborted == ec.value() || asio::error::eof == ec.value()) {
                 // don't spam the log with common (non-)errors that happen during normal operation
@@ -325,13 +489,18 @@ void http_server::handle_request(http_request_ptr request, tcp_connection_ptr& c
     // handle request
     STATICLIB_PION_LOG_DEBUG(log, "Received a valid HTTP request");
 
+    // routes snapshot taken for the headers is used to dispatch the request
+    auto table = nullptr != routes.get() ? std::static_pointer_cast<const route_table>(std::move(routes)) :
+            get_routes();
+
     // check websocket upgrade
     if (websocket::is_websocket_upgrade(*request)) {
-        auto tup = find_ws_handlers(request->get_resource(), wsopen_handlers, wsmessage_handlers, wsclose_handlers);
+        auto tup = find_ws_handlers(request->get_resource(), table->wsopen_handlers,
+                table->wsmessage_handlers, table->wsclose_handlers);
         if (std::get<0>(tup)) {
             // collect details for registry
             auto path = request->get_resource();
-            auto id = request->get_header("Sec-WebSocket-Key");
+            auto id = request->get_header(http_message::HEADER_ID_SEC_WEBSOCKET_KEY);
             auto weak_conn = std::weak_ptr<tcp_connection>(conn);
             // create and start ws instance
             auto ws = sl::support::make_unique<websocket>(std::move(request), std::move(conn),
@@ -341,38 +510,44 @@ void http_server::handle_request(http_request_ptr request, tcp_connection_ptr& c
             register_ws_conn(websocket_conn_registry, websocket_conn_registry_mtx, path, id, weak_conn);
         } else {
             STATICLIB_PION_LOG_INFO(log, "No WebSocket handlers found for resource: " << request->get_resource());
-            auto writer = sl::support::make_unique<http_response_writer>(conn, *request);
+            auto writer = make_response_writer(conn, *request);
             not_found_handler(std::move(request), std::move(writer));
         }
         return;
     }
 
     // handle HTTP request
-    auto path = std::string(strip_trailing_slash(request->get_resource()));
-    auto writer = sl::support::make_unique<http_response_writer>(conn, *request);
-    if (http_message::REQUEST_METHOD_OPTIONS == request->get_method() && ("*" == path || "/*" == path)) {
+    auto& resource = request->get_resource();
+    auto path_len = path_length(resource);
+    auto writer = make_response_writer(conn, *request);
+    if (http_message::REQUEST_METHOD_OPTIONS == request->get_method() &&
+            ((1 == path_len && '*' == resource[0]) || (2 == path_len && 0 == resource.compare(0, 2, "/*")))) {
         handle_root_options(std::move(request), std::move(writer));
         return;
     }
     auto& method = request->get_method();
-    handlers_map_type& map = choose_map_by_method(method, get_handlers, post_handlers, put_handlers, 
-            delete_handlers, options_handlers);
-    auto handlers_it = find_submatch(map, path);
-    if (map.end() != handlers_it) {
-        request_handler_type& handler = handlers_it->second;
+    // table is held until the handler returns, so the handler can be removed concurrently
+    auto& router = choose_map_by_method(method, table->get_handlers, table->post_handlers,
+            table->put_handlers, table->delete_handlers, table->options_handlers);
+    auto route = router.find(resource.data(), path_len, request->get_path_params());
+    if (nullptr != route) {
+        STATICLIB_PION_LOG_DEBUG(log, "Found request handler for HTTP resource: " << resource);
+        if (!route->policy.executor) {
+            invoke_handler(route->handler, std::move(request), std::move(writer));
+            return;
+        }
+        // table is held by the task, request and writer are moved into it
+        auto req = std::make_shared<http_request_ptr>(std::move(request));
+        auto wr = std::make_shared<response_writer_ptr>(std::move(writer));
         try {
-            STATICLIB_PION_LOG_DEBUG(log, "Found request handler for HTTP resource: " << path);
-            handler(std::move(request), std::move(writer));
-        } catch (std::bad_alloc&) {
-            // propagate memory errors (FATAL)
-            throw;
+            route->policy.executor([table, route, req, wr] {
+                invoke_handler(route->handler, std::move(*req), std::move(*wr));
+            });
         } catch (std::exception& e) {
-            // log exception from handler, but do not try to notify client
-            // because response is consumed by handler (and its state is indeterminate)
-            STATICLIB_PION_LOG_ERROR(log, "HTTP request handler: " << e.what());
+            STATICLIB_PION_LOG_ERROR(log, "HTTP request handler executor: " << e.what());
         }
     } else {
-        STATICLIB_PION_LOG_INFO(log, "No HTTP request handlers found for resource: " << path);
+        STATICLIB_PION_LOG_INFO(log, "No HTTP request handlers found for resource: " << resource);
         not_found_handler(std::move(request), std::move(writer));
     }    
 }
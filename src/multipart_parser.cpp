@@ -0,0 +1,268 @@
+/*
+ * Copyright 2026, alex at staticlibs.net
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   multipart_parser.cpp
+ * Author: alex
+ *
+ * Created on October 17, 2026, 8:15 PM
+ */
+
+#include "staticlib/pion/multipart_parser.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include "staticlib/utils.hpp"
+
+#include "staticlib/pion/http_message.hpp"
+#include "staticlib/pion/pion_exception.hpp"
+
+namespace staticlib {
+namespace pion {
+
+namespace { // anonymous
+
+// RFC 2046, 5.1.1
+const std::size_t BOUNDARY_MAX = 70;
+
+const std::string CRLF_DASHES = "\r\n--";
+
+} // namespace
+
+const std::size_t multipart_parser::HEADERS_MAX = 16 * 1024;
+
+multipart_parser::multipart_parser(const std::string& content_type, part_handler_type handler) :
+state(parse_state::preamble),
+delimiter(CRLF_DASHES + extract_boundary(content_type)),
+// body may start with the boundary without the preceding CRLF
+carry("\r\n"),
+headers_length(0),
+part_handler(std::move(handler)) {
+    std::size_t boundary_len = delimiter.length() - CRLF_DASHES.length();
+    if (0 == boundary_len || boundary_len > BOUNDARY_MAX) {
+        throw pion_exception("Invalid multipart boundary, content type: [" + content_type + "]");
+    }
+    shifts.fill(static_cast<uint8_t>(delimiter.length()));
+    for (std::size_t i = 0; i < delimiter.length() - 1; i++) {
+        shifts[static_cast<unsigned char>(delimiter[i])] = static_cast<uint8_t>(delimiter.length() - 1 - i);
+    }
+}
+
+void multipart_parser::operator()(const char* data, std::size_t len) {
+    while (len > 0) {
+        switch (state) {
+        case parse_state::preamble:
+        case parse_state::data:
+            parse_data(data, len);
+            break;
+        case parse_state::boundary_tail:
+            // transport padding is allowed after the boundary
+            if ('-' == *data) {
+                state = parse_state::boundary_close;
+            } else if ('\r' == *data) {
+                state = parse_state::boundary_lf;
+            } else if (' ' != *data && '\t' != *data) {
+                throw pion_exception("Invalid multipart content, unexpected byte after boundary");
+            }
+            data += 1;
+            len -= 1;
+            break;
+        case parse_state::boundary_close:
+            if ('-' != *data) {
+                throw pion_exception("Invalid multipart content, unexpected byte after boundary");
+            }
+            state = parse_state::epilogue;
+            data += 1;
+            len -= 1;
+            break;
+        case parse_state::boundary_lf:
+            if ('\n' != *data) {
+                throw pion_exception("Invalid multipart content, unexpected byte after boundary");
+            }
+            state = parse_state::headers;
+            header_line.clear();
+            headers_length = 0;
+            part_headers.clear();
+            data += 1;
+            len -= 1;
+            break;
+        case parse_state::headers:
+            parse_headers(data, len);
+            break;
+        case parse_state::epilogue:
+            // ignored
+            len = 0;
+            break;
+        }
+    }
+}
+
+bool multipart_parser::is_finished() const {
+    return parse_state::epilogue == state;
+}
+
+std::string multipart_parser::extract_boundary(const std::string& content_type) {
+    auto pos = content_type.find("boundary=");
+    if (std::string::npos == pos) {
+        return std::string();
+    }
+    pos += 9;
+    if (pos < content_type.length() && '"' == content_type[pos]) {
+        auto end = content_type.find('"', pos + 1);
+        return std::string::npos != end ? content_type.substr(pos + 1, end - pos - 1) : std::string();
+    }
+    auto end = content_type.find_first_of("; \t", pos);
+    return content_type.substr(pos, std::string::npos != end ? end - pos : std::string::npos);
+}
+
+std::string multipart_parser::get_disposition_param(const headers_type& headers, const std::string& param) {
+    auto it = headers.find(http_message::HEADER_CONTENT_DISPOSITION);
+    if (headers.end() == it) {
+        return std::string();
+    }
+    auto& value = it->second;
+    auto prefix = param + "=";
+    std::size_t pos = 0;
+    while (std::string::npos != (pos = value.find(prefix, pos))) {
+        // parameter name must not be a suffix of another name, e.g. "name" in "filename"
+        if (pos > 0 && ';' != value[pos - 1] && ' ' != value[pos - 1] && '\t' != value[pos - 1]) {
+            pos += prefix.length();
+            continue;
+        }
+        pos += prefix.length();
+        if (pos < value.length() && '"' == value[pos]) {
+            auto end = value.find('"', pos + 1);
+            return std::string::npos != end ? value.substr(pos + 1, end - pos - 1) : value.substr(pos + 1);
+        }
+        auto end = value.find(';', pos);
+        auto res = value.substr(pos, std::string::npos != end ? end - pos : std::string::npos);
+        return sl::utils::trim(res);
+    }
+    return std::string();
+}
+
+void multipart_parser::parse_data(const char*& data, std::size_t& len) {
+    const std::size_t dlen = delimiter.length();
+    if (!carry.empty()) {
+        // delimiter may start in the carried bytes and end in the new piece
+        std::size_t take = (std::min)(len, dlen - 1);
+        std::size_t carry_len = carry.length();
+        carry.append(data, take);
+        std::size_t pos = find_delimiter(carry.data(), carry.length());
+        if (pos < carry_len) {
+            emit_data(carry.data(), pos);
+            carry.clear();
+            std::size_t consumed = pos + dlen - carry_len;
+            data += consumed;
+            len -= consumed;
+            part_sink = nullptr;
+            state = parse_state::boundary_tail;
+            return;
+        }
+        if (take < dlen - 1) {
+            // piece is too short to decide, bytes that cannot start the delimiter are emitted
+            data += take;
+            len -= take;
+            if (carry.length() > dlen - 1) {
+                std::size_t ready = carry.length() - (dlen - 1);
+                emit_data(carry.data(), ready);
+                carry.erase(0, ready);
+            }
+            return;
+        }
+        carry.resize(carry_len);
+        emit_data(carry.data(), carry_len);
+        carry.clear();
+    }
+    std::size_t pos = find_delimiter(data, len);
+    if (pos < len) {
+        emit_data(data, pos);
+        data += pos + dlen;
+        len -= pos + dlen;
+        part_sink = nullptr;
+        state = parse_state::boundary_tail;
+        return;
+    }
+    // tail shorter than delimiter is kept for the next piece
+    std::size_t keep = (std::min)(len, dlen - 1);
+    emit_data(data, len - keep);
+    carry.assign(data + len - keep, keep);
+    data += len;
+    len = 0;
+}
+
+void multipart_parser::parse_headers(const char*& data, std::size_t& len) {
+    auto lf = static_cast<const char*>(std::memchr(data, '\n', len));
+    std::size_t line_len = nullptr != lf ? static_cast<std::size_t>(lf - data) : len;
+    headers_length += line_len + 1;
+    if (headers_length > HEADERS_MAX) {
+        throw pion_exception("Invalid multipart content, part headers exceed maximum size");
+    }
+    header_line.append(data, line_len);
+    if (nullptr == lf) {
+        data += len;
+        len = 0;
+        return;
+    }
+    data += line_len + 1;
+    len -= line_len + 1;
+    if (!header_line.empty() && '\r' == header_line.back()) {
+        header_line.pop_back();
+    }
+    if (header_line.empty()) {
+        finish_headers();
+        return;
+    }
+    auto colon = header_line.find(':');
+    if (std::string::npos == colon) {
+        throw pion_exception("Invalid multipart content, malformed part header: [" + header_line + "]");
+    }
+    auto name = header_line.substr(0, colon);
+    auto value = header_line.substr(colon + 1);
+    part_headers.insert(std::make_pair(std::move(sl::utils::trim(name)), std::move(sl::utils::trim(value))));
+    header_line.clear();
+}
+
+void multipart_parser::finish_headers() {
+    part_sink = part_handler ? part_handler(part_headers) : nullptr;
+    state = parse_state::data;
+}
+
+void multipart_parser::emit_data(const char* data, std::size_t len) {
+    if (len > 0 && parse_state::data == state && part_sink) {
+        part_sink(data, len);
+    }
+}
+
+std::size_t multipart_parser::find_delimiter(const char* data, std::size_t len) const {
+    // Boyer-Moore-Horspool, returns len if not found
+    const std::size_t dlen = delimiter.length();
+    const char* dptr = delimiter.data();
+    const unsigned char last = static_cast<unsigned char>(dptr[dlen - 1]);
+    std::size_t pos = 0;
+    while (pos + dlen <= len) {
+        unsigned char ch = static_cast<unsigned char>(data[pos + dlen - 1]);
+        if (ch == last && 0 == std::memcmp(data + pos, dptr, dlen - 1)) {
+            return pos;
+        }
+        pos += shifts[ch];
+    }
+    return len;
+}
+
+} // namespace
+}
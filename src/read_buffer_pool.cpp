@@ -0,0 +1,67 @@
+/*
+ * Copyright 2026, alex at staticlibs.net
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   read_buffer_pool.cpp
+ * Author: alex
+ *
+ * Created on October 17, 2026, 10:12 AM
+ */
+
+#include "staticlib/pion/read_buffer_pool.hpp"
+
+namespace staticlib {
+namespace pion {
+
+read_buffer_pool::read_buffer_pool(uint32_t limit) :
+spare_limit(limit) { }
+
+std::unique_ptr<read_buffer_pool::buffer_type> read_buffer_pool::acquire() {
+    {
+        std::lock_guard<std::mutex> guard{mutex};
+        if (!spare.empty()) {
+            auto buf = std::move(spare.back());
+            spare.pop_back();
+            return buf;
+        }
+    }
+    // default-initialized, buffer is not zero-filled
+    return std::unique_ptr<buffer_type>(new buffer_type);
+}
+
+void read_buffer_pool::release(std::unique_ptr<buffer_type> buf) {
+    std::lock_guard<std::mutex> guard{mutex};
+    if (spare.size() < spare_limit.load(std::memory_order_acquire)) {
+        spare.emplace_back(std::move(buf));
+    }
+    // otherwise buffer is destroyed on exit
+}
+
+void read_buffer_pool::set_spare_limit(uint32_t limit) {
+    std::lock_guard<std::mutex> guard{mutex};
+    spare_limit.store(limit, std::memory_order_release);
+    if (spare.size() > limit) {
+        spare.resize(limit);
+    }
+}
+
+std::size_t read_buffer_pool::spare_count() {
+    std::lock_guard<std::mutex> guard{mutex};
+    return spare.size();
+}
+
+} // namespace
+}
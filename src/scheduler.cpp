@@ -25,7 +25,14 @@
 
 #include "staticlib/pion/scheduler.hpp"
 
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#endif // __linux__
+
 #include "staticlib/pion/logger.hpp"
+#include "staticlib/pion/pion_exception.hpp"
 
 namespace staticlib { 
 namespace pion {
@@ -34,6 +41,27 @@ namespace { // anonymous
 
 const std::string log = "staticlib.pion.scheduler";
 
+void pin_to_cpu(std::thread& th, uint32_t idx) {
+#ifdef __linux__
+    long cpus_count = sysconf(_SC_NPROCESSORS_ONLN);
+    if (cpus_count <= 0) {
+        STATICLIB_PION_LOG_WARN(log, "Unable to get the number of CPUs, thread is not pinned");
+        return;
+    }
+    cpu_set_t cpus;
+    CPU_ZERO(std::addressof(cpus));
+    CPU_SET(static_cast<int>(idx % static_cast<uint32_t>(cpus_count)), std::addressof(cpus));
+    int err = pthread_setaffinity_np(th.native_handle(), sizeof(cpus), std::addressof(cpus));
+    if (0 != err) {
+        STATICLIB_PION_LOG_WARN(log, "Unable to pin thread to CPU, index: [" << idx << "], error: [" << err << "]");
+    }
+#else // !__linux__
+    (void) th;
+    (void) idx;
+    STATICLIB_PION_LOG_WARN(log, "Thread affinity is not supported, thread is not pinned");
+#endif // __linux__
+}
+
 } // namespace
 
 // members of scheduler
@@ -46,16 +74,23 @@ void scheduler::startup() {
         STATICLIB_PION_LOG_INFO(log, "Starting thread scheduler");
         running = true;
 
-        // schedule a work item to make sure that the service doesn't complete
-        asio_service.reset();
-        keep_running(asio_service, timer);
+        // schedule a work item to make sure that the services don't complete
+        for (auto& sp : service_pool) {
+            sp->service.reset();
+            keep_running(sp->service, sp->timer);
+        }
 
-        // start multiple threads to handle async tasks
+        // start multiple threads to handle async tasks, in per-thread mode
+        // each thread runs its own service, otherwise all threads share the same one
         for (uint32_t n = 0; n < num_threads; ++n) {
-            std::unique_ptr<std::thread> new_thread(new std::thread([this]() {
-                this->process_service_work(this->asio_service);
+            asio::io_service& service = get_io_service(n);
+            std::unique_ptr<std::thread> new_thread(new std::thread([this, &service]() {
+                this->process_service_work(service);
                 this->thread_stop_hook();
             }));
+            if (pin_threads) {
+                pin_to_cpu(*new_thread, n);
+            }
             thread_pool.emplace_back(std::move(new_thread));
         }
     }
@@ -77,9 +112,9 @@ void scheduler::shutdown(void) {
 
         // shut everything down
         running = false;
-        asio_service.stop();
+        stop_services();
         stop_threads();
-        asio_service.reset();
+        reset_services();
         thread_pool.clear();
         
         STATICLIB_PION_LOG_INFO(log, "The thread scheduler has shutdown");
@@ -90,9 +125,9 @@ void scheduler::shutdown(void) {
     } else {
         
         // stop and finish everything to be certain that no events are pending
-        asio_service.stop();
+        stop_services();
         stop_threads();
-        asio_service.reset();
+        reset_services();
         thread_pool.clear();
         
         // Make sure anyone waiting on shutdown gets notified
@@ -101,6 +136,29 @@ void scheduler::shutdown(void) {
     }
 }
 
+void scheduler::set_io_service_per_thread(bool enabled) {
+    std::lock_guard<std::mutex> scheduler_lock(mutex);
+    if (running) {
+        throw pion_exception("IO service mode cannot be changed on a running scheduler");
+    }
+    // the first service is kept, it may already be in use by acceptors
+    uint32_t count = enabled && num_threads > 1 ? num_threads : 1;
+    while (service_pool.size() > count) {
+        service_pool.pop_back();
+    }
+    while (service_pool.size() < count) {
+        service_pool.emplace_back(new service_pair());
+    }
+}
+
+void scheduler::set_thread_affinity(bool enabled) {
+    std::lock_guard<std::mutex> scheduler_lock(mutex);
+    if (running) {
+        throw pion_exception("Thread affinity cannot be changed on a running scheduler");
+    }
+    this->pin_threads = enabled;
+}
+
 void scheduler::join(void) {
     std::unique_lock<std::mutex> scheduler_lock(mutex);
     while (running) {
@@ -146,6 +204,18 @@ void scheduler::process_service_work(asio::io_service& service) {
     }   
 }
 
+void scheduler::stop_services() {
+    for (auto& sp : service_pool) {
+        sp->service.stop();
+    }
+}
+
+void scheduler::reset_services() {
+    for (auto& sp : service_pool) {
+        sp->service.reset();
+    }
+}
+
 void scheduler::stop_threads() {
     if (!thread_pool.empty()) {
         STATICLIB_PION_LOG_DEBUG(log, "Waiting for threads to shutdown");
@@ -0,0 +1,938 @@
+/*
+ * Copyright 2026, alex at staticlibs.net
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   static_file_handler.cpp
+ * Author: alex
+ *
+ * Created on October 18, 2026, 4:20 AM
+ */
+
+#include "staticlib/pion/static_file_handler.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <list>
+#include <mutex>
+#include <utility>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif // WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <fcntl.h>
+#include <io.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#else // !_WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif // _WIN32
+
+#include "staticlib/support.hpp"
+#include "staticlib/utils.hpp"
+
+#include "staticlib/pion/logger.hpp"
+#include "staticlib/pion/pion_exception.hpp"
+#include "staticlib/pion/shared_buffer.hpp"
+
+namespace staticlib {
+namespace pion {
+
+namespace { // anonymous
+
+const std::string log = "staticlib.pion.static_file_handler";
+
+const std::string GZIP_SUFFIX(".gz");
+const std::string GZIP_CODING("gzip");
+const std::string RANGE_BYTES_PREFIX("bytes=");
+const std::string CONTENT_RANGE_BYTES_PREFIX("bytes ");
+const std::string ACCEPT_RANGES_BYTES("bytes");
+const std::string WEAK_ETAG_PREFIX("W/");
+const std::string DEFAULT_MIME_TYPE("application/octet-stream");
+
+const std::string NOT_FOUND_MSG_START = R"({
+    "code": 404,
+    "message": "Not Found",
+    "description": "The requested URL: [)";
+const std::string NOT_FOUND_MSG_FINISH = R"(] was not found on this server."
+})";
+const std::string SERVER_ERROR_MSG = R"({
+    "code": 500,
+    "message": "Server Error",
+    "description": "The requested file cannot be read."
+})";
+
+// content types of the common web files
+const char* const BUILTIN_MIME_TYPES[][2] = {
+    {"html", "text/html; charset=utf-8"},
+    {"htm", "text/html; charset=utf-8"},
+    {"css", "text/css; charset=utf-8"},
+    {"js", "application/javascript; charset=utf-8"},
+    {"mjs", "application/javascript; charset=utf-8"},
+    {"json", "application/json"},
+    {"map", "application/json"},
+    {"txt", "text/plain; charset=utf-8"},
+    {"xml", "text/xml"},
+    {"svg", "image/svg+xml"},
+    {"png", "image/png"},
+    {"jpg", "image/jpeg"},
+    {"jpeg", "image/jpeg"},
+    {"gif", "image/gif"},
+    {"ico", "image/x-icon"},
+    {"webp", "image/webp"},
+    {"woff", "font/woff"},
+    {"woff2", "font/woff2"},
+    {"ttf", "font/ttf"},
+    {"wasm", "application/wasm"},
+    {"pdf", "application/pdf"}
+};
+
+/**
+ * Result of the "Range" header parsing
+ */
+enum class range_result {
+    none, satisfiable, unsatisfiable
+};
+
+/**
+ * File metadata from the file system
+ */
+struct file_stat {
+    bool found;
+    uint64_t size;
+    std::time_t mtime;
+
+    file_stat() :
+    found(false),
+    size(0),
+    mtime(0) { }
+};
+
+/**
+ * Representation of the file that is sent to client, either
+ * the file itself or its precompressed sibling
+ */
+struct file_variant {
+    // path on disk
+    std::string path;
+    // metadata the variant was loaded with
+    file_stat stat;
+    std::string etag;
+    std::string last_modified;
+    // headers sent with "200 OK" and "206 Partial Content" responses
+    shared_buffer headers;
+    // headers sent with "304 Not Modified" responses
+    shared_buffer not_modified_headers;
+    // contents kept in memory or mapped, unused for the files sent from disk
+    shared_buffer body;
+    bool from_disk;
+    bool mapped;
+
+    file_variant() :
+    from_disk(false),
+    mapped(false) { }
+};
+
+/**
+ * Immutable cache entry, shared by the requests being served
+ */
+struct file_entry {
+    file_variant identity;
+    file_variant gzip;
+};
+
+/**
+ * Read-only memory mapping of the whole file
+ */
+class mapped_file {
+    void* addr;
+    std::size_t len;
+
+public:
+    mapped_file(const std::string& path, std::size_t len) :
+    addr(nullptr),
+    len(len) {
+#ifdef _WIN32
+        HANDLE handle = ::CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE,
+                nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (INVALID_HANDLE_VALUE == handle) {
+            throw pion_exception("Error opening file: [" + path + "]," +
+                    " error: [" + sl::support::to_string(::GetLastError()) + "]");
+        }
+        HANDLE mapping = ::CreateFileMappingA(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (nullptr != mapping) {
+            addr = ::MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, len);
+            ::CloseHandle(mapping);
+        }
+        ::CloseHandle(handle);
+        if (nullptr == addr) {
+            throw pion_exception("Error mapping file: [" + path + "]," +
+                    " error: [" + sl::support::to_string(::GetLastError()) + "]");
+        }
+#else // !_WIN32
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (-1 == fd) {
+            throw pion_exception("Error opening file: [" + path + "]," +
+                    " error: [" + sl::support::to_string(errno) + "]");
+        }
+        // file may be truncated after it was checked, reading pages
+        // of the mapping past the end of file raises SIGBUS
+        struct stat st;
+        if (0 != ::fstat(fd, std::addressof(st)) || static_cast<uint64_t>(st.st_size) != len) {
+            ::close(fd);
+            throw pion_exception("Error mapping file: [" + path + "], file size changed");
+        }
+        void* ptr = ::mmap(nullptr, len, PROT_READ, MAP_SHARED, fd, 0);
+        // mapping stays valid after the descriptor is closed
+        ::close(fd);
+        if (MAP_FAILED == ptr) {
+            throw pion_exception("Error mapping file: [" + path + "]," +
+                    " error: [" + sl::support::to_string(errno) + "]");
+        }
+        addr = ptr;
+#endif // _WIN32
+    }
+
+    ~mapped_file() STATICLIB_NOEXCEPT {
+#ifdef _WIN32
+        ::UnmapViewOfFile(addr);
+#else // !_WIN32
+        ::munmap(addr, len);
+#endif // _WIN32
+    }
+
+    mapped_file(const mapped_file&) = delete;
+
+    mapped_file& operator=(const mapped_file&) = delete;
+
+    const char* data() const {
+        return static_cast<const char*>(addr);
+    }
+};
+
+file_stat stat_file(const std::string& path) {
+    file_stat res;
+#ifdef _WIN32
+    struct _stat64 st;
+    if (0 == ::_stat64(path.c_str(), std::addressof(st)) && 0 != (st.st_mode & _S_IFREG)) {
+#else // !_WIN32
+    struct stat st;
+    if (0 == ::stat(path.c_str(), std::addressof(st)) && S_ISREG(st.st_mode)) {
+#endif // _WIN32
+        res.found = true;
+        res.size = static_cast<uint64_t>(st.st_size);
+        res.mtime = static_cast<std::time_t>(st.st_mtime);
+    }
+    return res;
+}
+
+file_stat stat_fd(int fd) {
+    file_stat res;
+#ifdef _WIN32
+    struct _stat64 st;
+    if (0 == ::_fstat64(fd, std::addressof(st)) && 0 != (st.st_mode & _S_IFREG)) {
+#else // !_WIN32
+    struct stat st;
+    if (0 == ::fstat(fd, std::addressof(st)) && S_ISREG(st.st_mode)) {
+#endif // _WIN32
+        res.found = true;
+        res.size = static_cast<uint64_t>(st.st_size);
+        res.mtime = static_cast<std::time_t>(st.st_mtime);
+    }
+    return res;
+}
+
+bool same_stat(const file_stat& a, const file_stat& b) {
+    return a.found == b.found && a.size == b.size && a.mtime == b.mtime;
+}
+
+int open_file(const std::string& path) {
+#ifdef _WIN32
+    return ::_open(path.c_str(), _O_RDONLY | _O_BINARY);
+#else // !_WIN32
+    return ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+#endif // _WIN32
+}
+
+void close_file(int fd) {
+#ifdef _WIN32
+    ::_close(fd);
+#else // !_WIN32
+    ::close(fd);
+#endif // _WIN32
+}
+
+std::shared_ptr<const std::string> read_file(const std::string& path, std::size_t len) {
+    auto res = std::make_shared<std::string>();
+    res->resize(len);
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (nullptr == file) {
+        throw pion_exception("Error opening file: [" + path + "]");
+    }
+    std::size_t read = len > 0 ? std::fread(std::addressof(res->front()), 1, len, file) : 0;
+    std::fclose(file);
+    if (read != len) {
+        throw pion_exception("Error reading file: [" + path + "]," +
+                " expected length: [" + sl::support::to_string(len) + "]," +
+                " read: [" + sl::support::to_string(read) + "]");
+    }
+    return res;
+}
+
+std::string to_hex(uint64_t value) {
+    static const char digits[] = "0123456789abcdef";
+    std::string res;
+    do {
+        res.insert(res.begin(), digits[value & 0xf]);
+        value >>= 4;
+    } while (value > 0);
+    return res;
+}
+
+void append_header_line(std::string& dest, const std::string& name, const std::string& value) {
+    dest.append(name);
+    dest.append(http_message::HEADER_NAME_VALUE_DELIMITER);
+    dest.append(value);
+    dest.append(http_message::STRING_CRLF);
+}
+
+std::string trimmed(const std::string& str, std::size_t begin, std::size_t end) {
+    while (begin < end && std::isspace(static_cast<unsigned char>(str[begin]))) {
+        begin += 1;
+    }
+    while (end > begin && std::isspace(static_cast<unsigned char>(str[end - 1]))) {
+        end -= 1;
+    }
+    return str.substr(begin, end - begin);
+}
+
+// calls the function for each trimmed element of the comma-separated list,
+// stops when the function returns true
+template<typename Fun>
+bool any_list_element(const std::string& list, Fun fun) {
+    std::size_t begin = 0;
+    while (begin <= list.length()) {
+        std::size_t end = list.find(',', begin);
+        if (std::string::npos == end) {
+            end = list.length();
+        }
+        if (fun(trimmed(list, begin, end))) {
+            return true;
+        }
+        begin = end + 1;
+    }
+    return false;
+}
+
+bool parse_uint64(const std::string& str, uint64_t& value) {
+    // 19 digits always fit into uint64_t
+    if (str.empty() || str.length() > 19) {
+        return false;
+    }
+    uint64_t res = 0;
+    for (char ch : str) {
+        if (ch < '0' || ch > '9') {
+            return false;
+        }
+        res = res * 10 + static_cast<uint64_t>(ch - '0');
+    }
+    value = res;
+    return true;
+}
+
+bool accepts_gzip(const std::string& accept_encoding) {
+    return any_list_element(accept_encoding, [](const std::string& el) {
+        std::size_t semicolon = el.find(';');
+        std::string coding = trimmed(el, 0, std::string::npos == semicolon ? el.length() : semicolon);
+        if (!sl::utils::iequals(coding, GZIP_CODING)) {
+            return false;
+        }
+        // "gzip;q=0" rejects the coding
+        std::size_t q = std::string::npos != semicolon ? el.find("q=", semicolon) : std::string::npos;
+        if (std::string::npos == q) {
+            return true;
+        }
+        std::string qvalue = trimmed(el, q + 2, el.length());
+        return std::string::npos != qvalue.find_first_not_of("0.");
+    });
+}
+
+bool etag_matches(const std::string& if_none_match, const std::string& etag) {
+    return any_list_element(if_none_match, [&etag](const std::string& el) {
+        if ("*" == el) {
+            return true;
+        }
+        // weak comparison
+        if (0 == el.compare(0, WEAK_ETAG_PREFIX.length(), WEAK_ETAG_PREFIX)) {
+            return 0 == el.compare(WEAK_ETAG_PREFIX.length(), std::string::npos, etag);
+        }
+        return el == etag;
+    });
+}
+
+bool is_not_modified(const http_request& request, const file_variant& fv) {
+    auto& if_none_match = request.get_header(http_message::HEADER_ID_IF_NONE_MATCH);
+    if (!if_none_match.empty()) {
+        return etag_matches(if_none_match, fv.etag);
+    }
+    auto& if_modified_since = request.get_header(http_message::HEADER_ID_IF_MODIFIED_SINCE);
+    return !if_modified_since.empty() && if_modified_since == fv.last_modified;
+}
+
+// "If-Range" with a strong ETag or the exact date
+bool is_range_allowed(const http_request& request, const file_variant& fv) {
+    std::string if_range = request.get_header(http_message::HEADER_ID_IF_RANGE);
+    sl::utils::trim(if_range);
+    return if_range.empty() || if_range == fv.etag || if_range == fv.last_modified;
+}
+
+// single range only, multiple ranges are ignored and the whole file is sent
+range_result parse_range(const std::string& header, uint64_t size, uint64_t& offset, uint64_t& length) {
+    if (0 != header.compare(0, RANGE_BYTES_PREFIX.length(), RANGE_BYTES_PREFIX) ||
+            std::string::npos != header.find(',')) {
+        return range_result::none;
+    }
+    std::size_t dash = header.find('-', RANGE_BYTES_PREFIX.length());
+    if (std::string::npos == dash) {
+        return range_result::none;
+    }
+    std::string first = trimmed(header, RANGE_BYTES_PREFIX.length(), dash);
+    std::string last = trimmed(header, dash + 1, header.length());
+    if (first.empty()) {
+        // suffix range, "bytes=-500"
+        uint64_t suffix = 0;
+        if (!parse_uint64(last, suffix)) {
+            return range_result::none;
+        }
+        if (0 == suffix || 0 == size) {
+            return range_result::unsatisfiable;
+        }
+        length = (std::min)(suffix, size);
+        offset = size - length;
+        return range_result::satisfiable;
+    }
+    uint64_t begin = 0;
+    if (!parse_uint64(first, begin)) {
+        return range_result::none;
+    }
+    uint64_t end = size > 0 ? size - 1 : 0;
+    if (!last.empty()) {
+        if (!parse_uint64(last, end) || end < begin) {
+            return range_result::none;
+        }
+    }
+    if (begin >= size) {
+        return range_result::unsatisfiable;
+    }
+    end = (std::min)(end, size - 1);
+    offset = begin;
+    length = end - begin + 1;
+    return range_result::satisfiable;
+}
+
+// rejects paths that can escape the root directory
+bool is_safe_path(const std::string& path) {
+    if (std::string::npos != path.find('\0') || std::string::npos != path.find('\\')) {
+        return false;
+    }
+#ifdef _WIN32
+    if (std::string::npos != path.find(':')) {
+        return false;
+    }
+#endif // _WIN32
+    std::size_t begin = 0;
+    while (begin < path.length()) {
+        std::size_t end = path.find('/', begin);
+        if (std::string::npos == end) {
+            end = path.length();
+        }
+        if (0 == path.compare(begin, end - begin, "..") || 0 == path.compare(begin, end - begin, ".")) {
+            return false;
+        }
+        begin = end + 1;
+    }
+    return true;
+}
+
+void send_not_found(const http_request& request, response_writer_ptr resp) {
+    resp->get_response().set_status_code(http_message::RESPONSE_CODE_NOT_FOUND);
+    resp->get_response().set_status_message(http_message::RESPONSE_MESSAGE_NOT_FOUND);
+    resp->write_nocopy(NOT_FOUND_MSG_START);
+    auto res = request.get_resource();
+    std::replace(res.begin(), res.end(), '"', '\'');
+    resp->write(res);
+    resp->write_nocopy(NOT_FOUND_MSG_FINISH);
+    resp->send(std::move(resp));
+}
+
+void send_server_error(response_writer_ptr resp) {
+    resp->get_response().set_status_code(http_message::RESPONSE_CODE_SERVER_ERROR);
+    resp->get_response().set_status_message(http_message::RESPONSE_MESSAGE_SERVER_ERROR);
+    resp->write_nocopy(SERVER_ERROR_MSG);
+    resp->send(std::move(resp));
+}
+
+} // namespace
+
+/**
+ * LRU cache of the files served by the handler, entries are checked
+ * against the file system not more often than the revalidation interval
+ */
+class static_file_cache {
+    /**
+     * Cached entry with its bookkeeping
+     */
+    struct slot {
+        std::shared_ptr<const file_entry> entry;
+        std::chrono::steady_clock::time_point checked_at;
+        uint64_t memory_charge;
+        uint64_t mapped_charge;
+        std::list<std::string>::iterator lru_pos;
+    };
+
+    /**
+     * Handler settings
+     */
+    static_file_options options;
+
+    /**
+     * Content types by extension
+     */
+    std::unordered_map<std::string, std::string> mime_types;
+
+    /**
+     * Lock for the cache state
+     */
+    std::mutex mutex;
+
+    /**
+     * Cached entries by the path relative to the root directory
+     */
+    std::unordered_map<std::string, slot> slots;
+
+    /**
+     * Cached paths, most recently used first
+     */
+    std::list<std::string> lru;
+
+    /**
+     * Number of bytes kept in memory by the cached entries
+     */
+    uint64_t memory_used;
+
+    /**
+     * Number of bytes kept mapped by the cached entries
+     */
+    uint64_t mapped_used;
+
+public:
+    /**
+     * Constructor
+     *
+     * @param options handler settings
+     */
+    explicit static_file_cache(static_file_options options) :
+    options(std::move(options)),
+    memory_used(0),
+    mapped_used(0) {
+        for (auto& pa : BUILTIN_MIME_TYPES) {
+            mime_types[pa[0]] = pa[1];
+        }
+        for (auto& pa : this->options.mime_types) {
+            mime_types[pa.first] = pa.second;
+        }
+    }
+
+    /**
+     * Deleted copy constructor
+     */
+    static_file_cache(const static_file_cache&) = delete;
+
+    /**
+     * Deleted copy assignment operator
+     */
+    static_file_cache& operator=(const static_file_cache&) = delete;
+
+    /**
+     * Returns handler settings
+     *
+     * @return handler settings
+     */
+    const static_file_options& get_options() const {
+        return options;
+    }
+
+    /**
+     * Returns the entry for the specified path, loads the file if it is
+     * not cached or if it was changed on disk
+     *
+     * @param path path relative to the root directory, starts with a slash
+     * @return cached entry, null if file is not found
+     * @throws pion_exception if file cannot be read
+     */
+    std::shared_ptr<const file_entry> get(const std::string& path) {
+        auto now = std::chrono::steady_clock::now();
+        std::shared_ptr<const file_entry> cached;
+        {
+            std::lock_guard<std::mutex> guard{mutex};
+            auto it = slots.find(path);
+            if (slots.end() != it) {
+                lru.splice(lru.begin(), lru, it->second.lru_pos);
+                if (now - it->second.checked_at < std::chrono::milliseconds(options.revalidate_interval_millis)) {
+                    return it->second.entry;
+                }
+                cached = it->second.entry;
+            }
+        }
+        // file system is accessed without holding the lock
+        std::string full_path = options.root_directory + path;
+        auto st = stat_file(full_path);
+        auto gz_st = options.serve_precompressed ? stat_file(full_path + GZIP_SUFFIX) : file_stat();
+        if (!st.found) {
+            std::lock_guard<std::mutex> guard{mutex};
+            remove(path);
+            return nullptr;
+        }
+        if (nullptr != cached.get() && same_stat(st, cached->identity.stat) &&
+                same_stat(gz_st, cached->gzip.stat)) {
+            std::lock_guard<std::mutex> guard{mutex};
+            auto it = slots.find(path);
+            if (slots.end() != it && it->second.entry == cached) {
+                it->second.checked_at = now;
+            }
+            return cached;
+        }
+        auto entry = load(full_path, st, gz_st);
+        std::lock_guard<std::mutex> guard{mutex};
+        put(path, entry, now);
+        return entry;
+    }
+
+    /**
+     * Removes the entry, so it is loaded again on the next request
+     *
+     * @param path path relative to the root directory
+     */
+    void invalidate(const std::string& path) {
+        std::lock_guard<std::mutex> guard{mutex};
+        remove(path);
+    }
+
+private:
+    /**
+     * Loads the file and its precompressed sibling
+     *
+     * @param full_path path on disk
+     * @param st file metadata
+     * @param gz_st metadata of the precompressed sibling
+     * @return new entry
+     */
+    std::shared_ptr<const file_entry> load(const std::string& full_path, const file_stat& st,
+            const file_stat& gz_st) {
+        auto entry = std::make_shared<file_entry>();
+        const std::string& type = find_mime_type(full_path);
+        load_variant(entry->identity, full_path, st, type, gz_st.found, false);
+        if (gz_st.found) {
+            load_variant(entry->gzip, full_path + GZIP_SUFFIX, gz_st, type, true, true);
+        }
+        return entry;
+    }
+
+    /**
+     * Loads the file contents (if the file is not sent from disk)
+     * and prepares the response headers
+     *
+     * @param fv variant to load
+     * @param path path on disk
+     * @param st file metadata
+     * @param type content type
+     * @param has_gzip whether the precompressed sibling exists
+     * @param gzip whether this variant is precompressed
+     */
+    void load_variant(file_variant& fv, const std::string& path, const file_stat& st,
+            const std::string& type, bool has_gzip, bool gzip) {
+        fv.path = path;
+        fv.stat = st;
+        fv.etag = "\"" + to_hex(static_cast<uint64_t>(st.mtime)) + "-" + to_hex(st.size) + "\"";
+        fv.last_modified = http_response::make_http_date(st.mtime);
+        std::string headers;
+        append_header_line(headers, http_message::HEADER_CONTENT_TYPE, type);
+        append_header_line(headers, http_message::HEADER_LAST_MODIFIED, fv.last_modified);
+        append_header_line(headers, http_message::HEADER_ETAG, fv.etag);
+        append_header_line(headers, http_message::HEADER_ACCEPT_RANGES, ACCEPT_RANGES_BYTES);
+        if (gzip) {
+            append_header_line(headers, http_message::HEADER_CONTENT_ENCODING, GZIP_CODING);
+        }
+        std::string not_modified_headers;
+        append_header_line(not_modified_headers, http_message::HEADER_ETAG, fv.etag);
+        if (has_gzip) {
+            append_header_line(headers, http_message::HEADER_VARY, http_message::HEADER_ACCEPT_ENCODING);
+            append_header_line(not_modified_headers, http_message::HEADER_VARY, http_message::HEADER_ACCEPT_ENCODING);
+        }
+        fv.headers = shared_buffer(std::make_shared<const std::string>(std::move(headers)));
+        fv.not_modified_headers = shared_buffer(std::make_shared<const std::string>(std::move(not_modified_headers)));
+        if (st.size <= options.max_cached_file_size) {
+            fv.body = shared_buffer(read_file(path, static_cast<std::size_t>(st.size)));
+        } else if (st.size <= options.max_mapped_file_size) {
+            auto mf = std::make_shared<mapped_file>(path, static_cast<std::size_t>(st.size));
+            const char* data = mf->data();
+            fv.body = shared_buffer(std::move(mf), {data, static_cast<std::size_t>(st.size)});
+            fv.mapped = true;
+        } else {
+            fv.from_disk = true;
+        }
+    }
+
+    /**
+     * Finds content type by the file extension
+     *
+     * @param path file path
+     * @return content type
+     */
+    const std::string& find_mime_type(const std::string& path) const {
+        std::size_t dot = path.rfind('.');
+        std::size_t slash = path.rfind('/');
+        if (std::string::npos == dot || (std::string::npos != slash && dot < slash)) {
+            return DEFAULT_MIME_TYPE;
+        }
+        std::string ext = path.substr(dot + 1);
+        std::transform(ext.begin(), ext.end(), ext.begin(), [](char ch) {
+            return static_cast<char>(std::tolower(static_cast<unsigned char>(ch)));
+        });
+        auto it = mime_types.find(ext);
+        return mime_types.end() != it ? it->second : DEFAULT_MIME_TYPE;
+    }
+
+    /**
+     * Adds or replaces the entry, evicts least recently used entries
+     * when the cache is over its limits; must be called under lock
+     *
+     * @param path relative path
+     * @param entry entry to add
+     * @param now time of the check
+     */
+    void put(const std::string& path, std::shared_ptr<const file_entry> entry,
+            std::chrono::steady_clock::time_point now) {
+        remove(path);
+        slot st;
+        st.memory_charge = path.length() + charge(entry->identity, false) + charge(entry->gzip, false);
+        st.mapped_charge = charge(entry->identity, true) + charge(entry->gzip, true);
+        st.entry = std::move(entry);
+        st.checked_at = now;
+        lru.push_front(path);
+        st.lru_pos = lru.begin();
+        memory_used += st.memory_charge;
+        mapped_used += st.mapped_charge;
+        slots.emplace(path, std::move(st));
+        evict();
+    }
+
+    /**
+     * Removes the entry if it is cached, must be called under lock
+     *
+     * @param path relative path
+     */
+    void remove(const std::string& path) {
+        auto it = slots.find(path);
+        if (slots.end() != it) {
+            memory_used -= it->second.memory_charge;
+            mapped_used -= it->second.mapped_charge;
+            lru.erase(it->second.lru_pos);
+            slots.erase(it);
+        }
+    }
+
+    /**
+     * Removes least recently used entries that hold the memory (or the mappings)
+     * while the cache is over the corresponding limit; entries that are
+     * still being sent remain alive until the responses are sent
+     */
+    void evict() {
+        auto it = lru.end();
+        while (lru.begin() != it && (memory_used > options.memory_cache_size ||
+                mapped_used > options.mapped_cache_size)) {
+            --it;
+            auto sit = slots.find(*it);
+            bool over_memory = memory_used > options.memory_cache_size && sit->second.memory_charge > 0;
+            bool over_mapped = mapped_used > options.mapped_cache_size && sit->second.mapped_charge > 0;
+            if (over_memory || over_mapped) {
+                memory_used -= sit->second.memory_charge;
+                mapped_used -= sit->second.mapped_charge;
+                slots.erase(sit);
+                it = lru.erase(it);
+            }
+        }
+    }
+
+    /**
+     * Number of bytes held by the variant
+     *
+     * @param fv file variant
+     * @param mapped whether to count mapped or memory bytes
+     * @return number of bytes
+     */
+    static uint64_t charge(const file_variant& fv, bool mapped) {
+        if (mapped) {
+            return fv.mapped ? fv.body.size() : 0;
+        }
+        uint64_t res = fv.headers.size() + fv.not_modified_headers.size() + fv.path.length();
+        return fv.mapped ? res : res + fv.body.size();
+    }
+};
+
+namespace { // anonymous
+
+// sends the cached file, the entry is loaded again (once) if the file
+// on disk does not match the cached metadata
+void serve_file(static_file_cache& cache, const std::string& path, http_request_ptr request,
+        response_writer_ptr resp, bool retry) {
+    std::shared_ptr<const file_entry> entry;
+    try {
+        entry = cache.get(path);
+    } catch (const std::exception& e) {
+        STATICLIB_PION_LOG_WARN(log, "Static file load error: " << e.what());
+        send_server_error(std::move(resp));
+        return;
+    }
+    if (nullptr == entry.get()) {
+        send_not_found(*request, std::move(resp));
+        return;
+    }
+    const file_variant* fv = std::addressof(entry->identity);
+    if (entry->gzip.stat.found &&
+            accepts_gzip(request->get_header(http_message::HEADER_ID_ACCEPT_ENCODING))) {
+        fv = std::addressof(entry->gzip);
+    }
+
+    auto& response = resp->get_response();
+    if (is_not_modified(*request, *fv)) {
+        response.set_status_code(http_message::RESPONSE_CODE_NOT_MODIFIED);
+        response.set_status_message(http_message::RESPONSE_MESSAGE_NOT_MODIFIED);
+        response.set_raw_headers(fv->not_modified_headers);
+        response.set_do_not_send_content_length();
+        resp->send(std::move(resp));
+        return;
+    }
+
+    uint64_t size = fv->stat.size;
+    uint64_t offset = 0;
+    uint64_t length = size;
+    auto& range = request->get_header(http_message::HEADER_ID_RANGE);
+    if (!range.empty() && is_range_allowed(*request, *fv)) {
+        switch (parse_range(range, size, offset, length)) {
+        case range_result::satisfiable:
+            response.set_status_code(http_message::RESPONSE_CODE_PARTIAL_CONTENT);
+            response.set_status_message(http_message::RESPONSE_MESSAGE_PARTIAL_CONTENT);
+            response.change_header(http_message::HEADER_CONTENT_RANGE, CONTENT_RANGE_BYTES_PREFIX +
+                    sl::support::to_string(offset) + "-" + sl::support::to_string(offset + length - 1) +
+                    "/" + sl::support::to_string(size));
+            break;
+        case range_result::unsatisfiable:
+            response.set_status_code(http_message::RESPONSE_CODE_RANGE_NOT_SATISFIABLE);
+            response.set_status_message(http_message::RESPONSE_MESSAGE_RANGE_NOT_SATISFIABLE);
+            response.change_header(http_message::HEADER_CONTENT_RANGE, CONTENT_RANGE_BYTES_PREFIX +
+                    "*/" + sl::support::to_string(size));
+            resp->send(std::move(resp));
+            return;
+        default:
+            offset = 0;
+            length = size;
+        }
+    }
+    response.set_raw_headers(fv->headers);
+
+    if (!response.is_body_allowed()) {
+        // HEAD response reports the length of the content that would be sent
+        response.set_content_length(static_cast<std::size_t>(length));
+        resp->send(std::move(resp));
+    } else if (!fv->from_disk && !(fv->mapped && resp->get_connection()->get_ssl_flag())) {
+        if (length > 0) {
+            resp->write_shared(fv->body.slice(static_cast<std::size_t>(offset), static_cast<std::size_t>(length)));
+        }
+        resp->send(std::move(resp));
+    } else {
+        // mapped files are sent from disk over TLS, as encryption reads the mapping
+        // in user space and gets SIGBUS if the file was truncated in place
+        int fd = open_file(fv->path);
+        if (-1 == fd) {
+            STATICLIB_PION_LOG_WARN(log, "Static file open error, path: [" << fv->path << "]");
+            send_not_found(*request, std::move(resp));
+            return;
+        }
+        // cached size and range are used for the headers, file must not be changed since
+        if (!same_stat(stat_fd(fd), fv->stat)) {
+            close_file(fd);
+            if (retry) {
+                cache.invalidate(path);
+                // status and range of the stale entry are discarded
+                response.set_status_code(http_message::RESPONSE_CODE_OK);
+                response.set_status_message(http_message::RESPONSE_MESSAGE_OK);
+                response.delete_header(http_message::HEADER_CONTENT_RANGE);
+                serve_file(cache, path, std::move(request), std::move(resp), false);
+            } else {
+                STATICLIB_PION_LOG_WARN(log, "Static file changed while being served, path: [" << fv->path << "]");
+                send_server_error(std::move(resp));
+            }
+            return;
+        }
+        http_response_writer::send_file(std::move(resp), fd, offset, length);
+    }
+}
+
+} // namespace
+
+static_file_handler::static_file_handler(static_file_options options) {
+    if (options.root_directory.empty()) {
+        throw pion_exception("Invalid empty root directory specified for static files");
+    }
+    // relative paths start with a slash
+    if ('/' == options.root_directory.back()) {
+        options.root_directory.pop_back();
+    }
+    cache = std::make_shared<static_file_cache>(std::move(options));
+}
+
+void static_file_handler::operator()(http_request_ptr request, response_writer_ptr resp) const {
+    auto& options = cache->get_options();
+    auto& resource = request->get_resource();
+    if (0 != resource.compare(0, options.url_prefix.length(), options.url_prefix)) {
+        send_not_found(*request, std::move(resp));
+        return;
+    }
+    std::string path = sl::utils::url_decode(resource.substr(options.url_prefix.length()));
+    if (path.empty() || '/' != path.front()) {
+        path.insert(path.begin(), '/');
+    }
+    if ('/' == path.back()) {
+        path.append(options.index_file);
+    }
+    if (!is_safe_path(path)) {
+        send_not_found(*request, std::move(resp));
+        return;
+    }
+    serve_file(*cache, path, std::move(request), std::move(resp), true);
+}
+
+} // namespace
+}
@@ -0,0 +1,177 @@
+/*
+ * Copyright 2026, alex at staticlibs.net
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   tcp_connection_registry.cpp
+ * Author: alex
+ *
+ * Created on October 16, 2026, 11:42 PM
+ */
+
+#include "staticlib/pion/tcp_connection_registry.hpp"
+
+#include "staticlib/pion/tcp_connection.hpp"
+
+namespace staticlib {
+namespace pion {
+
+tcp_connection_registry::tcp_connection_registry(uint32_t shards_count) :
+count(0),
+next_shard(0),
+spare_limit(0) {
+    uint32_t num = shards_count > 0 ? shards_count : 1;
+    for (uint32_t i = 0; i < num; i++) {
+        shards.emplace_back(new shard());
+    }
+}
+
+tcp_connection_registry::~tcp_connection_registry() STATICLIB_NOEXCEPT {
+    clear_spare();
+}
+
+void tcp_connection_registry::insert(tcp_connection& conn, uint32_t shard_idx) {
+    uint32_t idx = shard_idx % shards.size();
+    auto& sh = *shards[idx];
+    std::lock_guard<std::mutex> guard{sh.mutex};
+    conn.registry_shard = idx;
+    conn.registry_prev = nullptr;
+    conn.registry_next = sh.head;
+    if (nullptr != sh.head) {
+        sh.head->registry_prev = std::addressof(conn);
+    }
+    sh.head = std::addressof(conn);
+    conn.registered = true;
+    count.fetch_add(1, std::memory_order_release);
+}
+
+void tcp_connection_registry::remove(tcp_connection& conn) {
+    if (unlink(conn)) {
+        decrement_count();
+    }
+}
+
+void tcp_connection_registry::release(tcp_connection* conn) {
+    bool registered = unlink(*conn);
+    if (spare_limit.load(std::memory_order_acquire) > 0) {
+        conn->close();
+        conn->reset();
+        auto& sh = *shards[conn->registry_shard];
+        std::unique_lock<std::mutex> guard{sh.mutex};
+        if (sh.spare_count < spare_limit.load(std::memory_order_acquire)) {
+            conn->registry_next = sh.spare_head;
+            sh.spare_head = conn;
+            sh.spare_count += 1;
+            guard.unlock();
+            if (registered) {
+                decrement_count();
+            }
+            return;
+        }
+    }
+    delete conn;
+    if (registered) {
+        decrement_count();
+    }
+}
+
+tcp_connection* tcp_connection_registry::take_spare(uint32_t shard_idx) {
+    auto& sh = *shards[shard_idx % shards.size()];
+    std::lock_guard<std::mutex> guard{sh.mutex};
+    tcp_connection* conn = sh.spare_head;
+    if (nullptr != conn) {
+        sh.spare_head = conn->registry_next;
+        sh.spare_count -= 1;
+        conn->registry_next = nullptr;
+    }
+    return conn;
+}
+
+void tcp_connection_registry::set_read_buffer_limit(uint32_t limit) {
+    for (auto& sh : shards) {
+        sh->buffers.set_spare_limit(limit);
+    }
+}
+
+void tcp_connection_registry::set_content_buffer_limit(std::size_t limit) {
+    for (auto& sh : shards) {
+        sh->content_buffers->set_spare_limit(limit);
+    }
+}
+
+void tcp_connection_registry::clear_spare() {
+    spare_limit.store(0, std::memory_order_release);
+    for (auto& sh : shards) {
+        tcp_connection* conn = nullptr;
+        {
+            std::lock_guard<std::mutex> guard{sh->mutex};
+            conn = sh->spare_head;
+            sh->spare_head = nullptr;
+            sh->spare_count = 0;
+        }
+        while (nullptr != conn) {
+            tcp_connection* next = conn->registry_next;
+            delete conn;
+            conn = next;
+        }
+    }
+}
+
+void tcp_connection_registry::for_each(const std::function<void(tcp_connection&)>& fun) {
+    for (auto& sh : shards) {
+        std::lock_guard<std::mutex> guard{sh->mutex};
+        for (tcp_connection* conn = sh->head; nullptr != conn; conn = conn->registry_next) {
+            fun(*conn);
+        }
+    }
+}
+
+bool tcp_connection_registry::unlink(tcp_connection& conn) {
+    auto& sh = *shards[conn.registry_shard];
+    std::lock_guard<std::mutex> guard{sh.mutex};
+    if (!conn.registered) {
+        return false;
+    }
+    if (nullptr != conn.registry_prev) {
+        conn.registry_prev->registry_next = conn.registry_next;
+    } else {
+        sh.head = conn.registry_next;
+    }
+    if (nullptr != conn.registry_next) {
+        conn.registry_next->registry_prev = conn.registry_prev;
+    }
+    conn.registry_prev = nullptr;
+    conn.registry_next = nullptr;
+    conn.registered = false;
+    return true;
+}
+
+void tcp_connection_registry::decrement_count() {
+    // global lock is only taken when the last connection is removed
+    if (1 == count.fetch_sub(1, std::memory_order_acq_rel)) {
+        std::lock_guard<std::mutex> guard{empty_mutex};
+        no_more_connections.notify_all();
+    }
+}
+
+bool tcp_connection_registry::wait_empty(std::chrono::milliseconds timeout) {
+    std::unique_lock<std::mutex> guard{empty_mutex};
+    return no_more_connections.wait_for(guard, timeout, [this] {
+        return 0 == this->size();
+    });
+}
+
+} // namespace
+}
@@ -26,11 +26,20 @@
 #include "staticlib/pion/tcp_server.hpp"
 
 #include <functional>
+#include <future>
 #include <memory>
 
 #include "asio.hpp"
 
+#ifdef __linux__
+#include <linux/filter.h>
+#endif // __linux__
+#ifndef _WIN32
+#include <netinet/tcp.h>
+#endif // !_WIN32
+
 #include "staticlib/pion/logger.hpp"
+#include "staticlib/pion/pion_exception.hpp"
 #include "staticlib/pion/scheduler.hpp"
 #include "staticlib/pion/tcp_connection.hpp"
 
@@ -41,10 +50,72 @@ namespace { // anonymous
 
 const std::string log = "staticlib.pion.tcp_server";
 
+#ifdef SO_REUSEPORT
+using reuse_port_option = asio::detail::socket_option::boolean<SOL_SOCKET, SO_REUSEPORT>;
+#endif // SO_REUSEPORT
+#ifdef TCP_DEFER_ACCEPT
+using defer_accept_option = asio::detail::socket_option::integer<IPPROTO_TCP, TCP_DEFER_ACCEPT>;
+#endif // TCP_DEFER_ACCEPT
+#ifdef TCP_FASTOPEN
+using fast_open_option = asio::detail::socket_option::integer<IPPROTO_TCP, TCP_FASTOPEN>;
+#endif // TCP_FASTOPEN
+#ifdef TCP_NOTSENT_LOWAT
+using not_sent_lowat_option = asio::detail::socket_option::integer<IPPROTO_TCP, TCP_NOTSENT_LOWAT>;
+#endif // TCP_NOTSENT_LOWAT
+#ifdef TCP_KEEPIDLE
+using keep_idle_option = asio::detail::socket_option::integer<IPPROTO_TCP, TCP_KEEPIDLE>;
+#endif // TCP_KEEPIDLE
+#ifdef TCP_KEEPINTVL
+using keep_interval_option = asio::detail::socket_option::integer<IPPROTO_TCP, TCP_KEEPINTVL>;
+#endif // TCP_KEEPINTVL
+#ifdef TCP_KEEPCNT
+using keep_count_option = asio::detail::socket_option::integer<IPPROTO_TCP, TCP_KEEPCNT>;
+#endif // TCP_KEEPCNT
+
+template<typename Socket, typename Option>
+void set_socket_option(Socket& socket, const Option& option, const char* name) {
+    std::error_code ec;
+    socket.set_option(option, ec);
+    if (ec) {
+        STATICLIB_PION_LOG_WARN(log, "Unable to set socket option: [" << name << "], error: [" << ec.message() << "]");
+    }
+}
+
+bool attach_cpu_steering(asio::ip::tcp::acceptor& acceptor, uint32_t group_size) {
+#ifdef SO_ATTACH_REUSEPORT_CBPF
+    struct sock_filter code[] = {
+        // A = index of the CPU that received the packet
+        { BPF_LD | BPF_W | BPF_ABS, 0, 0, static_cast<uint32_t>(SKF_AD_OFF + SKF_AD_CPU) },
+        // A = A % group_size
+        { BPF_ALU | BPF_MOD | BPF_K, 0, 0, group_size },
+        // return A, it is used as an index of the socket in SO_REUSEPORT group
+        { BPF_RET | BPF_A, 0, 0, 0 }
+    };
+    struct sock_fprog prog;
+    prog.len = sizeof(code) / sizeof(code[0]);
+    prog.filter = code;
+    int err = setsockopt(acceptor.native_handle(), SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF,
+            std::addressof(prog), sizeof(prog));
+    return 0 == err;
+#else // !SO_ATTACH_REUSEPORT_CBPF
+    (void) acceptor;
+    (void) group_size;
+    return false;
+#endif // SO_ATTACH_REUSEPORT_CBPF
+}
+
 } // namespace
 
 // tcp::server member functions
 
+void tcp_server::set_options(const tcp_server_options& opts) {
+    std::lock_guard<std::mutex> server_lock(mutex);
+    if (listening) {
+        throw pion_exception("Server options cannot be changed while the server is listening");
+    }
+    this->options = opts;
+}
+
 void tcp_server::start() {
     // lock mutex for thread safety
     std::unique_lock<std::mutex> server_lock(mutex);
@@ -58,35 +129,168 @@ void tcp_server::start() {
         try {
             // get admin permissions in case we're binding to a privileged port
 //            admin_rights use_admin_rights(m_endpoint.port() > 0 && m_endpoint.port() < 1024);
-            tcp_acceptor.open(tcp_endpoint.protocol());
-            // allow the acceptor to reuse the address (i.e. SO_REUSEADDR)
-            // ...except when running not on Windows - see http://msdn.microsoft.com/en-us/library/ms740621%28VS.85%29.aspx
-#ifndef _MSC_VER
-            tcp_acceptor.set_option(asio::ip::tcp::acceptor::reuse_address(true));
-#endif
-            tcp_acceptor.bind(tcp_endpoint);
-            if (tcp_endpoint.port() == 0) {
-                // update the endpoint to reflect the port chosen by bind
-                tcp_endpoint = tcp_acceptor.local_endpoint();
-            }
-            tcp_acceptor.listen();
+            open_acceptors();
         } catch (std::exception& e) {
             (void) e;
+            acceptors.clear();
+            acceptor_strands.clear();
             STATICLIB_PION_LOG_ERROR(log, "Unable to bind to port " << tcp_endpoint.port() << ": " << e.what());
             throw;
         }
 
         listening = true;
+        conn_registry->set_spare_limit(options.connection_pool_size);
+        conn_registry->set_read_buffer_limit(options.read_buffer_pool_size);
+        conn_registry->set_content_buffer_limit(options.content_buffer_pool_bytes);
+        if (nullptr == disk_pool.get() && options.disk_io_threads > 0) {
+            disk_pool.reset(new disk_io_pool(options.disk_io_threads));
+        }
 
-        // unlock the mutex since listen() requires its own lock
+        // first accept on each acceptor is started on its strand
+        std::size_t acceptors_count = acceptors.size();
         server_lock.unlock();
-        listen();
+        for (std::size_t i = 0; i < acceptors_count; i++) {
+            acceptor_strands[i]->dispatch([this, i]() {
+                this->listen(i);
+            });
+        }
         
         // notify the thread scheduler that we need it now
         active_scheduler.add_active_user();
     }
 }
 
+void tcp_server::open_acceptors() {
+    // assumes that a server lock has already been acquired
+    uint32_t count = 1;
+    if (options.reuse_port) {
+#ifdef SO_REUSEPORT
+        count = active_scheduler.get_num_threads();
+#else // !SO_REUSEPORT
+        STATICLIB_PION_LOG_WARN(log, "SO_REUSEPORT is not supported, using single acceptor");
+#endif // SO_REUSEPORT
+    }
+    // previous acceptors are kept after stop() until here, their handlers are finished
+    // as all the connections (including ones waiting to be accepted) are gone
+    acceptors.clear();
+    acceptor_strands.clear();
+    for (uint32_t i = 0; i < count; i++) {
+        // acceptor N uses the IO service N, connections accepted by it stay on the same loop
+        acceptors.emplace_back(new asio::ip::tcp::acceptor(active_scheduler.get_io_service(i)));
+        acceptor_strands.emplace_back(new asio::io_service::strand(active_scheduler.get_io_service(i)));
+        auto& acceptor = *acceptors.back();
+        acceptor.open(tcp_endpoint.protocol());
+        // allow the acceptor to reuse the address (i.e. SO_REUSEADDR)
+        // ...except when running not on Windows - see http://msdn.microsoft.com/en-us/library/ms740621%28VS.85%29.aspx
+#ifndef _MSC_VER
+        acceptor.set_option(asio::ip::tcp::acceptor::reuse_address(true));
+#endif
+#ifdef SO_REUSEPORT
+        if (options.reuse_port) {
+            acceptor.set_option(reuse_port_option(true));
+        }
+#endif // SO_REUSEPORT
+        apply_acceptor_options(acceptor);
+        acceptor.bind(tcp_endpoint);
+        if (tcp_endpoint.port() == 0) {
+            // update the endpoint to reflect the port chosen by bind,
+            // other acceptors will be bound to the same port
+            tcp_endpoint = acceptor.local_endpoint();
+        }
+        if (options.listen_backlog > 0) {
+            acceptor.listen(static_cast<int>(options.listen_backlog));
+        } else {
+            acceptor.listen();
+        }
+    }
+    if (count > 1 && options.reuse_port_cpu_steering) {
+        if (!attach_cpu_steering(*acceptors.front(), count)) {
+            STATICLIB_PION_LOG_WARN(log, "Unable to attach CPU steering program to SO_REUSEPORT group");
+        } else if (active_scheduler.get_io_services_count() > 1) {
+            // connection received on CPU N goes to the acceptor N, its service
+            // is run by the thread N, that is pinned to the same CPU
+            if (!active_scheduler.is_running()) {
+                active_scheduler.set_thread_affinity(true);
+            } else {
+                STATICLIB_PION_LOG_WARN(log, "Scheduler is already running, its threads are not pinned to CPUs");
+            }
+        }
+    }
+}
+
+void tcp_server::apply_acceptor_options(asio::ip::tcp::acceptor& acceptor) {
+    // assumes that a server lock has already been acquired
+    if (options.defer_accept_seconds > 0) {
+#ifdef TCP_DEFER_ACCEPT
+        set_socket_option(acceptor, defer_accept_option(static_cast<int>(options.defer_accept_seconds)),
+                "TCP_DEFER_ACCEPT");
+#else // !TCP_DEFER_ACCEPT
+        STATICLIB_PION_LOG_WARN(log, "Socket option is not supported: [TCP_DEFER_ACCEPT]");
+#endif // TCP_DEFER_ACCEPT
+    }
+    if (options.fast_open_queue_length > 0) {
+#ifdef TCP_FASTOPEN
+        set_socket_option(acceptor, fast_open_option(static_cast<int>(options.fast_open_queue_length)),
+                "TCP_FASTOPEN");
+#else // !TCP_FASTOPEN
+        STATICLIB_PION_LOG_WARN(log, "Socket option is not supported: [TCP_FASTOPEN]");
+#endif // TCP_FASTOPEN
+    }
+    // receive buffer must be set before listen() to affect the window scale
+    // negotiated in SYN-ACK, accepted sockets inherit it
+    if (options.receive_buffer_size > 0) {
+        set_socket_option(acceptor, asio::socket_base::receive_buffer_size(
+                static_cast<int>(options.receive_buffer_size)), "SO_RCVBUF");
+    }
+}
+
+void tcp_server::apply_socket_options(tcp_connection& tcp_conn) {
+    // options are not changed while the server is listening, so no lock is needed
+    auto& socket = tcp_conn.get_socket();
+    if (options.tcp_no_delay) {
+        set_socket_option(socket, asio::ip::tcp::no_delay(true), "TCP_NODELAY");
+    }
+    if (options.send_buffer_size > 0) {
+        set_socket_option(socket, asio::socket_base::send_buffer_size(
+                static_cast<int>(options.send_buffer_size)), "SO_SNDBUF");
+    }
+    if (options.not_sent_low_watermark > 0) {
+#ifdef TCP_NOTSENT_LOWAT
+        set_socket_option(socket, not_sent_lowat_option(static_cast<int>(options.not_sent_low_watermark)),
+                "TCP_NOTSENT_LOWAT");
+#else // !TCP_NOTSENT_LOWAT
+        STATICLIB_PION_LOG_WARN(log, "Socket option is not supported: [TCP_NOTSENT_LOWAT]");
+#endif // TCP_NOTSENT_LOWAT
+    }
+    if (options.keep_alive) {
+        set_socket_option(socket, asio::socket_base::keep_alive(true), "SO_KEEPALIVE");
+        if (options.keep_alive_idle_seconds > 0) {
+#ifdef TCP_KEEPIDLE
+            set_socket_option(socket, keep_idle_option(static_cast<int>(options.keep_alive_idle_seconds)),
+                    "TCP_KEEPIDLE");
+#else // !TCP_KEEPIDLE
+            STATICLIB_PION_LOG_WARN(log, "Socket option is not supported: [TCP_KEEPIDLE]");
+#endif // TCP_KEEPIDLE
+        }
+        if (options.keep_alive_interval_seconds > 0) {
+#ifdef TCP_KEEPINTVL
+            set_socket_option(socket, keep_interval_option(static_cast<int>(options.keep_alive_interval_seconds)),
+                    "TCP_KEEPINTVL");
+#else // !TCP_KEEPINTVL
+            STATICLIB_PION_LOG_WARN(log, "Socket option is not supported: [TCP_KEEPINTVL]");
+#endif // TCP_KEEPINTVL
+        }
+        if (options.keep_alive_count > 0) {
+#ifdef TCP_KEEPCNT
+            set_socket_option(socket, keep_count_option(static_cast<int>(options.keep_alive_count)),
+                    "TCP_KEEPCNT");
+#else // !TCP_KEEPCNT
+            STATICLIB_PION_LOG_WARN(log, "Socket option is not supported: [TCP_KEEPCNT]");
+#endif // TCP_KEEPCNT
+        }
+    }
+}
+
 void tcp_server::stop(bool wait_until_finished) {
     // lock mutex for thread safety
     std::unique_lock<std::mutex> server_lock(mutex);
@@ -96,25 +300,40 @@ void tcp_server::stop(bool wait_until_finished) {
 
         listening = false;
 
-        // this terminates any connections waiting to be accepted
-        tcp_acceptor.close();
-        
+        // this terminates any connections waiting to be accepted, acceptor is
+        // closed on its strand, so it does not race with listen() that takes no lock
+        std::vector<std::future<void>> closed;
+        for (std::size_t i = 0; i < acceptors.size(); i++) {
+            auto promise = std::make_shared<std::promise<void>>();
+            closed.emplace_back(promise->get_future());
+            auto acceptor = acceptors[i].get();
+            acceptor_strands[i]->dispatch([acceptor, promise]() {
+                try {
+                    acceptor->close();
+                } catch (const std::exception& e) {
+                    (void) e;
+                    STATICLIB_PION_LOG_WARN(log, "Error closing acceptor: " << e.what());
+                }
+                promise->set_value();
+            });
+        }
+
         if (! wait_until_finished) {
             // this terminates any other open connections
-            for (tcp_connection_ptr conn : conn_pool) {
-                conn->close();
-            }
+            conn_registry->for_each([](tcp_connection& conn) {
+                conn.close();
+            });
         }
 
-        // wait for all pending connections to complete
-        while (!conn_pool.empty()) {
-            // try to prun connections that didn't finish cleanly
-            if (prune_connections() == 0) {
-                break;  // if no more left, then we can stop waiting
-            }
-            // sleep for up to a quarter second to give open connections a chance to finish
+        // wait for all pending connections to complete, connections that
+        // did not finish cleanly are removed when their last reference is released;
+        // the lock is released while waiting so that handlers can proceed
+        server_lock.unlock();
+        for (auto& fut : closed) {
+            fut.wait();
+        }
+        while (!conn_registry->wait_empty(std::chrono::milliseconds(250))) {
             STATICLIB_PION_LOG_INFO(log, "Waiting for open connections to finish");
-            no_more_connections.wait_for(server_lock, std::chrono::milliseconds(250));
         }
 
         // notify the thread scheduler that we no longer need it
@@ -126,38 +345,68 @@ void tcp_server::stop(bool wait_until_finished) {
     }
 }
 
-void tcp_server::listen() {
-    // lock mutex for thread safety
-    std::lock_guard<std::mutex> server_lock(mutex);
-
-    if (listening) {
+void tcp_server::listen(std::size_t acceptor_idx) {
+    // runs on the acceptor strand, acceptors and options are not changed
+    // while the server is listening, so no lock is needed
+    if (listening && acceptor_idx < acceptors.size()) {
         // create a new TCP connection object
         tcp_connection::connection_handler fc = [this](std::shared_ptr<tcp_connection>& conn) {
             this->finish_connection(conn);
         };
-        auto new_connection = std::make_shared<tcp_connection>(
-                get_io_service(), ssl_context, ssl_flag, std::move(fc));
-
-        // prune connections that finished uncleanly
-        prune_connections();
-
-        // keep track of the object in the server's connection pool
-        conn_pool.insert(new_connection);
-
-        // use the object to accept a new connection
-        auto cb = [this, new_connection](const std::error_code& ec) mutable {
-            this->handle_accept(new_connection, ec);
+        // connections are spread across the scheduler services, when
+        // running one service per thread, each connection stays on its own loop;
+        // with multiple acceptors, connection uses the same service as its acceptor
+        uint32_t service_idx = acceptors.size() > 1 ? static_cast<uint32_t>(acceptor_idx) :
+                active_scheduler.next_io_service_index();
+        auto& service = active_scheduler.get_io_service(service_idx);
+        // closed connection objects are reused when available,
+        // with one service per thread each loop gets its own registry shard
+        uint32_t shard_idx = active_scheduler.get_io_services_count() > 1 ? service_idx :
+                conn_registry->next_shard_index();
+        tcp_connection* conn = conn_registry->take_spare(shard_idx);
+        if (nullptr != conn && std::addressof(conn->get_io_service()) != std::addressof(service)) {
+            delete conn;
+            conn = nullptr;
+        }
+#ifndef STATICLIB_PION_DISABLE_SSL
+        if (nullptr == conn && nullptr != ssl_context.get()) {
+            conn = new tcp_connection(service, *ssl_context, true, std::move(fc));
+        }
+#endif // STATICLIB_PION_DISABLE_SSL
+        if (nullptr == conn) {
+            conn = new tcp_connection(service, std::move(fc));
+        }
+        // read buffer is borrowed from the pool of the same shard as the connection
+        conn->set_read_buffer_pool(options.read_buffer_pool_size > 0 ?
+                std::addressof(conn_registry->get_read_buffer_pool(shard_idx)) : nullptr);
+        // request bodies are stored in the content buffers of the same shard
+        conn->set_content_buffer_pool(options.content_buffer_pool_bytes > 0 ?
+                conn_registry->get_content_buffer_pool(shard_idx) : nullptr);
+        conn->set_disk_io_pool(disk_pool.get());
+        auto registry = conn_registry;
+        auto new_connection = tcp_connection_ptr(conn, [registry](tcp_connection* released) {
+            registry->release(released);
+        });
+
+        // keep track of the object in the server's connection registry
+        conn_registry->insert(*new_connection, shard_idx);
+
+        // use the object to accept a new connection, the next listen()
+        // call is made from the handler on the same strand
+        auto cb = [this, acceptor_idx, new_connection](const std::error_code& ec) mutable {
+            this->handle_accept(acceptor_idx, new_connection, ec);
         };
-        new_connection->async_accept(tcp_acceptor, std::move(cb));
+        new_connection->async_accept(*acceptors[acceptor_idx], acceptor_strands[acceptor_idx]->wrap(std::move(cb)));
     }
 }
 
-void tcp_server::handle_accept(tcp_connection_ptr& tcp_conn, const std::error_code& accept_error) {
+void tcp_server::handle_accept(std::size_t acceptor_idx, tcp_connection_ptr& tcp_conn,
+        const std::error_code& accept_error) {
     if (accept_error) {
         // an error occured while trying to a accept a new connection
         // this happens when the server is being shut down
         if (listening) {
-            listen();   // schedule acceptance of another connection
+            listen(acceptor_idx);   // schedule acceptance of another connection
             STATICLIB_PION_LOG_WARN(log, "Accept error on port " << tcp_endpoint.port() << ": " << accept_error.message());
         }
         finish_connection(tcp_conn);
@@ -169,22 +418,41 @@ void tcp_server::handle_accept(tcp_connection_ptr& tcp_conn, const std::error_co
         // schedule the acceptance of another new connection
         // (this returns immediately since it schedules it as an event)
         if (listening) {
-            listen();
+            listen(acceptor_idx);
         }
+
+        apply_socket_options(*tcp_conn);
         
-        // handle the new connection
-        if (tcp_conn->get_ssl_flag()) {
-            auto cb = [this, tcp_conn](const std::error_code & ec) mutable {
-                this->handle_ssl_handshake(tcp_conn, ec);
-            };
-            tcp_conn->async_handshake_server(std::move(cb));
+        // handle the new connection on the service it belongs to, accept handler
+        // runs on the service of the acceptor, that is the connection's service
+        // when each service has its own acceptor
+        auto& acceptor_service = active_scheduler.get_io_service(static_cast<uint32_t>(acceptor_idx));
+        if (std::addressof(tcp_conn->get_io_service()) == std::addressof(acceptor_service)) {
+            handle_new_connection(tcp_conn);
         } else {
-            // not SSL -> call the handler immediately
-            handle_connection(tcp_conn);
+            auto cb = [this, tcp_conn]() mutable {
+                this->handle_new_connection(tcp_conn);
+            };
+            tcp_conn->get_io_service().post(std::move(cb));
         }
     }
 }
 
+void tcp_server::handle_new_connection(tcp_connection_ptr& tcp_conn) {
+#ifndef STATICLIB_PION_DISABLE_SSL
+    if (tcp_conn->get_ssl_flag()) {
+        auto cb = [this, tcp_conn](const std::error_code & ec) mutable {
+            this->handle_ssl_handshake(tcp_conn, ec);
+        };
+        tcp_conn->async_handshake_server(std::move(cb));
+        return;
+    }
+#endif // STATICLIB_PION_DISABLE_SSL
+    // not SSL -> call the handler immediately
+    handle_connection(tcp_conn);
+}
+
+#ifndef STATICLIB_PION_DISABLE_SSL
 void tcp_server::handle_ssl_handshake(tcp_connection_ptr& tcp_conn,
                                    const std::error_code& handshake_error) {
     if (handshake_error) {
@@ -198,9 +466,9 @@ void tcp_server::handle_ssl_handshake(tcp_connection_ptr& tcp_conn,
         handle_connection(tcp_conn);
     }
 }
+#endif // STATICLIB_PION_DISABLE_SSL
 
 void tcp_server::finish_connection(tcp_connection_ptr& tcp_conn) {
-    std::lock_guard<std::mutex> server_lock(mutex);
     if (listening && tcp_conn->get_keep_alive()) {
         
         // keep the connection alive
@@ -208,37 +476,10 @@ void tcp_server::finish_connection(tcp_connection_ptr& tcp_conn) {
 
     } else {
         STATICLIB_PION_LOG_DEBUG(log, "Closing connection on port " << tcp_endpoint.port());
-        
-        // remove the connection from the server's management pool
-        std::set<tcp_connection_ptr>::iterator conn_itr = conn_pool.find(tcp_conn);
-        if (conn_itr != conn_pool.end()) {
-            conn_pool.erase(conn_itr);
-        }
-
-        // trigger the no more connections condition if we're waiting to stop
-        if (!listening && conn_pool.empty()) {
-            no_more_connections.notify_all();
-        }
-    }
-}
 
-std::size_t tcp_server::prune_connections() {
-    // assumes that a server lock has already been acquired
-    std::set<tcp_connection_ptr>::iterator conn_itr = conn_pool.begin();
-    while (conn_itr != conn_pool.end()) {
-        if (conn_itr->unique()) {
-            STATICLIB_PION_LOG_WARN(log, "Closing orphaned connection on port " << tcp_endpoint.port());
-            std::set<tcp_connection_ptr>::iterator erase_itr = conn_itr;
-            ++conn_itr;
-            (*erase_itr)->close();
-            conn_pool.erase(erase_itr);
-        } else {
-            ++conn_itr;
-        }
+        // connection is closed and removed from the server's registry
+        // when the last reference to it is released
     }
-
-    // return the number of connections remaining
-    return conn_pool.size();
 }
 
 } // namespace
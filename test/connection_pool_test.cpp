@@ -0,0 +1,117 @@
+/*
+ * Copyright 2026, alex at staticlibs.net
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   connection_pool_test.cpp
+ * Author: alex
+ *
+ * Created on October 17, 2026, 12:20 AM
+ */
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+
+#include "asio.hpp"
+
+#include "staticlib/config/assert.hpp"
+
+#include "staticlib/pion/http_server.hpp"
+
+const uint16_t TCP_PORT = 8081;
+const size_t WARMUP_CONNECTIONS = 200;
+const size_t CONNECTIONS = 2000;
+
+std::atomic<size_t> allocations_count{0};
+
+void* operator new(std::size_t size) {
+    allocations_count.fetch_add(1, std::memory_order_relaxed);
+    void* ptr = std::malloc(size > 0 ? size : 1);
+    if (nullptr == ptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void operator delete(void* ptr) STATICLIB_NOEXCEPT {
+    std::free(ptr);
+}
+
+void hello(sl::pion::http_request_ptr, sl::pion::response_writer_ptr resp) {
+    resp->write("hello");
+    resp->send(std::move(resp));
+}
+
+// connects, sends request and reads the response until the server closes connection
+void request_once(asio::io_service& io_service, const asio::ip::tcp::endpoint& endpoint) {
+    static const std::string request = "GET /hello HTTP/1.1\r\nHost: 127.0.0.1\r\nConnection: close\r\n\r\n";
+    asio::ip::tcp::socket socket{io_service};
+    socket.connect(endpoint);
+    asio::write(socket, asio::buffer(request));
+    char buf[1024];
+    std::error_code ec;
+    size_t read = socket.read_some(asio::buffer(buf), ec);
+    slassert(!ec && read > 0);
+    while (!ec) {
+        socket.read_some(asio::buffer(buf), ec);
+    }
+    slassert(asio::error::eof == ec);
+}
+
+// returns the number of allocations per connection
+size_t churn(uint32_t pool_size) {
+    sl::pion::http_server server(2, TCP_PORT);
+    auto opts = sl::pion::tcp_server_options();
+    opts.connection_pool_size = pool_size;
+    server.set_options(opts);
+    server.add_handler("GET", "/hello", hello);
+    server.start();
+
+    asio::io_service io_service;
+    asio::ip::tcp::endpoint endpoint{asio::ip::address_v4::from_string("127.0.0.1"), TCP_PORT};
+    for (size_t i = 0; i < WARMUP_CONNECTIONS; i++) {
+        request_once(io_service, endpoint);
+    }
+    size_t allocs_before = allocations_count.load();
+    for (size_t i = 0; i < CONNECTIONS; i++) {
+        request_once(io_service, endpoint);
+    }
+    size_t allocs = allocations_count.load() - allocs_before;
+    server.stop(true);
+    return allocs / CONNECTIONS;
+}
+
+void test_churn() {
+    auto no_pool = churn(0);
+    auto pool = churn(64);
+    std::cout << "connection churn, allocations per connection: without pool: [" <<
+            no_pool << "], with pool: [" << pool << "]" << std::endl;
+    // both runs make the same client-side allocations, only the server side differs
+    slassert(pool < no_pool);
+}
+
+int main() {
+    try {
+        test_churn();
+    } catch (const std::exception& e) {
+        std::cout << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,520 @@
+/*
+ * Copyright 2026, alex at staticlibs.net
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   http_parser_test.cpp
+ * Author: alex
+ *
+ * Created on October 17, 2026, 4:30 PM
+ */
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <system_error>
+
+#include "staticlib/config/assert.hpp"
+#include "staticlib/io.hpp"
+
+#include "staticlib/pion/content_buffer_pool.hpp"
+#include "staticlib/pion/http_parser.hpp"
+#include "staticlib/pion/http_request.hpp"
+#include "staticlib/pion/pion_exception.hpp"
+
+const std::string REQUEST = "POST /some/path?foo=bar&baz=42 HTTP/1.1\r\n"
+        "Host: 127.0.0.1\r\n"
+        "X-Empty:\r\n"
+        "X-Multi: first\r\n"
+        "Cookie: c1=v1\r\n"
+        "x-multi:  second, third\r\n"
+        "X-Long-Header-Name~With-Tilde: value\twith tab and a long enough tail \xD0\xB0\r\n"
+        "Content-Length: 5\r\n"
+        "\r\n"
+        "hello";
+
+const std::string CHUNKED_REQUEST = "POST /upload HTTP/1.1\r\n"
+        "Host: 127.0.0.1\r\n"
+        "Transfer-Encoding: chunked\r\n"
+        "\r\n"
+        "5\r\n"
+        "hello\r\n"
+        "1A;ext=foo\r\n"
+        "abcdefghijklmnopqrstuvwxyz\r\n"
+        "0000000000000001 \r\n"
+        "!\r\n"
+        "0\r\n"
+        "\r\n";
+
+const std::string CHUNKED_CONTENT = "helloabcdefghijklmnopqrstuvwxyz!";
+
+// feeds request to parser in pieces of specified length
+sl::support::tribool parse_in_pieces(sl::pion::http_parser& parser, sl::pion::http_request& req,
+        size_t piece_len, const std::string& request = REQUEST) {
+    sl::support::tribool rc = sl::support::indeterminate;
+    size_t offset = 0;
+    while (sl::support::indeterminate(rc) && offset < request.length()) {
+        size_t len = std::min(piece_len, request.length() - offset);
+        // copy to make sure parser does not keep pointers to the consumed data
+        std::string piece = request.substr(offset, len);
+        parser.set_read_buffer(piece.data(), piece.length());
+        std::error_code ec;
+        rc = parser.parse(req, ec);
+        slassert(!ec);
+        offset += len;
+        piece.assign(piece.length(), 'X');
+    }
+    return rc;
+}
+
+void check_request(sl::pion::http_request& req) {
+    slassert(req.is_valid());
+    slassert("POST" == req.get_method());
+    slassert("/some/path" == req.get_resource());
+    slassert("foo=bar&baz=42" == req.get_query_string());
+    slassert("bar" == req.get_query("foo"));
+    slassert("42" == req.get_query("baz"));
+    slassert("127.0.0.1" == req.get_header("host"));
+    slassert("127.0.0.1" == req.get_header(sl::pion::http_message::HEADER_ID_HOST));
+    slassert(req.has_header(sl::pion::http_message::HEADER_ID_COOKIE));
+    slassert(!req.has_header(sl::pion::http_message::HEADER_ID_TRANSFER_ENCODING));
+    slassert(req.has_header("X-Empty"));
+    slassert(req.get_header("X-Empty").empty());
+    slassert(!req.has_header("X-Missing"));
+    slassert(req.get_header("X-Missing").empty());
+    slassert("first" == req.get_header("X-MULTI"));
+    slassert(req.has_header_value("X-Multi", "third"));
+    slassert(!req.has_header_value("X-Multi", "fourth"));
+    slassert("v1" == req.get_cookie("c1"));
+    slassert(5 == req.get_content_length());
+    slassert("hello" == std::string(req.get_content(), req.get_content_length()));
+    // received headers are moved to multimap on direct access
+    slassert(7 == req.get_headers().size());
+    slassert("first" == req.get_header("X-Multi") || " second, third" == req.get_header("X-Multi"));
+    req.change_header("X-Multi", "changed");
+    slassert("changed" == req.get_header("x-multi"));
+}
+
+void test_split_reads(bool use_simd) {
+    sl::pion::http_parser parser;
+    parser.set_use_simd(use_simd);
+    sl::pion::http_request req;
+    for (size_t piece_len = 1; piece_len <= REQUEST.length(); piece_len++) {
+        parser.reset();
+        req.clear();
+        auto rc = parse_in_pieces(parser, req, piece_len);
+        slassert(true == rc);
+        check_request(req);
+        slassert("value\twith tab and a long enough tail \xD0\xB0" == req.get_header("x-long-header-name~with-tilde"));
+    }
+}
+
+sl::support::tribool parse_whole(const std::string& data, bool use_simd, std::error_code& ec) {
+    sl::pion::http_parser parser;
+    parser.set_use_simd(use_simd);
+    sl::pion::http_request req;
+    parser.set_read_buffer(data.data(), data.length());
+    return parser.parse(req, ec);
+}
+
+void test_invalid(bool use_simd) {
+    std::error_code ec;
+    // control char in the middle of a long value
+    auto rc = parse_whole("GET / HTTP/1.1\r\nX-Header: some long enough \x01 value\r\n\r\n", use_simd, ec);
+    slassert(false == rc);
+    slassert(sl::pion::http_parser::ERROR_HEADER_CHAR == ec.value());
+    // special char in a long header name
+    rc = parse_whole("GET / HTTP/1.1\r\nX-Long-Header(Name): value\r\n\r\n", use_simd, ec);
+    slassert(false == rc);
+    slassert(sl::pion::http_parser::ERROR_HEADER_CHAR == ec.value());
+    // header name over the limit
+    rc = parse_whole("GET / HTTP/1.1\r\n" + std::string(2048, 'a') + ": value\r\n\r\n", use_simd, ec);
+    slassert(false == rc);
+    slassert(sl::pion::http_parser::ERROR_HEADER_NAME_SIZE == ec.value());
+    // control char in a long URI
+    rc = parse_whole("GET /some/long/path/\x7F/to/resource HTTP/1.1\r\n\r\n", use_simd, ec);
+    slassert(false == rc);
+    slassert(sl::pion::http_parser::ERROR_URI_CHAR == ec.value());
+}
+
+void test_chunked() {
+    sl::pion::http_parser parser;
+    sl::pion::http_request req;
+    for (size_t piece_len = 1; piece_len <= CHUNKED_REQUEST.length(); piece_len++) {
+        parser.reset();
+        req.clear();
+        auto rc = parse_in_pieces(parser, req, piece_len, CHUNKED_REQUEST);
+        slassert(true == rc);
+        slassert(req.is_chunked());
+        slassert(CHUNKED_CONTENT.length() == req.get_content_length());
+        slassert(CHUNKED_CONTENT == std::string(req.get_content(), req.get_content_length()));
+        // content is null-terminated
+        slassert('\0' == req.get_content()[req.get_content_length()]);
+    }
+}
+
+void test_chunked_max_content_length() {
+    sl::pion::http_parser parser;
+    parser.set_max_content_length(7);
+    sl::pion::http_request req;
+    auto rc = parse_in_pieces(parser, req, 3, CHUNKED_REQUEST);
+    slassert(true == rc);
+    slassert("helloab" == std::string(req.get_content(), req.get_content_length()));
+}
+
+void test_content_limit() {
+    sl::pion::http_parser parser;
+    sl::pion::http_request req;
+    std::error_code ec;
+    // chunked content is counted against the limit
+    parser.set_content_limit(CHUNKED_CONTENT.length() - 1);
+    parser.set_read_buffer(CHUNKED_REQUEST.data(), CHUNKED_REQUEST.length());
+    auto rc = parser.parse(req, ec);
+    slassert(false == rc);
+    slassert(sl::pion::http_parser::ERROR_CONTENT_TOO_LARGE == ec.value());
+    // limit is cleared on reset
+    parser.reset();
+    req.clear();
+    parser.set_content_limit(CHUNKED_CONTENT.length());
+    rc = parse_in_pieces(parser, req, 5, CHUNKED_REQUEST);
+    slassert(true == rc);
+    slassert(CHUNKED_CONTENT == std::string(req.get_content(), req.get_content_length()));
+    // "Content-Length" is checked before reading the body
+    parser.reset();
+    req.clear();
+    ec = std::error_code();
+    parser.set_content_limit(4);
+    parser.set_read_buffer(REQUEST.data(), REQUEST.length());
+    rc = parser.parse(req, ec);
+    slassert(false == rc);
+    slassert(sl::pion::http_parser::ERROR_CONTENT_TOO_LARGE == ec.value());
+}
+
+void test_chunk_size_overflow() {
+    std::error_code ec;
+    auto rc = parse_whole("POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n"
+            "1" + std::string(sizeof(size_t) * 2, '0') + "\r\nx\r\n0\r\n\r\n", false, ec);
+    slassert(false == rc);
+    slassert(sl::pion::http_parser::ERROR_CHUNK_CHAR == ec.value());
+}
+
+// feeds request to parser in two pieces split at the specified position
+sl::support::tribool parse_split(sl::pion::http_parser& parser, sl::pion::http_request& req,
+        const std::string& request, size_t split) {
+    std::string first = request.substr(0, split);
+    parser.set_read_buffer(first.data(), first.length());
+    std::error_code ec;
+    auto rc = parser.parse(req, ec);
+    slassert(!ec);
+    first.assign(first.length(), 'X');
+    if (sl::support::indeterminate(rc)) {
+        std::string second = request.substr(split);
+        parser.set_read_buffer(second.data(), second.length());
+        rc = parser.parse(req, ec);
+        slassert(!ec);
+    }
+    return rc;
+}
+
+void test_chunked_body_splits() {
+    std::string body;
+    for (size_t i = 0; i < 700; i++) {
+        body.push_back(static_cast<char>('a' + (i % 26)));
+    }
+    // chunks of different sizes, hex digits in both cases and a chunk extension
+    std::string chunked = "POST /upload HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n"
+            "1\r\n" + body.substr(0, 1) + "\r\n"
+            "1f;ext=1\r\n" + body.substr(1, 31) + "\r\n"
+            "1A0\r\n" + body.substr(32, 416) + "\r\n"
+            "fc\r\n" + body.substr(448, 252) + "\r\n"
+            "0\r\n\r\n";
+    std::string plain = "POST /upload HTTP/1.1\r\nContent-Length: " +
+            sl::support::to_string(body.length()) + "\r\n\r\n" + body;
+    sl::pion::http_parser parser;
+    sl::pion::http_request req;
+    for (size_t split = 1; split < chunked.length(); split++) {
+        parser.reset();
+        req.clear();
+        slassert(true == parse_split(parser, req, chunked, split));
+        slassert(body == std::string(req.get_content(), req.get_content_length()));
+    }
+    for (size_t split = 1; split < plain.length(); split++) {
+        parser.reset();
+        req.clear();
+        slassert(true == parse_split(parser, req, plain, split));
+        slassert(body == std::string(req.get_content(), req.get_content_length()));
+    }
+}
+
+void test_content_pool() {
+    auto pool = std::make_shared<sl::pion::content_buffer_pool>(4194304);
+    sl::pion::http_parser parser;
+    sl::pion::http_request req;
+    req.set_content_buffer_pool(pool);
+    auto rc = parse_in_pieces(parser, req, 7);
+    slassert(true == rc);
+    slassert("hello" == std::string(req.get_content(), req.get_content_length()));
+    const char* data = req.get_content();
+    // content is moved out without copying
+    auto block = req.take_content();
+    slassert(data == block.data());
+    slassert("hello" == block.to_string());
+    slassert(sl::pion::content_buffer_pool::MIN_CLASS_CAPACITY == block.capacity());
+    slassert(0 == req.get_content_length());
+    slassert(0 == std::strlen(req.get_content()));
+    slassert(0 == pool->spare_count());
+    // destroyed block is returned to the pool and is reused for the next request
+    block.reset();
+    slassert(1 == pool->spare_count());
+    parser.reset();
+    req.clear();
+    rc = parse_in_pieces(parser, req, 7);
+    slassert(true == rc);
+    slassert(0 == pool->spare_count());
+    slassert(data == req.get_content());
+    slassert("hello" == std::string(req.get_content()));
+    req.clear();
+    slassert(1 == pool->spare_count());
+    // large blocks are not pooled, spare bytes are limited
+    slassert(1024 * 1024 == sl::pion::content_buffer_pool::class_capacity(1000 * 1000));
+    slassert(2000 * 1000 == sl::pion::content_buffer_pool::class_capacity(2000 * 1000));
+    sl::pion::content_buffer_pool::acquire(pool, 2000 * 1000);
+    slassert(1 == pool->spare_count());
+    pool->set_spare_limit(0);
+    slassert(0 == pool->spare_count());
+    sl::pion::content_buffer_pool::acquire(pool, 100);
+    slassert(0 == pool->spare_count());
+    // blocks outlive the pool owner
+    auto orphan = sl::pion::content_buffer_pool::acquire(pool, 100);
+    pool.reset();
+    orphan.reset();
+}
+
+// body of the class size fits the class together with the terminator
+void test_content_class_size() {
+    auto pool = std::make_shared<sl::pion::content_buffer_pool>(4194304);
+    sl::pion::http_parser parser;
+    sl::pion::http_request req;
+    req.set_content_buffer_pool(pool);
+    for (size_t len : {sl::pion::content_buffer_pool::MIN_CLASS_CAPACITY, static_cast<size_t>(1024 * 1024)}) {
+        std::string body(len, 'x');
+        std::string request = "POST / HTTP/1.1\r\nContent-Length: " + sl::support::to_string(len) + "\r\n\r\n" + body;
+        parser.reset();
+        req.clear();
+        auto rc = parse_in_pieces(parser, req, 65536, request);
+        slassert(true == rc);
+        slassert('\0' == req.get_content()[len]);
+        auto sized = req.take_content();
+        slassert(len == sized.capacity());
+        slassert(body == sized.to_string());
+        size_t spare_before = pool->spare_count();
+        sized.reset();
+        slassert(spare_before + 1 == pool->spare_count());
+    }
+}
+
+void test_content_spill() {
+    std::string body;
+    for (size_t i = 0; i < 100000; i++) {
+        body.push_back(static_cast<char>('a' + i % 26));
+    }
+    std::string plain = "POST /upload HTTP/1.1\r\nContent-Length: " +
+            sl::support::to_string(body.length()) + "\r\n\r\n" + body;
+    std::string chunked = "POST /upload HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n";
+    for (size_t i = 0; i < body.length(); i += 4096) {
+        auto chunk = body.substr(i, 4096);
+        std::stringstream ss;
+        ss << std::hex << chunk.length();
+        chunked += ss.str() + "\r\n" + chunk + "\r\n";
+    }
+    chunked += "0\r\n\r\n";
+    for (const std::string* request : {&plain, &chunked}) {
+        sl::pion::http_parser parser;
+        parser.set_content_spill(1024, "");
+        sl::pion::http_request req;
+        // small content stays in memory
+        auto rc = parse_in_pieces(parser, req, 7);
+        slassert(true == rc);
+        slassert(!req.is_content_spilled());
+        slassert("hello" == std::string(req.get_content()));
+        // large content is written to file
+        parser.reset();
+        req.clear();
+        rc = parse_in_pieces(parser, req, 3000, *request);
+        slassert(true == rc);
+        slassert(req.is_content_spilled());
+        slassert(body.length() == req.get_content_length());
+        auto src = req.get_content_source();
+        sl::io::string_sink sink;
+        sl::io::copy_all(src, sink);
+        slassert(body == sink.get_string());
+        // content is mapped on access and is null-terminated
+        slassert(body == std::string(req.get_content()));
+        bool thrown = false;
+        try {
+            req.take_content();
+        } catch (const sl::pion::pion_exception&) {
+            thrown = true;
+        }
+        slassert(thrown);
+        // max content length still applies
+        parser.reset();
+        req.clear();
+        parser.set_max_content_length(50000);
+        rc = parse_in_pieces(parser, req, 8192, *request);
+        slassert(true == rc);
+        slassert(req.is_content_spilled());
+        slassert(50000 == req.get_content_length());
+        slassert(body.substr(0, 50000) == std::string(req.get_content(), req.get_content_length()));
+        // file is dropped with the content
+        req.clear();
+        slassert(!req.is_content_spilled());
+    }
+    // file creation failure fails the request
+    sl::pion::http_parser parser;
+    parser.set_content_spill(1024, "/nonexistent/directory");
+    sl::pion::http_request req;
+    plain = plain.substr(0, plain.find("\r\n\r\n") + 4);
+    parser.set_read_buffer(plain.data(), plain.length());
+    std::error_code ec;
+    auto rc = parser.parse(req, ec);
+    slassert(false == rc);
+    slassert(sl::pion::http_parser::ERROR_CONTENT_FILE == ec.value());
+}
+
+void test_header_ids() {
+    namespace pn = sl::pion;
+    for (int id = 1; id < pn::http_message::HEADER_ID_COUNT; id++) {
+        auto name = pn::http_message::get_header_name(static_cast<pn::http_message::header_id>(id));
+        slassert(!name.empty());
+        slassert(id == pn::http_message::resolve_header_id(name.data(), name.length()));
+        std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+        slassert(id == pn::http_message::resolve_header_id(name.data(), name.length()));
+        name[0] = '#';
+        slassert(pn::http_message::HEADER_ID_UNKNOWN == pn::http_message::resolve_header_id(name.data(), name.length()));
+    }
+    slassert(pn::http_message::HEADER_ID_UNKNOWN == pn::http_message::resolve_header_id("", 0));
+    slassert(pn::http_message::HEADER_ID_UNKNOWN == pn::http_message::resolve_header_id("X-Multi", 7));
+}
+
+void test_iequals() {
+    namespace al = sl::pion::algorithm;
+    slassert(al::iequals("", 0, std::string()));
+    slassert(al::iequals("Content-Length", 14, std::string("CONTENT-length")));
+    slassert(al::iequals("X-Long-Header-Name~With-Tilde", 29, std::string("x-long-header-name~with-tilde")));
+    slassert(!al::iequals("Content-Length", 14, std::string("Content-Lengthx")));
+    slassert(!al::iequals("Content-Lengti", 14, std::string("Content-Length")));
+    // only letters are folded
+    slassert(!al::iequals("abc^defgh", 9, std::string("abc~defgh")));
+    slassert(!al::iequals("abcdefgh@", 9, std::string("abcdefgh`")));
+    slassert(!al::iequals("[]", 2, std::string("{}")));
+    slassert(!al::iequals("\xD0\xB0", 2, std::string("\xF0\x90")));
+    slassert(al::iequals("\xD0\xB0", 2, std::string("\xD0\xB0")));
+    // compare with byte-by-byte implementation for all pairs of bytes
+    for (int a = 0; a < 256; a++) {
+        for (int b = 0; b < 256; b++) {
+            char ca = static_cast<char>(a);
+            char cb = static_cast<char>(b);
+            std::string pa = std::string(10, 'x') + ca;
+            std::string pb = std::string(10, 'X') + cb;
+            bool expected = a == b || (a < 128 && std::isalpha(a) && std::tolower(a) == std::tolower(b));
+            slassert(expected == al::iequals(pa.data(), pa.length(), pb));
+            slassert(expected == al::iequals(&ca, 1, std::string(1, cb)));
+        }
+    }
+}
+
+void test_lazy_params() {
+    std::string data = "POST /form?a=1&b=x HTTP/1.1\r\n"
+            "Cookie: c1=v1; c2=v2\r\n"
+            "Content-Type: application/x-www-form-urlencoded; charset=UTF-8\r\n"
+            "Cookie: c3=v3\r\n"
+            "Content-Length: 10\r\n"
+            "\r\n"
+            "c=3&d=four";
+    sl::pion::http_parser parser;
+    sl::pion::http_request req;
+    parser.set_read_buffer(data.data(), data.length());
+    std::error_code ec;
+    auto rc = parser.parse(req, ec);
+    slassert(true == rc);
+    // decoded on first access
+    slassert("1" == req.get_query("a"));
+    slassert("x" == req.get_query("b"));
+    slassert("3" == req.get_query("c"));
+    slassert("four" == req.get_query("d"));
+    slassert(4 == req.get_queries().size());
+    req.add_query("e", "5");
+    slassert(5 == req.get_queries().size());
+    slassert(req.has_cookie("c1"));
+    slassert("v2" == req.get_cookie("c2"));
+    slassert("v3" == req.get_cookie("c3"));
+    slassert(3 == req.get_cookies().size());
+    // modifications before first access are merged with received values
+    parser.reset();
+    req.clear();
+    parser.set_read_buffer(data.data(), data.length());
+    rc = parser.parse(req, ec);
+    slassert(true == rc);
+    req.delete_query("a");
+    req.change_cookie("c1", "changed");
+    slassert(3 == req.get_queries().size());
+    slassert("changed" == req.get_cookie("c1"));
+    slassert("v3" == req.get_cookie("c3"));
+    // cleared request has no parameters
+    req.clear();
+    slassert(req.get_queries().empty());
+    slassert(req.get_cookies().empty());
+}
+
+void test_raw_headers() {
+    sl::pion::http_parser parser;
+    parser.set_save_raw_headers(true);
+    sl::pion::http_request req;
+    auto rc = parse_in_pieces(parser, req, 7);
+    slassert(true == rc);
+    auto headers_len = REQUEST.find("\r\n\r\n") + 4;
+    slassert(REQUEST.substr(0, headers_len) == parser.get_raw_headers());
+    slassert(REQUEST.substr(0, headers_len) == req.get_header_block());
+}
+
+int main() {
+    try {
+        test_split_reads(false);
+        test_split_reads(true);
+        test_invalid(false);
+        test_invalid(true);
+        test_raw_headers();
+        test_lazy_params();
+        test_header_ids();
+        test_iequals();
+        test_chunked();
+        test_chunked_max_content_length();
+        test_content_limit();
+        test_chunk_size_overflow();
+        test_chunked_body_splits();
+        test_content_pool();
+        test_content_class_size();
+        test_content_spill();
+    } catch (const std::exception& e) {
+        std::cout << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,142 @@
+/*
+ * Copyright 2026, alex at staticlibs.net
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   http_response_test.cpp
+ * Author: alex
+ *
+ * Created on October 18, 2026, 1:10 AM
+ */
+
+#include <atomic>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "staticlib/config/assert.hpp"
+
+#include "staticlib/pion/http_request.hpp"
+#include "staticlib/pion/http_response.hpp"
+
+bool contains(const std::string& str, const std::string& part) {
+    return std::string::npos != str.find(part);
+}
+
+void test_head() {
+    sl::pion::http_request req;
+    sl::pion::http_response resp(req);
+    resp.set_content_length(42);
+    resp.add_header("X-Custom", "foo");
+    resp.add_header("Connection", "Upgrade");
+    std::string head;
+    resp.serialize_head(head, true, false);
+    slassert(0 == head.find("HTTP/1.1 200 OK\r\n"));
+    slassert(contains(head, "\r\nX-Custom: foo\r\n"));
+    slassert(contains(head, "\r\nConnection: Keep-Alive\r\n"));
+    slassert(!contains(head, "Upgrade"));
+    slassert(contains(head, "\r\nContent-Length: 42\r\n"));
+    auto date = head.find("\r\nDate: ");
+    slassert(std::string::npos != date);
+    slassert(contains(head.substr(date), " GMT\r\n"));
+    slassert(head.length() - 4 == head.find("\r\n\r\n"));
+
+    // head buffer is reused
+    head.clear();
+    resp.set_status_code(404);
+    resp.set_status_message("Not Found");
+    resp.serialize_head(head, false, true);
+    slassert(0 == head.find("HTTP/1.1 404 Not Found\r\n"));
+    slassert(contains(head, "\r\nConnection: close\r\n"));
+    slassert(!contains(head, "Content-Length"));
+}
+
+void test_custom() {
+    sl::pion::http_request req;
+    sl::pion::http_response resp(req);
+    resp.set_status_code(200);
+    resp.set_status_message("Fine");
+    resp.add_header("Date", "Thu, 01 Jan 1970 00:00:00 GMT");
+    std::string head;
+    resp.serialize_head(head, true, false);
+    slassert(0 == head.find("HTTP/1.1 200 Fine\r\n"));
+    slassert(contains(head, "\r\nDate: Thu, 01 Jan 1970 00:00:00 GMT\r\n"));
+    slassert(head.find("Date:") == head.rfind("Date:"));
+    slassert(contains(head, "\r\nContent-Length: 0\r\n"));
+
+    head.clear();
+    resp.set_status_code(299);
+    resp.set_status_message("Unusual");
+    resp.serialize_head(head, true, false);
+    slassert(0 == head.find("HTTP/1.1 299 Unusual\r\n"));
+}
+
+void test_last_modified() {
+    slassert("Sun, 06 Nov 1994 08:49:37 GMT" == sl::pion::http_response::make_http_date(784111777));
+    sl::pion::http_request req;
+    sl::pion::http_response resp(req);
+    resp.set_last_modified(784111777);
+    resp.set_raw_headers(sl::pion::shared_buffer::copy_of({"ETag: \"1\"\r\n", 11}));
+    std::string head;
+    resp.serialize_head(head, true, false);
+    slassert(contains(head, "\r\nLast-Modified: Sun, 06 Nov 1994 08:49:37 GMT\r\n"));
+    slassert(contains(head, "\r\nETag: \"1\"\r\n"));
+    slassert(head.length() - 4 == head.find("\r\n\r\n"));
+
+    // raw headers are not kept for the next response
+    resp.clear();
+    head.clear();
+    resp.serialize_head(head, true, false);
+    slassert(!contains(head, "ETag"));
+}
+
+void test_concurrent_date() {
+    // checked in the threads, "slassert" throws
+    std::atomic<bool> valid{true};
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < 4; i++) {
+        threads.emplace_back([&valid] {
+            sl::pion::http_request req;
+            sl::pion::http_response resp(req);
+            std::string head;
+            for (size_t j = 0; j < 20000; j++) {
+                head.clear();
+                resp.serialize_head(head, true, false);
+                auto date = head.find("\r\nDate: ");
+                if (std::string::npos == date || 0 != head.compare(date + 33, 6, " GMT\r\n")) {
+                    valid.store(false);
+                }
+            }
+        });
+    }
+    for (auto& th : threads) {
+        th.join();
+    }
+    slassert(valid.load());
+}
+
+int main() {
+    try {
+        test_head();
+        test_custom();
+        test_last_modified();
+        test_concurrent_date();
+    } catch (const std::exception& e) {
+        std::cout << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
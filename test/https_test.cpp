@@ -25,9 +25,16 @@
 
 #include <chrono>
 #include <memory>
+#include <string>
 #include <thread>
 
 #include "asio.hpp"
+#ifndef STATICLIB_PION_DISABLE_SSL
+#include "asio/ssl.hpp"
+#endif // STATICLIB_PION_DISABLE_SSL
+
+#include "staticlib/config/assert.hpp"
+#include "staticlib/support.hpp"
 
 #include "staticlib/pion/tcp_connection.hpp"
 #include "staticlib/pion/http_request.hpp"
@@ -38,6 +45,7 @@ const uint16_t SECONDS_TO_RUN = 1;
 const uint16_t TCP_PORT = 8443;
 
 void test_https() {
+#ifndef STATICLIB_PION_DISABLE_SSL
     auto certpath = "../test/certificates/server/localhost.pem";
     auto pwdcb = [](std::size_t, asio::ssl::context::password_purpose) {
         return "test";
@@ -55,10 +63,83 @@ void test_https() {
     server.start();
     std::this_thread::sleep_for(std::chrono::seconds{SECONDS_TO_RUN});
     server.stop(true);
+#endif // STATICLIB_PION_DISABLE_SSL
+}
+
+#ifndef STATICLIB_PION_DISABLE_SSL
+// writes the data in one write and reads the response until the connection is closed
+std::string request_tls(const std::string& req) {
+    asio::io_service io_service;
+    asio::ssl::context ctx{asio::ssl::context::sslv23};
+    ctx.set_verify_mode(asio::ssl::verify_none);
+    asio::ssl::stream<asio::ip::tcp::socket> stream{io_service, ctx};
+    asio::ip::tcp::endpoint endpoint{asio::ip::address_v4::from_string("127.0.0.1"), TCP_PORT};
+    stream.lowest_layer().connect(endpoint);
+    stream.handshake(asio::ssl::stream_base::client);
+    asio::write(stream, asio::buffer(req));
+    std::string resp;
+    char buf[4096];
+    for (;;) {
+        try {
+            size_t read = stream.read_some(asio::buffer(buf));
+            resp.append(buf, read);
+        } catch (const std::exception&) {
+            // connection is closed by server
+            break;
+        }
+    }
+    return resp;
+}
+#endif // STATICLIB_PION_DISABLE_SSL
+
+void test_pipelined() {
+#ifndef STATICLIB_PION_DISABLE_SSL
+    sl::pion::http_server server(2, TCP_PORT, asio::ip::address_v4::any(), 3000,
+            "../test/certificates/server/localhost_sha256_nopwd.pem");
+    server.add_handler("POST", "/echo",
+            [] (sl::pion::http_request_ptr req, sl::pion::response_writer_ptr resp) {
+                resp->write("echo:" + sl::support::to_string(req->get_content_length()));
+                resp->send(std::move(resp));
+            });
+    server.add_handler("GET", "/hello",
+            [] (sl::pion::http_request_ptr, sl::pion::response_writer_ptr resp) {
+                resp->write("hello");
+                resp->send(std::move(resp));
+            });
+    server.start();
+
+    // body spans multiple TLS records, all of them and the
+    // next request are received before the body is read
+    auto start = std::chrono::steady_clock::now();
+    auto resp = request_tls("POST /echo HTTP/1.1\r\n"
+            "Host: 127.0.0.1\r\n"
+            "Content-Length: 100000\r\n"
+            "\r\n" +
+            std::string(100000, 'x') +
+            "GET /hello HTTP/1.1\r\n"
+            "Host: 127.0.0.1\r\n"
+            "\r\n"
+            "GET /hello HTTP/1.1\r\n"
+            "Host: 127.0.0.1\r\n"
+            "Connection: close\r\n"
+            "\r\n");
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start);
+    auto echo = resp.find("echo:100000");
+    slassert(std::string::npos != echo);
+    auto hello = resp.find("hello", echo);
+    slassert(std::string::npos != hello);
+    slassert(std::string::npos != resp.find("hello", hello + 5));
+    // not stalled until the read timeout
+    slassert(elapsed.count() < 3000);
+
+    server.stop(true);
+#endif // STATICLIB_PION_DISABLE_SSL
 }
 
 int main() {
     try {
+        test_pipelined();
         test_https();
     } catch (const std::exception& e) {
         std::cout << e.what() << std::endl;
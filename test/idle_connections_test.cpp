@@ -0,0 +1,118 @@
+/*
+ * Copyright 2026, alex at staticlibs.net
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   idle_connections_test.cpp
+ * Author: alex
+ *
+ * Created on October 17, 2026, 11:30 AM
+ */
+
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <unistd.h>
+#endif // __linux__
+
+#include "asio.hpp"
+
+#include "staticlib/config/assert.hpp"
+
+#include "staticlib/pion/http_server.hpp"
+
+const uint16_t TCP_PORT = 8082;
+const size_t IDLE_CONNECTIONS = 500;
+
+void hello(sl::pion::http_request_ptr, sl::pion::response_writer_ptr resp) {
+    resp->write("hello");
+    resp->send(std::move(resp));
+}
+
+size_t resident_memory() {
+#ifdef __linux__
+    std::ifstream statm{"/proc/self/statm"};
+    size_t size = 0;
+    size_t resident = 0;
+    statm >> size >> resident;
+    return resident * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#else // !__linux__
+    return 0;
+#endif // __linux__
+}
+
+// sends keep-alive request and reads the response, connection is left open
+void request_keep_alive(asio::ip::tcp::socket& socket) {
+    static const std::string request = "GET /hello HTTP/1.1\r\nHost: 127.0.0.1\r\n\r\n";
+    asio::write(socket, asio::buffer(request));
+    std::string resp;
+    char buf[1024];
+    while (std::string::npos == resp.find("hello")) {
+        size_t read = socket.read_some(asio::buffer(buf));
+        resp.append(buf, read);
+    }
+}
+
+size_t idle_memory(uint32_t read_buffer_pool_size) {
+    sl::pion::http_server server(2, TCP_PORT);
+    auto opts = sl::pion::tcp_server_options();
+    opts.read_buffer_pool_size = read_buffer_pool_size;
+    server.set_options(opts);
+    server.add_handler("GET", "/hello", hello);
+    server.start();
+
+    asio::io_service io_service;
+    asio::ip::tcp::endpoint endpoint{asio::ip::address_v4::from_string("127.0.0.1"), TCP_PORT};
+    std::vector<std::unique_ptr<asio::ip::tcp::socket>> sockets;
+    sockets.reserve(IDLE_CONNECTIONS);
+    size_t rss_before = resident_memory();
+    for (size_t i = 0; i < IDLE_CONNECTIONS; i++) {
+        sockets.emplace_back(new asio::ip::tcp::socket(io_service));
+        sockets.back()->connect(endpoint);
+        request_keep_alive(*sockets.back());
+    }
+    size_t rss_after = resident_memory();
+    for (auto& so : sockets) {
+        so->close();
+    }
+    server.stop(true);
+    return rss_after > rss_before ? (rss_after - rss_before) / IDLE_CONNECTIONS : 0;
+}
+
+void test_idle() {
+#ifdef __linux__
+    // pooled run goes first, memory it frees can only be reused by the second run
+    auto pooled = idle_memory(64);
+    auto owned = idle_memory(0);
+    std::cout << "idle connections, resident bytes per connection: owned buffers: [" <<
+            owned << "], pooled buffers: [" << pooled << "]" << std::endl;
+    slassert(pooled < owned);
+#endif // __linux__
+}
+
+int main() {
+    try {
+        test_idle();
+    } catch (const std::exception& e) {
+        std::cout << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,154 @@
+/*
+ * Copyright 2026, alex at staticlibs.net
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   keep_alive_test.cpp
+ * Author: alex
+ *
+ * Created on October 17, 2026, 2:40 PM
+ */
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+
+#include "asio.hpp"
+
+#include "staticlib/config/assert.hpp"
+
+#include "staticlib/pion/http_server.hpp"
+#include "staticlib/pion/shared_buffer.hpp"
+
+const uint16_t TCP_PORT = 8083;
+const size_t WARMUP_REQUESTS = 100;
+const size_t REQUESTS = 10000;
+
+std::atomic<size_t> allocations_count{0};
+
+void* operator new(std::size_t size) {
+    allocations_count.fetch_add(1, std::memory_order_relaxed);
+    void* ptr = std::malloc(size > 0 ? size : 1);
+    if (nullptr == ptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void operator delete(void* ptr) STATICLIB_NOEXCEPT {
+    std::free(ptr);
+}
+
+void hello(sl::pion::http_request_ptr, sl::pion::response_writer_ptr resp) {
+    resp->write("hello");
+    resp->send(std::move(resp));
+}
+
+// sends keep-alive request and reads the response, buffers are preallocated
+void request_keep_alive(asio::ip::tcp::socket& socket, std::string& resp) {
+    static const std::string request = "GET /hello?foo=bar HTTP/1.1\r\n"
+            "Host: 127.0.0.1\r\n"
+            "User-Agent: keep_alive_test\r\n"
+            "Accept: */*\r\n"
+            "\r\n";
+    asio::write(socket, asio::buffer(request));
+    resp.clear();
+    char buf[1024];
+    while (resp.length() < 5 || 0 != resp.compare(resp.length() - 5, 5, "hello")) {
+        size_t read = socket.read_some(asio::buffer(buf));
+        resp.append(buf, read);
+    }
+}
+
+void test_keep_alive() {
+    sl::pion::http_server server(2, TCP_PORT);
+    server.add_handler("GET", "/hello", hello);
+    server.start();
+
+    asio::io_service io_service;
+    asio::ip::tcp::endpoint endpoint{asio::ip::address_v4::from_string("127.0.0.1"), TCP_PORT};
+    asio::ip::tcp::socket socket{io_service};
+    socket.connect(endpoint);
+    std::string resp;
+    resp.reserve(1024);
+    for (size_t i = 0; i < WARMUP_REQUESTS; i++) {
+        request_keep_alive(socket, resp);
+    }
+    size_t allocs_before = allocations_count.load();
+    for (size_t i = 0; i < REQUESTS; i++) {
+        request_keep_alive(socket, resp);
+    }
+    size_t allocs = allocations_count.load() - allocs_before;
+    socket.close();
+    server.stop(true);
+
+    std::cout << "keep-alive, allocations per request: [" << (allocs / REQUESTS) << "]" << std::endl;
+    // reader, request and writer are reused, only headers and write buffers are allocated,
+    // bound is kept just above the measured figure (8) to catch regressions
+    slassert(allocs / REQUESTS < 10);
+}
+
+// handler writes many separate buffers, the ones over the limit are copied
+void buffers(sl::pion::http_request_ptr, sl::pion::response_writer_ptr resp) {
+    static const std::string part(300, 'x');
+    for (size_t i = 0; i < 200; i++) {
+        resp->write_nocopy(part);
+        resp->write_shared(sl::pion::shared_buffer::copy_of(part));
+    }
+    resp->send(std::move(resp));
+}
+
+void test_many_buffers() {
+    sl::pion::http_server server(2, TCP_PORT);
+    server.add_handler("GET", "/buffers", buffers);
+    server.start();
+
+    asio::io_service io_service;
+    asio::ip::tcp::endpoint endpoint{asio::ip::address_v4::from_string("127.0.0.1"), TCP_PORT};
+    asio::ip::tcp::socket socket{io_service};
+    socket.connect(endpoint);
+    const std::string body(300 * 400, 'x');
+    // writer is reused for the second request
+    for (size_t i = 0; i < 2; i++) {
+        asio::write(socket, asio::buffer(std::string("GET /buffers HTTP/1.1\r\n"
+                "Host: 127.0.0.1\r\n"
+                "\r\n")));
+        std::string resp;
+        char buf[4096];
+        while (resp.length() < body.length() || 0 != resp.compare(resp.length() - body.length(),
+                body.length(), body)) {
+            size_t read = socket.read_some(asio::buffer(buf));
+            resp.append(buf, read);
+        }
+        slassert(std::string::npos != resp.find("\r\nContent-Length: 120000\r\n"));
+        slassert(resp.find("\r\n\r\n") + 4 + body.length() == resp.length());
+    }
+    socket.close();
+    server.stop(true);
+}
+
+int main() {
+    try {
+        test_keep_alive();
+        test_many_buffers();
+    } catch (const std::exception& e) {
+        std::cout << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,214 @@
+/*
+ * Copyright 2026, alex at staticlibs.net
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   multipart_parser_test.cpp
+ * Author: alex
+ *
+ * Created on October 17, 2026, 8:45 PM
+ */
+
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "staticlib/config/assert.hpp"
+
+#include "staticlib/pion/http_parser.hpp"
+#include "staticlib/pion/multipart_parser.hpp"
+#include "staticlib/pion/pion_exception.hpp"
+
+const std::string CONTENT_TYPE = "multipart/form-data; boundary=\"----b0undary\"";
+
+// binary data that contains delimiter prefixes
+std::string binary_data() {
+    std::string res;
+    for (size_t i = 0; i < 4096; i++) {
+        res.push_back(static_cast<char>(i % 251));
+        if (0 == i % 509) {
+            res.append("\r\n------b0undar");
+        }
+        if (0 == i % 1021) {
+            res.append("\r\n--");
+        }
+    }
+    res.append("\r\n------b0undar");
+    return res;
+}
+
+std::string make_body(const std::string& data) {
+    return std::string("--") + "----b0undary\r\n"
+            "Content-Disposition: form-data; name=\"title\"\r\n"
+            "\r\n"
+            "hello\r\n"
+            "------b0undary  \r\n"
+            "Content-Disposition: form-data; filename=\"data.bin\"; name=\"file\"\r\n"
+            "Content-Type: application/octet-stream\r\n"
+            "\r\n" +
+            data +
+            "\r\n------b0undary\r\n"
+            "Content-Disposition: form-data; name=\"empty\"\r\n"
+            "\r\n"
+            "\r\n"
+            "------b0undary--\r\n"
+            "epilogue";
+}
+
+struct part {
+    std::string name;
+    std::string filename;
+    std::string content_type;
+    std::string data;
+};
+
+void test_pieces() {
+    auto data = binary_data();
+    auto body = make_body(data);
+    for (size_t piece_len = 1; piece_len <= 64; piece_len++) {
+        std::vector<part> parts;
+        sl::pion::multipart_parser parser(CONTENT_TYPE, [&parts](
+                const sl::pion::multipart_parser::headers_type& headers) {
+            part pa;
+            pa.name = sl::pion::multipart_parser::get_disposition_param(headers, "name");
+            pa.filename = sl::pion::multipart_parser::get_disposition_param(headers, "filename");
+            auto ct = headers.find("content-type");
+            pa.content_type = headers.end() != ct ? ct->second : "";
+            parts.emplace_back(std::move(pa));
+            auto idx = parts.size() - 1;
+            return [&parts, idx](const char* buf, size_t len) {
+                parts[idx].data.append(buf, len);
+            };
+        });
+        for (size_t i = 0; i < body.length(); i += piece_len) {
+            parser(body.data() + i, (std::min)(piece_len, body.length() - i));
+        }
+        slassert(parser.is_finished());
+        slassert(3 == parts.size());
+        slassert("title" == parts[0].name);
+        slassert(parts[0].filename.empty());
+        slassert("hello" == parts[0].data);
+        slassert("file" == parts[1].name);
+        slassert("data.bin" == parts[1].filename);
+        slassert("application/octet-stream" == parts[1].content_type);
+        slassert(data == parts[1].data);
+        slassert("empty" == parts[2].name);
+        slassert(parts[2].data.empty());
+    }
+}
+
+void test_sink() {
+    auto body = make_body("foo");
+    std::vector<std::string> results;
+    {
+        sl::pion::multipart_parser parser(CONTENT_TYPE, [&results](
+                const sl::pion::multipart_parser::headers_type&) {
+            // sink is destroyed at the end of each part
+            struct recording_sink {
+                std::vector<std::string>& results;
+                std::shared_ptr<sl::io::string_sink> sink;
+                recording_sink(std::vector<std::string>& results) :
+                results(results),
+                sink(std::make_shared<sl::io::string_sink>()) { }
+                recording_sink(const recording_sink&) = default;
+                ~recording_sink() {
+                    if (1 == sink.use_count()) {
+                        results.emplace_back(sink->get_string());
+                    }
+                }
+                std::streamsize write(sl::io::span<const char> span) {
+                    return sink->write(span);
+                }
+            };
+            return sl::pion::make_part_sink(recording_sink(results));
+        });
+        parser(body.data(), body.length());
+        slassert(parser.is_finished());
+    }
+    slassert(3 == results.size());
+    slassert("hello" == results[0]);
+    slassert("foo" == results[1]);
+    slassert(results[2].empty());
+}
+
+void test_invalid() {
+    bool thrown = false;
+    try {
+        sl::pion::multipart_parser parser("multipart/form-data", nullptr);
+    } catch (const sl::pion::pion_exception&) {
+        thrown = true;
+    }
+    slassert(thrown);
+
+    thrown = false;
+    try {
+        sl::pion::multipart_parser parser(CONTENT_TYPE, nullptr);
+        std::string body = "------b0undary\r\nno colon here\r\n\r\n";
+        parser(body.data(), body.length());
+    } catch (const sl::pion::pion_exception&) {
+        thrown = true;
+    }
+    slassert(thrown);
+
+    thrown = false;
+    try {
+        sl::pion::multipart_parser parser(CONTENT_TYPE, nullptr);
+        std::string body = "------b0undaryX\r\n";
+        parser(body.data(), body.length());
+    } catch (const sl::pion::pion_exception&) {
+        thrown = true;
+    }
+    slassert(thrown);
+
+    thrown = false;
+    try {
+        sl::pion::multipart_parser parser(CONTENT_TYPE, nullptr);
+        std::string body = "------b0undary\r\n" + std::string(sl::pion::multipart_parser::HEADERS_MAX, 'x');
+        parser(body.data(), body.length());
+    } catch (const sl::pion::pion_exception&) {
+        thrown = true;
+    }
+    slassert(thrown);
+}
+
+void test_form_data() {
+    auto body = make_body("binary");
+    std::unordered_multimap<std::string, std::string, sl::pion::algorithm::ihash, sl::pion::algorithm::iequal_to> dict;
+    slassert(sl::pion::http_parser::parse_multipart_form_data(dict, CONTENT_TYPE, body));
+    // binary part is skipped
+    slassert(2 == dict.size());
+    slassert("hello" == dict.find("title")->second);
+    slassert(dict.find("empty")->second.empty());
+    slassert(dict.end() == dict.find("file"));
+
+    dict.clear();
+    slassert(!sl::pion::http_parser::parse_multipart_form_data(dict, "multipart/form-data", body));
+    slassert(dict.empty());
+}
+
+int main() {
+    try {
+        test_pieces();
+        test_sink();
+        test_invalid();
+        test_form_data();
+    } catch (const std::exception& e) {
+        std::cout << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
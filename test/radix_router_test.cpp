@@ -0,0 +1,183 @@
+/*
+ * Copyright 2026, alex at staticlibs.net
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   radix_router_test.cpp
+ * Author: alex
+ *
+ * Created on October 17, 2026, 11:10 PM
+ */
+
+#include <iostream>
+#include <string>
+
+#include "staticlib/config/assert.hpp"
+
+#include "staticlib/pion/pion_exception.hpp"
+#include "staticlib/pion/radix_router.hpp"
+
+int find(const sl::pion::radix_router<int>& router, const std::string& path,
+        sl::pion::path_params_type& params) {
+    auto res = router.find(path.data(), path.length(), params);
+    return nullptr != res ? *res : -1;
+}
+
+int find(const sl::pion::radix_router<int>& router, const std::string& path) {
+    sl::pion::path_params_type params;
+    return find(router, path, params);
+}
+
+void test_static() {
+    sl::pion::radix_router<int> router;
+    slassert(-1 == find(router, "/foo"));
+    router.add("/foo", 1);
+    router.add("/foobar", 2);
+    router.add("/fo", 3);
+    router.add("/foo/bar", 4);
+    router.add("/baz", 5);
+    slassert(5 == router.size());
+    slassert(1 == find(router, "/foo"));
+    slassert(2 == find(router, "/foobar"));
+    slassert(3 == find(router, "/fo"));
+    slassert(4 == find(router, "/foo/bar"));
+    slassert(5 == find(router, "/baz"));
+    slassert(-1 == find(router, "/f"));
+    slassert(-1 == find(router, "/fooba"));
+    slassert(-1 == find(router, ""));
+}
+
+void test_prefix() {
+    sl::pion::radix_router<int> router;
+    router.add("/foo", 1);
+    router.add("/foo/bar", 2);
+    slassert(1 == find(router, "/foo/baz"));
+    slassert(2 == find(router, "/foo/bar/baz/42"));
+    // prefix must end at a slash
+    slassert(-1 == find(router, "/foobar"));
+    slassert(-1 == find(router, "/bar"));
+    router.add("", 3);
+    slassert(3 == find(router, "/bar"));
+    slassert(3 == find(router, ""));
+    slassert(3 == find(router, "/foobar"));
+}
+
+void test_params() {
+    sl::pion::radix_router<int> router;
+    router.add("/users/{id}", 1);
+    router.add("/users/{id}/posts/{post}", 2);
+    router.add("/users/admin", 3);
+    router.add("/users/{id}/friends", 4);
+    sl::pion::path_params_type params;
+
+    slassert(1 == find(router, "/users/42", params));
+    slassert(1 == params.size());
+    slassert("id" == params[0].first);
+    slassert("42" == params[0].second);
+
+    slassert(2 == find(router, "/users/42/posts/abc", params));
+    slassert(2 == params.size());
+    slassert("42" == params[0].second);
+    slassert("post" == params[1].first);
+    slassert("abc" == params[1].second);
+
+    slassert(3 == find(router, "/users/admin", params));
+    slassert(params.empty());
+
+    // static branch fails deeper, parameter is used
+    slassert(4 == find(router, "/users/admin/friends", params));
+    slassert(1 == params.size());
+    slassert("admin" == params[0].second);
+
+    // empty segment does not match parameter
+    slassert(-1 == find(router, "/users/", params));
+    slassert(params.empty());
+
+    // prefix match keeps captured parameters
+    slassert(1 == find(router, "/users/42/unknown", params));
+    slassert(1 == params.size());
+    slassert("42" == params[0].second);
+}
+
+void test_wildcard() {
+    sl::pion::radix_router<int> router;
+    router.add("/static/*path", 1);
+    router.add("/static/index", 2);
+    router.add("/files/{dir}/*", 3);
+    sl::pion::path_params_type params;
+
+    slassert(1 == find(router, "/static/css/main.css", params));
+    slassert(1 == params.size());
+    slassert("path" == params[0].first);
+    slassert("css/main.css" == params[0].second);
+
+    slassert(2 == find(router, "/static/index", params));
+    slassert(params.empty());
+
+    slassert(1 == find(router, "/static/", params));
+    slassert(params[0].second.empty());
+
+    slassert(3 == find(router, "/files/tmp/a/b", params));
+    slassert(2 == params.size());
+    slassert("tmp" == params[0].second);
+    slassert(params[1].first.empty());
+    slassert("a/b" == params[1].second);
+}
+
+void test_invalid() {
+    sl::pion::radix_router<int> router;
+    router.add("/users/{id}", 1);
+    bool thrown = false;
+    try {
+        router.add("/users/{id}", 2);
+    } catch (const sl::pion::pion_exception&) {
+        thrown = true;
+    }
+    slassert(thrown);
+
+    thrown = false;
+    try {
+        router.add("/users/{name}/posts", 2);
+    } catch (const sl::pion::pion_exception&) {
+        thrown = true;
+    }
+    slassert(thrown);
+
+    const char* invalid[] = {"/a{id}", "/{id", "/{}", "/*/foo", "/a*"};
+    for (auto route : invalid) {
+        thrown = false;
+        try {
+            router.add(route, 3);
+        } catch (const sl::pion::pion_exception&) {
+            thrown = true;
+        }
+        slassert(thrown);
+    }
+    slassert(1 == router.size());
+}
+
+int main() {
+    try {
+        test_static();
+        test_prefix();
+        test_params();
+        test_wildcard();
+        test_invalid();
+    } catch (const std::exception& e) {
+        std::cout << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
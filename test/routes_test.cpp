@@ -0,0 +1,272 @@
+/*
+ * Copyright 2026, alex at staticlibs.net
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   routes_test.cpp
+ * Author: alex
+ *
+ * Created on October 17, 2026, 11:40 PM
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include "asio.hpp"
+
+#include "staticlib/config/assert.hpp"
+#include "staticlib/support.hpp"
+
+#include "staticlib/pion/http_server.hpp"
+#include "staticlib/pion/pion_exception.hpp"
+
+const uint16_t TCP_PORT = 8084;
+
+void user(sl::pion::http_request_ptr req, sl::pion::response_writer_ptr resp) {
+    resp->write("user:" + req->get_path_param("id"));
+    resp->send(std::move(resp));
+}
+
+void plugin(sl::pion::http_request_ptr, sl::pion::response_writer_ptr resp) {
+    resp->write("plugin");
+    resp->send(std::move(resp));
+}
+
+// sends raw request and reads the response until the connection is closed
+std::string request_raw(const std::string& req) {
+    asio::io_service io_service;
+    asio::ip::tcp::endpoint endpoint{asio::ip::address_v4::from_string("127.0.0.1"), TCP_PORT};
+    asio::ip::tcp::socket socket{io_service};
+    socket.connect(endpoint);
+    asio::write(socket, asio::buffer(req));
+    std::string resp;
+    char buf[1024];
+    std::error_code ec;
+    for (;;) {
+        size_t read = socket.read_some(asio::buffer(buf), ec);
+        if (ec) {
+            break;
+        }
+        resp.append(buf, read);
+    }
+    return resp;
+}
+
+std::string request(const std::string& path) {
+    return request_raw("GET " + path + " HTTP/1.1\r\n"
+            "Host: 127.0.0.1\r\n"
+            "Connection: close\r\n"
+            "\r\n");
+}
+
+bool ends_with(const std::string& str, const std::string& suffix) {
+    return str.length() >= suffix.length() &&
+            0 == str.compare(str.length() - suffix.length(), suffix.length(), suffix);
+}
+
+void test_routes() {
+    sl::pion::http_server server(2, TCP_PORT);
+    server.add_handler("GET", "/users/{id}", user);
+    server.start();
+
+    slassert(ends_with(request("/users/42"), "user:42"));
+    slassert(ends_with(request("/users/42/"), "user:42"));
+    slassert(std::string::npos != request("/plugin").find("404 Not Found"));
+
+    // routes are changed while the server is running
+    server.add_handler("GET", "/plugin", plugin);
+    slassert(ends_with(request("/plugin/foo"), "plugin"));
+    slassert(ends_with(request("/users/43"), "user:43"));
+
+    bool thrown = false;
+    try {
+        server.add_handler("GET", "/plugin/", plugin);
+    } catch (const sl::pion::pion_exception&) {
+        thrown = true;
+    }
+    slassert(thrown);
+
+    // conflicting parameter name, definition is not kept
+    thrown = false;
+    try {
+        server.add_handler("GET", "/users/{name}/posts", plugin);
+    } catch (const sl::pion::pion_exception&) {
+        thrown = true;
+    }
+    slassert(thrown);
+    slassert(!server.remove_handler("GET", "/users/{name}/posts"));
+
+    slassert(server.remove_handler("GET", "/plugin"));
+    slassert(!server.remove_handler("GET", "/plugin"));
+    slassert(std::string::npos != request("/plugin").find("404 Not Found"));
+    slassert(ends_with(request("/users/44"), "user:44"));
+
+    server.stop(true);
+}
+
+void test_policies() {
+    sl::pion::http_server server(2, TCP_PORT);
+
+    sl::pion::route_policy limited;
+    limited.max_content_length = 16;
+    server.add_handler("POST", "/limited", plugin, limited);
+    server.add_handler("POST", "/limited_payload", plugin, limited);
+    std::atomic<std::size_t> payload_received{0};
+    server.add_payload_handler("POST", "/limited_payload", [&payload_received](sl::pion::http_request_ptr&) {
+        return [&payload_received](const char*, std::size_t len) {
+            payload_received.fetch_add(len);
+        };
+    });
+
+    sl::pion::route_policy slow;
+    slow.request_deadline_millis = 300;
+    server.add_handler("POST", "/slow", plugin, slow);
+    server.add_payload_handler("POST", "/slow", [](sl::pion::http_request_ptr&) {
+        return [](const char*, std::size_t) { };
+    });
+
+    std::thread::id executor_thread;
+    std::atomic<bool> executed{false};
+    sl::pion::route_policy offloaded;
+    offloaded.executor = [&executor_thread, &executed](std::function<void()> task) {
+        std::thread th{std::move(task)};
+        executor_thread = th.get_id();
+        th.join();
+        executed.store(true);
+    };
+    std::thread::id handler_thread;
+    server.add_handler("GET", "/offloaded", [&handler_thread](sl::pion::http_request_ptr,
+            sl::pion::response_writer_ptr resp) {
+        handler_thread = std::this_thread::get_id();
+        resp->write("offloaded");
+        resp->send(std::move(resp));
+    }, offloaded);
+    server.start();
+
+    // body over the limit is rejected without "100 Continue"
+    auto resp = request_raw("POST /limited HTTP/1.1\r\n"
+            "Host: 127.0.0.1\r\n"
+            "Content-Length: 17\r\n"
+            "Expect: 100-continue\r\n"
+            "\r\n");
+    slassert(0 == resp.find("HTTP/1.1 413 Payload Too Large"));
+    slassert(std::string::npos == resp.find("100 Continue"));
+
+    resp = request_raw("POST /limited HTTP/1.1\r\n"
+            "Host: 127.0.0.1\r\n"
+            "Content-Length: 16\r\n"
+            "Connection: close\r\n"
+            "\r\n"
+            "0123456789abcdef");
+    slassert(ends_with(resp, "plugin"));
+
+    // chunked body is counted against the limit
+    resp = request_raw("POST /limited HTTP/1.1\r\n"
+            "Host: 127.0.0.1\r\n"
+            "Transfer-Encoding: chunked\r\n"
+            "\r\n"
+            "10\r\n"
+            "0123456789abcdef\r\n"
+            "1\r\n"
+            "x\r\n"
+            "0\r\n"
+            "\r\n");
+    slassert(0 == resp.find("HTTP/1.1 413 Payload Too Large"));
+
+    // as well as the body passed to payload handler
+    resp = request_raw("POST /limited_payload HTTP/1.1\r\n"
+            "Host: 127.0.0.1\r\n"
+            "Transfer-Encoding: chunked\r\n"
+            "\r\n"
+            "11\r\n"
+            "0123456789abcdefx\r\n"
+            "0\r\n"
+            "\r\n");
+    slassert(0 == resp.find("HTTP/1.1 413 Payload Too Large"));
+    slassert(0 == payload_received.load());
+
+    // incomplete body is dropped at the deadline, well before the server read timeout
+    auto start = std::chrono::steady_clock::now();
+    resp = request_raw("POST /slow HTTP/1.1\r\n"
+            "Host: 127.0.0.1\r\n"
+            "Content-Length: 100\r\n"
+            "\r\n"
+            "0123456789");
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start);
+    slassert(resp.empty());
+    slassert(elapsed.count() < 3000);
+
+    // handler is run by the executor
+    slassert(ends_with(request("/offloaded"), "offloaded"));
+    while (!executed.load()) {
+        std::this_thread::yield();
+    }
+    slassert(executor_thread == handler_thread);
+
+    server.stop(true);
+}
+
+void test_stored_body() {
+    sl::pion::http_server server(2, TCP_PORT);
+    auto opts = sl::pion::tcp_server_options();
+    opts.content_spill_threshold = 4096;
+    server.set_options(opts);
+    std::string data;
+    for (size_t i = 0; i < 100000; i++) {
+        data.push_back(static_cast<char>('a' + (i % 26)));
+    }
+    // route without payload handler gets the body stored by the server
+    server.add_handler("POST", "/stored", [&data](sl::pion::http_request_ptr req,
+            sl::pion::response_writer_ptr resp) {
+        std::string content{req->get_content(), req->get_content_length()};
+        resp->write(req->is_content_spilled() ? "file:" : "memory:");
+        resp->write(0 == data.compare(0, content.length(), content) ? sl::support::to_string(content.length()) : "invalid");
+        resp->send(std::move(resp));
+    });
+    server.start();
+
+    auto resp = request_raw("POST /stored HTTP/1.1\r\n"
+            "Host: 127.0.0.1\r\n"
+            "Content-Length: 100000\r\n"
+            "Connection: close\r\n"
+            "\r\n" + data);
+    slassert(ends_with(resp, "file:100000"));
+
+    resp = request_raw("POST /stored HTTP/1.1\r\n"
+            "Host: 127.0.0.1\r\n"
+            "Content-Length: 100\r\n"
+            "Connection: close\r\n"
+            "\r\n" + data.substr(0, 100));
+    slassert(ends_with(resp, "memory:100"));
+
+    server.stop(true);
+}
+
+int main() {
+    try {
+        test_routes();
+        test_policies();
+        test_stored_body();
+    } catch (const std::exception& e) {
+        std::cout << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,211 @@
+/*
+ * Copyright 2026, alex at staticlibs.net
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   send_file_test.cpp
+ * Author: alex
+ *
+ * Created on October 18, 2026, 3:50 AM
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include <fcntl.h>
+#ifdef _WIN32
+#include <io.h>
+#endif // _WIN32
+
+#include "asio.hpp"
+#ifndef STATICLIB_PION_DISABLE_SSL
+#include "asio/ssl.hpp"
+#endif // STATICLIB_PION_DISABLE_SSL
+
+#include "staticlib/config/assert.hpp"
+
+#include "staticlib/pion/http_server.hpp"
+
+const uint16_t TCP_PORT = 8085;
+const uint16_t TLS_PORT = 8087;
+const std::string FILE_PATH = "send_file_test.dat";
+const std::string CERT_PATH = "../test/certificates/server/localhost_sha256_nopwd.pem";
+
+int open_file() {
+#ifdef _WIN32
+    return _open(FILE_PATH.c_str(), _O_RDONLY | _O_BINARY);
+#else // !_WIN32
+    return open(FILE_PATH.c_str(), O_RDONLY);
+#endif // _WIN32
+}
+
+// file content spans multiple 64 KB read buffers, block size
+// is not a multiple of the pattern length, so misordered blocks are detected
+std::string file_data() {
+    std::string res;
+    for (size_t i = 0; i < 600000; i++) {
+        res.push_back(static_cast<char>('a' + (i % 26)));
+    }
+    return res;
+}
+
+void file(sl::pion::http_request_ptr, sl::pion::response_writer_ptr resp) {
+    resp->write_nocopy("head:");
+    sl::pion::http_response_writer::send_file(std::move(resp), open_file(), 1000, 150000);
+}
+
+void whole(sl::pion::http_request_ptr, sl::pion::response_writer_ptr resp) {
+    sl::pion::http_response_writer::send_file(std::move(resp), open_file(), 0, 600000);
+}
+
+void empty(sl::pion::http_request_ptr, sl::pion::response_writer_ptr resp) {
+    sl::pion::http_response_writer::send_file(std::move(resp), open_file(), 0, 0);
+}
+
+std::string request(const std::string& method, const std::string& path) {
+    asio::io_service io_service;
+    asio::ip::tcp::endpoint endpoint{asio::ip::address_v4::from_string("127.0.0.1"), TCP_PORT};
+    asio::ip::tcp::socket socket{io_service};
+    socket.connect(endpoint);
+    asio::write(socket, asio::buffer(method + " " + path + " HTTP/1.1\r\n"
+            "Host: 127.0.0.1\r\n"
+            "Connection: close\r\n"
+            "\r\n"));
+    std::string resp;
+    char buf[4096];
+    std::error_code ec;
+    for (;;) {
+        size_t read = socket.read_some(asio::buffer(buf), ec);
+        if (ec) {
+            break;
+        }
+        resp.append(buf, read);
+    }
+    return resp;
+}
+
+#ifndef STATICLIB_PION_DISABLE_SSL
+std::string request_tls(const std::string& path) {
+    asio::io_service io_service;
+    asio::ssl::context ctx{asio::ssl::context::sslv23};
+    ctx.set_verify_mode(asio::ssl::verify_none);
+    asio::ssl::stream<asio::ip::tcp::socket> stream{io_service, ctx};
+    asio::ip::tcp::endpoint endpoint{asio::ip::address_v4::from_string("127.0.0.1"), TLS_PORT};
+    stream.lowest_layer().connect(endpoint);
+    stream.handshake(asio::ssl::stream_base::client);
+    asio::write(stream, asio::buffer("GET " + path + " HTTP/1.1\r\n"
+            "Host: 127.0.0.1\r\n"
+            "Connection: close\r\n"
+            "\r\n"));
+    std::string resp;
+    char buf[4096];
+    for (;;) {
+        try {
+            size_t read = stream.read_some(asio::buffer(buf));
+            resp.append(buf, read);
+        } catch (const std::exception&) {
+            // connection is closed by server
+            break;
+        }
+    }
+    return resp;
+}
+#endif // STATICLIB_PION_DISABLE_SSL
+
+std::string body(const std::string& resp) {
+    auto pos = resp.find("\r\n\r\n");
+    slassert(std::string::npos != pos);
+    return resp.substr(pos + 4);
+}
+
+void test_send_file() {
+    auto data = file_data();
+    {
+        std::ofstream out{FILE_PATH, std::ios::binary};
+        out.write(data.data(), data.length());
+    }
+
+    sl::pion::http_server server(2, TCP_PORT);
+    server.add_handler("GET", "/file", file);
+    server.add_handler("GET", "/whole", whole);
+    server.add_handler("GET", "/empty", empty);
+    server.start();
+
+    auto resp = request("GET", "/file");
+    slassert(std::string::npos != resp.find("Content-Length: 150005\r\n"));
+    slassert("head:" + data.substr(1000, 150000) == body(resp));
+
+    resp = request("GET", "/whole");
+    slassert(data == body(resp));
+
+    resp = request("HEAD", "/file");
+    slassert(0 == resp.find("HTTP/1.1 200 OK"));
+    slassert(std::string::npos != resp.find("Content-Length: "));
+    slassert(body(resp).empty());
+
+    resp = request("GET", "/empty");
+    slassert(0 == resp.find("HTTP/1.1 200 OK"));
+    slassert(body(resp).empty());
+
+    server.stop(true);
+    std::remove(FILE_PATH.c_str());
+}
+
+// file is double-buffered over TLS, blocks are read
+// by the disk IO threads or on the IO thread
+void test_send_file_tls(uint32_t disk_io_threads) {
+#ifndef STATICLIB_PION_DISABLE_SSL
+    auto data = file_data();
+    {
+        std::ofstream out{FILE_PATH, std::ios::binary};
+        out.write(data.data(), data.length());
+    }
+
+    sl::pion::http_server server(2, TLS_PORT, asio::ip::address_v4::any(), 10000, CERT_PATH);
+    auto opts = server.get_options();
+    opts.disk_io_threads = disk_io_threads;
+    server.set_options(opts);
+    server.add_handler("GET", "/file", file);
+    server.add_handler("GET", "/whole", whole);
+    server.start();
+
+    auto resp = request_tls("/file");
+    slassert(std::string::npos != resp.find("Content-Length: 150005\r\n"));
+    slassert("head:" + data.substr(1000, 150000) == body(resp));
+
+    resp = request_tls("/whole");
+    slassert(data == body(resp));
+
+    server.stop(true);
+    std::remove(FILE_PATH.c_str());
+#else // STATICLIB_PION_DISABLE_SSL
+    (void) disk_io_threads;
+#endif // STATICLIB_PION_DISABLE_SSL
+}
+
+int main() {
+    try {
+        test_send_file();
+        test_send_file_tls(0);
+        test_send_file_tls(2);
+    } catch (const std::exception& e) {
+        std::cout << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,76 @@
+/*
+ * Copyright 2026, alex at staticlibs.net
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   shared_buffer_test.cpp
+ * Author: alex
+ *
+ * Created on October 18, 2026, 3:00 AM
+ */
+
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include "staticlib/config/assert.hpp"
+
+#include "staticlib/pion/pion_exception.hpp"
+#include "staticlib/pion/shared_buffer.hpp"
+
+void test_ownership() {
+    std::weak_ptr<const std::string> weak;
+    sl::pion::shared_buffer part;
+    {
+        auto str = std::make_shared<const std::string>("hello world");
+        weak = str;
+        sl::pion::shared_buffer buf(str);
+        slassert(str->data() == buf.data());
+        slassert(11 == buf.size());
+        part = buf.slice(6, 5);
+    }
+    // slice keeps the data alive
+    slassert(!weak.expired());
+    slassert("world" == std::string(part.data(), part.size()));
+    part = sl::pion::shared_buffer();
+    slassert(weak.expired());
+    slassert(0 == part.size());
+}
+
+void test_copy() {
+    std::string str = "foo";
+    auto buf = sl::pion::shared_buffer::copy_of(str);
+    str[0] = 'b';
+    slassert("foo" == std::string(buf.data(), buf.size()));
+    slassert(0 == buf.slice(3, 0).size());
+    bool thrown = false;
+    try {
+        buf.slice(2, 2);
+    } catch (const sl::pion::pion_exception&) {
+        thrown = true;
+    }
+    slassert(thrown);
+}
+
+int main() {
+    try {
+        test_ownership();
+        test_copy();
+    } catch (const std::exception& e) {
+        std::cout << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
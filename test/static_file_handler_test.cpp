@@ -0,0 +1,211 @@
+/*
+ * Copyright 2026, alex at staticlibs.net
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   static_file_handler_test.cpp
+ * Author: alex
+ *
+ * Created on October 18, 2026, 4:50 AM
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <direct.h>
+#else // !_WIN32
+#include <sys/stat.h>
+#include <unistd.h>
+#endif // _WIN32
+
+#include "asio.hpp"
+
+#include "staticlib/config/assert.hpp"
+
+#include "staticlib/pion/http_server.hpp"
+#include "staticlib/pion/static_file_handler.hpp"
+
+const uint16_t TCP_PORT = 8086;
+const std::string ROOT_DIR = "static_file_handler_test_dir";
+const std::vector<std::string> FILES = {"index.html", "a.txt", "a.txt.gz", "medium.bin", "large.bin"};
+
+std::string make_data(size_t len) {
+    std::string res;
+    for (size_t i = 0; i < len; i++) {
+        res.push_back(static_cast<char>('a' + (i % 26)));
+    }
+    return res;
+}
+
+void write_file(const std::string& name, const std::string& data) {
+    std::ofstream out{ROOT_DIR + "/" + name, std::ios::binary};
+    out.write(data.data(), data.length());
+}
+
+std::string request(const std::string& method, const std::string& path, const std::string& headers = "") {
+    asio::io_service io_service;
+    asio::ip::tcp::endpoint endpoint{asio::ip::address_v4::from_string("127.0.0.1"), TCP_PORT};
+    asio::ip::tcp::socket socket{io_service};
+    socket.connect(endpoint);
+    asio::write(socket, asio::buffer(method + " " + path + " HTTP/1.1\r\n"
+            "Host: 127.0.0.1\r\n" + headers +
+            "Connection: close\r\n"
+            "\r\n"));
+    std::string resp;
+    char buf[4096];
+    std::error_code ec;
+    for (;;) {
+        size_t read = socket.read_some(asio::buffer(buf), ec);
+        if (ec) {
+            break;
+        }
+        resp.append(buf, read);
+    }
+    return resp;
+}
+
+std::string get(const std::string& path, const std::string& headers = "") {
+    return request("GET", path, headers);
+}
+
+std::string body(const std::string& resp) {
+    auto pos = resp.find("\r\n\r\n");
+    slassert(std::string::npos != pos);
+    return resp.substr(pos + 4);
+}
+
+std::string header(const std::string& resp, const std::string& name) {
+    auto pos = resp.find("\r\n" + name + ": ");
+    if (std::string::npos == pos) {
+        return "";
+    }
+    pos += name.length() + 4;
+    return resp.substr(pos, resp.find("\r\n", pos) - pos);
+}
+
+void test_static_files() {
+#ifdef _WIN32
+    _mkdir(ROOT_DIR.c_str());
+#else // !_WIN32
+    mkdir(ROOT_DIR.c_str(), 0755);
+#endif // _WIN32
+    auto medium = make_data(100000);
+    auto large = make_data(300000);
+    write_file("index.html", "<html></html>");
+    write_file("a.txt", "hello");
+    write_file("a.txt.gz", "GZ");
+    write_file("medium.bin", medium);
+    write_file("large.bin", large);
+
+    sl::pion::static_file_options opts;
+    opts.root_directory = ROOT_DIR;
+    opts.url_prefix = "/static";
+    opts.max_cached_file_size = 1024;
+    opts.max_mapped_file_size = 200000;
+    sl::pion::http_server server(2, TCP_PORT);
+    server.add_handler("GET", "/static", sl::pion::static_file_handler(opts));
+    server.start();
+
+    // cached file with a precompressed sibling
+    auto resp = get("/static/a.txt");
+    slassert(0 == resp.find("HTTP/1.1 200 OK"));
+    slassert("hello" == body(resp));
+    slassert("text/plain; charset=utf-8" == header(resp, "Content-Type"));
+    slassert("Accept-Encoding" == header(resp, "Vary"));
+    slassert(header(resp, "Content-Encoding").empty());
+    auto etag = header(resp, "ETag");
+    auto last_modified = header(resp, "Last-Modified");
+    slassert(!etag.empty());
+    slassert(!last_modified.empty());
+
+    resp = get("/static/a.txt", "Accept-Encoding: deflate, gzip\r\n");
+    slassert("GZ" == body(resp));
+    slassert("gzip" == header(resp, "Content-Encoding"));
+    slassert(etag != header(resp, "ETag"));
+    resp = get("/static/a.txt", "Accept-Encoding: gzip;q=0\r\n");
+    slassert("hello" == body(resp));
+
+    // conditional requests
+    resp = get("/static/a.txt", "If-None-Match: \"foo\", " + etag + "\r\n");
+    slassert(0 == resp.find("HTTP/1.1 304 Not Modified"));
+    slassert(body(resp).empty());
+    slassert(header(resp, "Content-Length").empty());
+    slassert(etag == header(resp, "ETag"));
+    resp = get("/static/a.txt", "If-Modified-Since: " + last_modified + "\r\n");
+    slassert(0 == resp.find("HTTP/1.1 304 Not Modified"));
+    resp = get("/static/a.txt", "If-None-Match: \"foo\"\r\n");
+    slassert(0 == resp.find("HTTP/1.1 200 OK"));
+
+    // ranges
+    resp = get("/static/a.txt", "Range: bytes=1-3\r\n");
+    slassert(0 == resp.find("HTTP/1.1 206 Partial Content"));
+    slassert("bytes 1-3/5" == header(resp, "Content-Range"));
+    slassert("ell" == body(resp));
+    resp = get("/static/a.txt", "Range: bytes=10-\r\n");
+    slassert(0 == resp.find("HTTP/1.1 416 Range Not Satisfiable"));
+    slassert("bytes */5" == header(resp, "Content-Range"));
+    resp = get("/static/a.txt", "Range: bytes=1-3\r\nIf-Range: \"foo\"\r\n");
+    slassert(0 == resp.find("HTTP/1.1 200 OK"));
+    slassert("hello" == body(resp));
+    resp = get("/static/medium.bin", "Range: bytes=-10\r\n");
+    slassert(medium.substr(medium.length() - 10) == body(resp));
+    resp = get("/static/large.bin", "Range: bytes=1000-200999\r\n");
+    slassert(large.substr(1000, 200000) == body(resp));
+
+    // mapped and sent from disk
+    slassert(medium == body(get("/static/medium.bin")));
+    slassert(large == body(get("/static/large.bin")));
+    resp = request("HEAD", "/static/large.bin");
+    slassert("300000" == header(resp, "Content-Length"));
+    slassert(body(resp).empty());
+
+    // file changed in place before the entry is revalidated, stale size is not used
+    auto changed = make_data(250000);
+    write_file("large.bin", changed);
+    resp = get("/static/large.bin");
+    slassert("250000" == header(resp, "Content-Length"));
+    slassert(changed == body(resp));
+
+    // index and missing files
+    slassert("<html></html>" == body(get("/static/")));
+    slassert("text/html; charset=utf-8" == header(get("/static/"), "Content-Type"));
+    slassert(0 == get("/static/missing.txt").find("HTTP/1.1 404 Not Found"));
+    slassert(0 == get("/static/../static_file_handler_test.cpp").find("HTTP/1.1 404 Not Found"));
+
+    server.stop(true);
+    for (auto& name : FILES) {
+        std::remove((ROOT_DIR + "/" + name).c_str());
+    }
+#ifdef _WIN32
+    _rmdir(ROOT_DIR.c_str());
+#else // !_WIN32
+    rmdir(ROOT_DIR.c_str());
+#endif // _WIN32
+}
+
+int main() {
+    try {
+        test_static_files();
+    } catch (const std::exception& e) {
+        std::cout << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
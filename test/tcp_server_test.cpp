@@ -0,0 +1,195 @@
+/*
+ * Copyright 2026, alex at staticlibs.net
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   tcp_server_test.cpp
+ * Author: alex
+ *
+ * Created on October 17, 2026, 6:10 PM
+ */
+
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "asio.hpp"
+
+#include "staticlib/config/assert.hpp"
+
+#include "staticlib/pion/http_server.hpp"
+#include "staticlib/pion/pion_exception.hpp"
+
+const uint16_t TCP_PORT = 8088;
+const uint32_t THREADS = 4;
+const size_t REQUESTS = 40;
+const size_t CONNECTIONS = 8;
+
+std::mutex threads_mutex;
+std::set<std::thread::id> handler_threads;
+
+void hello(sl::pion::http_request_ptr, sl::pion::response_writer_ptr resp) {
+    resp->write("hello");
+    resp->send(std::move(resp));
+}
+
+void thread_id(sl::pion::http_request_ptr, sl::pion::response_writer_ptr resp) {
+    {
+        std::lock_guard<std::mutex> guard{threads_mutex};
+        handler_threads.insert(std::this_thread::get_id());
+    }
+    resp->write("hello");
+    resp->send(std::move(resp));
+}
+
+// sends request on a new connection and reads the response until the connection is closed
+std::string request() {
+    asio::io_service io_service;
+    asio::ip::tcp::endpoint endpoint{asio::ip::address_v4::from_string("127.0.0.1"), TCP_PORT};
+    asio::ip::tcp::socket socket{io_service};
+    socket.connect(endpoint);
+    asio::write(socket, asio::buffer(std::string("GET /hello HTTP/1.1\r\n"
+            "Host: 127.0.0.1\r\n"
+            "Connection: close\r\n"
+            "\r\n")));
+    std::string resp;
+    char buf[1024];
+    std::error_code ec;
+    for (;;) {
+        size_t read = socket.read_some(asio::buffer(buf), ec);
+        if (ec) {
+            break;
+        }
+        resp.append(buf, read);
+    }
+    return resp;
+}
+
+void check_served() {
+    for (size_t i = 0; i < REQUESTS; i++) {
+        std::string resp = request();
+        slassert(0 == resp.find("HTTP/1.1 200 OK\r\n"));
+        slassert(resp.length() - 5 == resp.rfind("hello"));
+    }
+}
+
+void test_io_service_per_thread() {
+    sl::pion::http_server server(THREADS, TCP_PORT);
+    server.get_scheduler().set_io_service_per_thread(true);
+    slassert(THREADS == server.get_scheduler().get_io_services_count());
+    server.add_handler("GET", "/thread", thread_id);
+    server.start();
+
+    // all connections are opened before any of them is read,
+    // so they are served concurrently on different loops
+    asio::io_service io_service;
+    asio::ip::tcp::endpoint endpoint{asio::ip::address_v4::from_string("127.0.0.1"), TCP_PORT};
+    std::vector<std::unique_ptr<asio::ip::tcp::socket>> sockets;
+    for (size_t i = 0; i < CONNECTIONS; i++) {
+        sockets.emplace_back(new asio::ip::tcp::socket(io_service));
+        sockets.back()->connect(endpoint);
+        asio::write(*sockets.back(), asio::buffer(std::string("GET /thread HTTP/1.1\r\n"
+                "Host: 127.0.0.1\r\n"
+                "Connection: close\r\n"
+                "\r\n")));
+    }
+    for (auto& socket : sockets) {
+        std::string resp;
+        char buf[1024];
+        std::error_code ec;
+        for (;;) {
+            size_t read = socket->read_some(asio::buffer(buf), ec);
+            if (ec) {
+                break;
+            }
+            resp.append(buf, read);
+        }
+        slassert(0 == resp.find("HTTP/1.1 200 OK\r\n"));
+        slassert(resp.length() - 5 == resp.rfind("hello"));
+    }
+    {
+        std::lock_guard<std::mutex> guard{threads_mutex};
+        slassert(handler_threads.size() > 1);
+    }
+
+    // mode cannot be changed while the scheduler is running
+    bool thrown = false;
+    try {
+        server.get_scheduler().set_io_service_per_thread(false);
+    } catch (const sl::pion::pion_exception&) {
+        thrown = true;
+    }
+    slassert(thrown);
+    server.stop(true);
+}
+
+void test_reuse_port() {
+    sl::pion::http_server server(THREADS, TCP_PORT);
+    server.get_scheduler().set_io_service_per_thread(true);
+    auto opts = server.get_options();
+    opts.reuse_port = true;
+    server.set_options(opts);
+    server.add_handler("GET", "/hello", hello);
+    server.start();
+    check_served();
+    server.stop(true);
+}
+
+void test_cpu_steering() {
+    sl::pion::http_server server(THREADS, TCP_PORT);
+    server.get_scheduler().set_io_service_per_thread(true);
+    auto opts = server.get_options();
+    opts.reuse_port = true;
+    opts.reuse_port_cpu_steering = true;
+    server.set_options(opts);
+    server.add_handler("GET", "/hello", hello);
+    server.start();
+    // when steering program cannot be attached, connections are spread by the kernel
+    check_served();
+    server.stop(true);
+}
+
+void test_cpu_steering_running_scheduler() {
+    sl::pion::http_server server(THREADS, TCP_PORT);
+    server.get_scheduler().set_io_service_per_thread(true);
+    auto opts = server.get_options();
+    opts.reuse_port = true;
+    opts.reuse_port_cpu_steering = true;
+    server.set_options(opts);
+    server.add_handler("GET", "/hello", hello);
+    // threads of the running scheduler cannot be pinned, server starts without pinning
+    server.get_scheduler().startup();
+    server.start();
+    check_served();
+    server.stop(true);
+}
+
+int main() {
+    try {
+        test_io_service_per_thread();
+        test_reuse_port();
+        test_cpu_steering();
+        test_cpu_steering_running_scheduler();
+    } catch (const std::exception& e) {
+        std::cout << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,74 @@
+/*
+ * Copyright 2026, alex at staticlibs.net
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   write_arena_test.cpp
+ * Author: alex
+ *
+ * Created on October 18, 2026, 2:10 AM
+ */
+
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include "staticlib/config/assert.hpp"
+
+#include "staticlib/pion/write_arena.hpp"
+
+void test_sequential() {
+    sl::pion::write_arena arena;
+    char* first = arena.copy("foo", 3);
+    char* second = arena.copy("bar", 3);
+    slassert(first + 3 == second);
+    slassert(0 == std::memcmp(first, "foobar", 6));
+
+    // does not fit into the rest of the slab
+    char* large = arena.allocate(sl::pion::write_arena::SLAB_SIZE);
+    slassert(second + 3 != large);
+    slassert(0 == std::memcmp(first, "foobar", 6));
+    char* after = arena.copy("baz", 3);
+    slassert(large + sl::pion::write_arena::SLAB_SIZE != after);
+    arena.clear();
+}
+
+void test_pool() {
+    auto pool = std::make_shared<sl::pion::content_buffer_pool>(1 << 20);
+    sl::pion::write_arena arena;
+    arena.set_pool(pool);
+    char* first = arena.copy("foo", 3);
+    std::string big(sl::pion::write_arena::SLAB_SIZE * 2, 'x');
+    char* big_copy = arena.copy(big.data(), big.length());
+    slassert(0 == std::memcmp(big_copy, big.data(), big.length()));
+    slassert(0 == pool->spare_count());
+    arena.clear();
+    slassert(2 == pool->spare_count());
+    // regular slab is taken back from the pool
+    slassert(first == arena.copy("bar", 3));
+    slassert(1 == pool->spare_count());
+}
+
+int main() {
+    try {
+        test_sequential();
+        test_pool();
+    } catch (const std::exception& e) {
+        std::cout << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}